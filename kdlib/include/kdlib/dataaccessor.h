@@ -20,6 +20,10 @@ public:
 
     virtual size_t getLength() const = 0;
 
+    // "pos" is a byte offset, unlike the typed methods where it is an element index
+    virtual void readRaw(void* dst, size_t length, size_t pos=0) const = 0;
+    virtual void writeRaw(const void* src, size_t length, size_t pos=0) = 0;
+
     virtual unsigned char readByte(size_t pos=0) const = 0;
     virtual void writeByte(unsigned char value, size_t pos=0) = 0;
 
@@ -80,6 +84,47 @@ public:
     virtual void readDoubles( std::vector<double>&  dataRange, size_t count, size_t  pos=0) const = 0;
     virtual void writeDoubles( const std::vector<double>&  dataRange, size_t  pos=0) = 0;
 
+    // read "count" elements into the caller's buffer
+    void readBytes(unsigned char* dataRange, size_t count, size_t pos=0) const {
+        readElements(dataRange, count, pos);
+    }
+
+    void readWords(unsigned short* dataRange, size_t count, size_t pos=0) const {
+        readElements(dataRange, count, pos);
+    }
+
+    void readDWords(unsigned long* dataRange, size_t count, size_t pos=0) const {
+        readElements(dataRange, count, pos);
+    }
+
+    void readQWords(unsigned long long* dataRange, size_t count, size_t pos=0) const {
+        readElements(dataRange, count, pos);
+    }
+
+    void readSignBytes(char* dataRange, size_t count, size_t pos=0) const {
+        readElements(dataRange, count, pos);
+    }
+
+    void readSignWords(short* dataRange, size_t count, size_t pos=0) const {
+        readElements(dataRange, count, pos);
+    }
+
+    void readSignDWords(long* dataRange, size_t count, size_t pos=0) const {
+        readElements(dataRange, count, pos);
+    }
+
+    void readSignQWords(long long* dataRange, size_t count, size_t pos=0) const {
+        readElements(dataRange, count, pos);
+    }
+
+    void readFloats(float* dataRange, size_t count, size_t pos=0) const {
+        readElements(dataRange, count, pos);
+    }
+
+    void readDoubles(double* dataRange, size_t count, size_t pos=0) const {
+        readElements(dataRange, count, pos);
+    }
+
     virtual DataAccessorPtr copy( size_t  startOffset = 0, size_t  length = -1 ) = 0;
 
     virtual std::wstring getLocationAsStr() const = 0;
@@ -87,12 +132,27 @@ public:
     virtual MEMOFFSET_64 getAddress() const = 0;
     virtual VarStorage getStorageType() const = 0;
     virtual std::wstring getRegisterName() const = 0;
+
+private:
+
+    template<typename T>
+    void readElements(T* dataRange, size_t count, size_t pos) const
+    {
+        // an overflowed size is saturated so readRaw reports the range error
+        const size_t  maxCount = static_cast<size_t>(-1) / sizeof(T);
+
+        readRaw(dataRange,
+            count > maxCount ? static_cast<size_t>(-1) : count * sizeof(T),
+            pos > maxCount ? static_cast<size_t>(-1) : pos * sizeof(T) );
+    }
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
 DataAccessorPtr getEmptyAccessor();
-DataAccessorPtr getMemoryAccessor( MEMOFFSET_64  offset, size_t length);
+// a prefetched accessor reads the whole range on the first access and serves
+// all reads from this buffer; writes go to the target memory and the buffer
+DataAccessorPtr getMemoryAccessor( MEMOFFSET_64  offset, size_t length, bool prefetch = false);
 DataAccessorPtr getRegisterAccessor(const std::wstring& registerName);
 
 DataAccessorPtr getCacheAccessor(const std::vector<char>& buffer, const std::wstring&  location=L"");
@@ -100,6 +160,9 @@ DataAccessorPtr getCacheAccessor(size_t bufferSize, const std::wstring&  locatio
 DataAccessorPtr getCacheAccessor(const void* rawBuffer, size_t bufferSize, const std::wstring&  location=L"");
 DataAccessorPtr getCacheAccessor(const NumVariant& var, const std::wstring&  location=L"");
 
+// view of the shared buffer without copying; writes change the buffer
+DataAccessorPtr getSharedCacheAccessor(const boost::shared_ptr< std::vector<char> >& buffer, size_t offset = 0, size_t length = -1, const std::wstring&  location=L"");
+
 template<typename T, typename std::enable_if< !std::is_integral<T>::value >::type* = nullptr >
 DataAccessorPtr getCacheAccessor(const T& structType, const std::wstring&  location=L"")
 {
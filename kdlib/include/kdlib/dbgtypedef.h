@@ -276,6 +276,29 @@ enum DumpFormat
 
 typedef unsigned long  DumpFormatFlagsSet;
 
+struct MemoryCacheStatistics {
+    unsigned long long  hits;
+    unsigned long long  misses;
+    unsigned long long  evictions;
+    size_t  cachedPages;
+    size_t  maxPages;
+};
+
+struct TypeCacheStatistics {
+    unsigned long long  hits;
+    unsigned long long  misses;
+    unsigned long long  evictions;
+    size_t  cachedTypes;
+    size_t  maxTypes;
+};
+
+struct FrameScopeStatistics {
+    unsigned long long  hits;
+    unsigned long long  misses;  // the scopes resolved with symbol queries
+    size_t  cachedScopes;
+    size_t  failedScopes;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 } // kdlib namespace end
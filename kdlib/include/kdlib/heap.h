@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include <boost/smart_ptr.hpp>
 
 #include "kdlib/dbgtypedef.h"
@@ -15,6 +17,14 @@ typedef boost::shared_ptr<TargetHeap>  TargetHeapPtr;
 class TargetHeapEnum;
 typedef boost::shared_ptr<TargetHeapEnum>  TargetHeapEnumPtr;
 
+struct TargetHeapTypeStat {
+    std::wstring  typeName;
+    size_t  count;
+    unsigned long long  totalSize;
+};
+
+typedef std::vector<TargetHeapTypeStat>  TargetHeapStat;
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class TargetHeap  
@@ -24,6 +34,9 @@ public:
     virtual size_t  getCount(const std::wstring&  typeName=L"", size_t minSize = 0, size_t maxSize = -1) const = 0;
 
     virtual TargetHeapEnumPtr  getEnum(const std::wstring&  typeName=L"", size_t minSize = 0, size_t maxSize = -1)  = 0;
+
+    // object count and total size for each type, the largest total size first
+    virtual TargetHeapStat  getStatistics(const std::wstring&  typeName=L"", size_t minSize = 0, size_t maxSize = -1) const = 0;
 };
 
 class TargetHeapEnum
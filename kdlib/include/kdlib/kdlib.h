@@ -9,6 +9,8 @@
 #include "kdlib/exceptions.h"
 #include "kdlib/eventhandler.h"
 #include "kdlib/memaccess.h"
+#include "kdlib/memprovider.h"
+#include "kdlib/minidump.h"
 #include "kdlib/module.h"
 #include "kdlib/process.h"
 #include "kdlib/stack.h"
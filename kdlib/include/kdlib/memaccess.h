@@ -25,6 +25,11 @@ kdlib::MemoryType getVaType( kdlib::MEMOFFSET_64  offset );
 
 void writeMemory( MEMOFFSET_64 offset, const void* buffer, size_t length, bool phyAddr = false, unsigned long *written = 0 );
 
+void enableMemoryCache( bool enable = true, size_t maxPages = 0x4000 );
+bool isMemoryCacheEnabled();
+void resetMemoryCache();
+MemoryCacheStatistics getMemoryCacheStatistics();
+
 ///////////////////////////////////////////////////////////////////////////////
 
 unsigned char ptrByte( MEMOFFSET_64 offset );
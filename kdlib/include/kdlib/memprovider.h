@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "kdlib/dbgtypedef.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct MemoryRegionInfo {
+    MEMOFFSET_64  baseOffset;
+    unsigned long long  regionLength;
+    MemoryState  state;
+    MemoryProtect  protect;
+    MemoryType  type;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class MemoryProvider;
+typedef boost::shared_ptr<MemoryProvider>  MemoryProviderPtr;
+
+class MemoryProvider
+{
+public:
+
+    virtual ~MemoryProvider() {}
+
+    virtual MEMOFFSET_64 addr64( MEMOFFSET_64 offset ) = 0;
+
+    // readMemory returns true only if the whole range was read, writeMemory
+    // returns false if the memory can not be accessed at all;
+    // "readed" and "written" receive the length of the accessible part
+    virtual bool readMemory( MEMOFFSET_64 offset, void* buffer, size_t length, bool phyAddr, unsigned long *readed ) = 0;
+    virtual bool writeMemory( MEMOFFSET_64 offset, const void* buffer, size_t length, bool phyAddr, unsigned long *written ) = 0;
+
+    virtual bool isVaValid( MEMOFFSET_64 offset ) = 0;
+    virtual bool isVaRegionValid( MEMOFFSET_64 offset, size_t length ) = 0;
+    virtual bool queryRegion( MEMOFFSET_64 offset, MemoryRegionInfo& regionInfo ) = 0;
+
+    virtual bool searchMemory( MEMOFFSET_64 beginOffset, unsigned long length, const std::vector<char>& pattern, MEMOFFSET_64& foundOffset ) = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// the provider is used by all memaccess.h functions and so by typed variables;
+// an empty pointer restores the debug engine provider
+void setMemoryProvider( const MemoryProviderPtr& provider );
+MemoryProviderPtr getMemoryProvider();
+
+MemoryProviderPtr getDebugEngineMemoryProvider();
+
+MemoryProviderPtr getBufferMemoryProvider( MEMOFFSET_64 baseOffset, const std::vector<char>& buffer );
+MemoryProviderPtr getBufferMemoryProvider( MEMOFFSET_64 baseOffset, const void* rawBuffer, size_t bufferSize );
+MemoryProviderPtr getSnapshotMemoryProvider( const std::vector< std::pair<MEMOFFSET_64, size_t> >& ranges );
+
+MemoryProviderPtr getFileMemoryProvider( const std::wstring& fileName, MEMOFFSET_64 baseOffset, unsigned long long fileOffset = 0, unsigned long long length = -1 );
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "kdlib/dbgtypedef.h"
+#include "kdlib/memprovider.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+class Minidump;
+typedef boost::shared_ptr<Minidump>  MinidumpPtr;
+
+// Minidump file parsed without the debug engine.
+// Memory is served by the MemoryProvider interface, so the dump can be set
+// with setMemoryProvider and used with memaccess.h functions and typed variables
+class Minidump : public MemoryProvider
+{
+public:
+
+    virtual CPUType getCPUType() = 0;
+
+    virtual std::vector<MEMOFFSET_64> getModuleBasesList() = 0;
+    virtual MEMOFFSET_64 findModuleBase( MEMOFFSET_64 offset ) = 0;
+
+    virtual std::wstring getModuleName( MEMOFFSET_64 baseOffset ) = 0;
+    virtual std::wstring getModuleImageName( MEMOFFSET_64 baseOffset ) = 0;
+    virtual MEMOFFSET_32 getModuleSize( MEMOFFSET_64 baseOffset ) = 0;
+    virtual unsigned long getModuleTimeStamp( MEMOFFSET_64 baseOffset ) = 0;
+    virtual unsigned long getModuleCheckSum( MEMOFFSET_64 baseOffset ) = 0;
+
+    virtual unsigned long getNumberThreads() = 0;
+    virtual THREAD_ID getThreadSystemId( unsigned long index ) = 0;
+    virtual MEMOFFSET_64 getThreadOffset( unsigned long index ) = 0;
+
+    // raw CONTEXT structure of the dump's processor type
+    virtual std::vector<unsigned char> getThreadContext( unsigned long index ) = 0;
+
+    virtual MEMOFFSET_64 getThreadIP( unsigned long index ) = 0;
+    virtual MEMOFFSET_64 getThreadSP( unsigned long index ) = 0;
+    virtual MEMOFFSET_64 getThreadFP( unsigned long index ) = 0;
+};
+
+MinidumpPtr openMinidump( const std::wstring& fileName );
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
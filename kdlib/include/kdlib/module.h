@@ -25,6 +25,10 @@ ModulePtr loadModule( MEMOFFSET_64 offset );
 
 void splitSymName( const std::wstring &fullName, std::wstring &moduleName, std::wstring &symbolName );
 
+// index of the global names of all modules for the names without a module prefix
+void enableSymbolIndex( bool enable = true );
+bool isSymbolIndexEnabled();
+
 typedef std::pair< std::wstring, MEMOFFSET_64 > SymbolOffset;
 typedef std::list< SymbolOffset > SymbolOffsetList;
 typedef std::list< std::wstring > TypeNameList;
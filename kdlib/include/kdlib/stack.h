@@ -78,6 +78,8 @@ void setCurrentStackFrame(const StackFramePtr& stackFrame);
 void setCurrentStackFrameByIndex(unsigned long frameIndex);
 void resetCurrentStackFrame();
 
+FrameScopeStatistics getFrameScopeStatistics();
+
 ///////////////////////////////////////////////////////////////////////////////
 
 } // kdlib namespace end
@@ -214,6 +214,7 @@ public:
     virtual SymbolPtrList findInlineFramesByVA(MEMOFFSET_64) = 0;
     virtual void getInlineSourceLine(MEMOFFSET_64, std::wstring &fileName, unsigned long &lineNo) = 0;
     virtual SymbolPtr getLexicalParent() = 0;
+    virtual unsigned long getIndexId() = 0; // unique in the symbol session
 };
 
 ///////////////////////////////////////////////////////////////////////////////
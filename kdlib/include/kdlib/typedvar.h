@@ -50,6 +50,13 @@ TypedVarList loadTypedVarList( MEMOFFSET_64 addr, const std::wstring &typeName,
 
 TypedVarList loadTypedVarList( MEMOFFSET_64 addr, TypeInfoPtr &typeInfo, const std::wstring &fieldName );
 
+class TypedVarListWalker;
+typedef boost::shared_ptr<TypedVarListWalker>  TypedVarListWalkerPtr;
+
+TypedVarListWalkerPtr walkTypedVarList( MEMOFFSET_64 addr, const std::wstring &typeName, const std::wstring &fieldName, size_t maxLength = -1 );
+
+TypedVarListWalkerPtr walkTypedVarList( MEMOFFSET_64 addr, TypeInfoPtr &typeInfo, const std::wstring &fieldName, size_t maxLength = -1 );
+
 TypedVarList loadTypedVarArray( MEMOFFSET_64 addr, const std::wstring &typeName, size_t count );
 
 TypedVarList loadTypedVarArray( MEMOFFSET_64 addr, TypeInfoPtr &typeInfo, size_t count );
@@ -147,6 +154,23 @@ protected:
     {}
 };
 
+///////////////////////////////////////////////////////////////////////////////
+
+// Lazy walker over a linked list: each entry is read from the target with
+// one request, together with its link to the next one. next() throws
+// DbgException when the list is longer than maxLength or has a cycle
+class TypedVarListWalker : private boost::noncopyable
+{
+public:
+
+    virtual ~TypedVarListWalker() {}
+
+    // returns the null pointer at the end of the list
+    virtual TypedVarPtr next() = 0;
+
+    virtual size_t getCount() const = 0;
+};
+
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -159,27 +183,42 @@ public:
     TypedValue(const TypedVarPtr& var) : m_value(var){}
     TypedValue(const NumVariant& var );
 
-    TypedValue( char var ) : m_value( loadCharVar(var) ) {}
-    TypedValue( short var) : m_value( loadShortVar(var) ) {}
-    TypedValue( long var ) : m_value( loadLongVar(var) ) {}
-    TypedValue( long long var ) : m_value( loadLongLongVar(var) ) {}
+    // the lazily loaded var is read atomically, a copy may be made while
+    // another thread loads it
+    TypedValue(const TypedValue& value) :
+        m_value( boost::atomic_load(&value.m_value) ),
+        m_scalar( value.m_scalar )
+        {}
+
+    TypedValue& operator=(const TypedValue& value) {
+        boost::atomic_store( &m_value, boost::atomic_load(&value.m_value) );
+        m_scalar = value.m_scalar;
+        return *this;
+    }
+
+    // scalars are kept inline, a TypedVar is loaded on the first request
+    // for something besides the value and the type
+    TypedValue( char var ) : m_scalar( var ) {}
+    TypedValue( short var) : m_scalar( var ) {}
+    TypedValue( long var ) : m_scalar( var ) {}
+    TypedValue( long long var ) : m_scalar( var ) {}
 
-    TypedValue( unsigned char var ) : m_value( loadUCharVar(var) ) {}
-    TypedValue( unsigned short var) : m_value( loadUShortVar(var) ) {}
-    TypedValue( unsigned long var ) : m_value( loadULongVar(var) ) {}
-    TypedValue( unsigned long long var ) : m_value( loadULongLongVar(var) ) {}
+    TypedValue( unsigned char var ) : m_scalar( var ) {}
+    TypedValue( unsigned short var) : m_scalar( var ) {}
+    TypedValue( unsigned long var ) : m_scalar( var ) {}
+    TypedValue( unsigned long long var ) : m_scalar( var ) {}
 
-    TypedValue( int var ) : m_value( loadIntVar(var) ) {}
-    TypedValue( unsigned int var ) : m_value( loadIntVar(var) ) {}
+    TypedValue( int var ) : m_scalar( static_cast<long>(var) ) {}
+    TypedValue( unsigned int var ) : m_scalar( static_cast<long>(var) ) {}
 
-    TypedValue( float var ) : m_value( loadFloatVar(var) ) {}
-    TypedValue( double var ) : m_value( loadDoubleVar(var) ) {}
+    TypedValue( float var ) : m_scalar( var ) {}
+    TypedValue( double var ) : m_scalar( var ) {}
     TypedValue( wchar_t var ) : m_value( loadWCharVar(var) ) {}
-    TypedValue( bool var ) : m_value( loadBoolVar(var) ) {}
+    TypedValue( bool var ) : m_scalar( static_cast<int>(var) ) {}
     TypedValue( nullptr_t ) : m_value(loadNullPtr() ) {}
 
     template<typename T>
-    TypedValue(T* var) : m_value(loadULongLongVar((unsigned long long)var)) {}
+    TypedValue(T* var) : m_scalar((unsigned long long)var) {}
 
     template<typename T, typename std::enable_if < !std::is_arithmetic<T>::value && std::is_trivially_copyable<T>::value, T >::type* = nullptr>
     explicit operator T () const
@@ -189,11 +228,11 @@ public:
         if ( sizeof(T) > getSize() )
            throw TypeException( L"cannot cast TypedValue");
 
-        DataAccessorPtr dataRange = getCacheAccessor( m_value->getSize() );
-        m_value->writeBytes(dataRange);
+        DataAccessorPtr dataRange = getCacheAccessor( getVar()->getSize() );
+        getVar()->writeBytes(dataRange);
 
-        std::vector<unsigned char>  buf(m_value->getSize());
-        dataRange->readBytes(buf, m_value->getSize());
+        std::vector<unsigned char>  buf(getVar()->getSize());
+        dataRange->readBytes(buf, getVar()->getSize());
 
         return *reinterpret_cast<T*>(&buf.front());
     }
@@ -206,125 +245,148 @@ public:
 
     const TypedVarPtr& get()
     {
-        return m_value;
+        return getVar();
     }
 
 public:
 
     std::wstring str() {
-        return m_value->str();
+        return getVar()->str();
     }
 
     VarStorage getStorage() const {
-        return m_value->getStorage();
+        return getVar()->getStorage();
     }
 
     std::wstring  getRegisterName() const {
-        return m_value->getRegisterName();
+        return getVar()->getRegisterName();
     }
 
     MEMOFFSET_64 getAddress() const {
-        return m_value->getAddress();
+        return getVar()->getAddress();
     }
 
     MEMOFFSET_64 getDebugStart() const {
-        return m_value->getDebugStart();
+        return getVar()->getDebugStart();
     }
 
     MEMOFFSET_64 getDebugEnd() const {
-        return m_value->getDebugEnd();
+        return getVar()->getDebugEnd();
     }
 
     size_t getSize() const {
-        return m_value->getSize();
+        TypedVarPtr  var = boost::atomic_load(&m_value);
+        return var ? var->getSize() : getScalarType()->getSize();
     }
 
     std::wstring getName() const {
-        return m_value->getName();
+        return getVar()->getName();
     }
 
     TypedVarPtr getElement( const std::wstring& fieldName ) {
-        return m_value->getElement(fieldName);
+        return getVar()->getElement(fieldName);
     }
 
     TypedVarPtr getElement( size_t index ) {
-        return m_value->getElement(index);
+        return getVar()->getElement(index);
     }
 
     VarStorage getElementStorage(const std::wstring& fieldName) {
-        return m_value->getElementStorage(fieldName);
+        return getVar()->getElementStorage(fieldName);
     }
 
     VarStorage getElementStorage(size_t index ) {
-        return m_value->getElementStorage(index);
+        return getVar()->getElementStorage(index);
     }
 
     MEMOFFSET_REL getElementOffset(const std::wstring& fieldName ) {
-        return m_value->getElementOffset(fieldName);
+        return getVar()->getElementOffset(fieldName);
     }
 
     MEMOFFSET_REL getElementOffset(size_t index ) {
-        return m_value->getElementOffset(index);
+        return getVar()->getElementOffset(index);
     }
 
     RELREG_ID getElementOffsetRelativeReg(const std::wstring& fieldName ) {
-        return m_value->getElementOffsetRelativeReg(fieldName);
+        return getVar()->getElementOffsetRelativeReg(fieldName);
     }
 
     RELREG_ID getElementOffsetRelativeReg(size_t index ) {
-        return m_value->getElementOffsetRelativeReg(index);
+        return getVar()->getElementOffsetRelativeReg(index);
     }
 
     unsigned long getElementReg(const std::wstring& fieldName) {
-        return m_value->getElementReg(fieldName);
+        return getVar()->getElementReg(fieldName);
     }
 
     unsigned long getElementReg(size_t index) {
-        return m_value->getElementReg(index);
+        return getVar()->getElementReg(index);
     }
 
     size_t getElementCount() {
-        return m_value->getElementCount();
+        return getVar()->getElementCount();
     }
 
     std::wstring getElementName( size_t index ) {
-        return m_value->getElementName(index);
+        return getVar()->getElementName(index);
     }
 
     size_t getElementIndex(const std::wstring&  elementName) {
-        return m_value->getElementIndex(elementName);
+        return getVar()->getElementIndex(elementName);
     }
 
     TypeInfoPtr getType() const {
-        return m_value->getType();
+        TypedVarPtr  var = boost::atomic_load(&m_value);
+        return var ? var->getType() : getScalarType();
     }
 
     NumVariant getValue() const {
-        return m_value->getValue();
+        TypedVarPtr  var = boost::atomic_load(&m_value);
+        return var ? var->getValue() : m_scalar;
     }
 
     TypedVarPtr deref() {
-        return m_value->deref();
+        return getVar()->deref();
     }
 
     TypedVarPtr castTo(const std::wstring& typeName) const {
-        return m_value->castTo(typeName);
+        return getVar()->castTo(typeName);
     }
 
     TypedVarPtr castTo(const TypeInfoPtr &typeInfo) const {
-        return m_value->castTo(typeInfo);
+        return getVar()->castTo(typeInfo);
     }
 
     void writeBytes(const DataAccessorPtr& stream, size_t pos = 0) const {
-        return m_value->writeBytes(stream, pos);
+        return getVar()->writeBytes(stream, pos);
     }
 
     TypedValue call(const TypedValueList& arglst) {
-        return m_value->call(arglst);
+        return getVar()->call(arglst);
     }
     
 private:
-    TypedVarPtr  m_value;
+
+    // concurrent first calls may load the var each, the first one stored is
+    // kept; once stored the var is not changed, so it is returned by reference
+    const TypedVarPtr& getVar() const {
+        if ( !boost::atomic_load(&m_value) )
+        {
+            TypedVarPtr  expected;
+            boost::atomic_compare_exchange( &m_value, &expected, loadScalarVar() );
+        }
+        return m_value;
+    }
+
+    TypeInfoPtr getScalarType() const;
+
+    TypedVarPtr loadScalarVar() const;
+
+    mutable TypedVarPtr  m_value;
+
+    // the value as TypedVar::getValue returns it for the scalar type: the
+    // variant type defines the base type ( Int4B is long, Bool is int )
+    NumVariant  m_scalar;
 };
 
 
@@ -427,4 +489,31 @@ TypedValue evalExpr(
 
 ///////////////////////////////////////////////////////////////////////////////
 
+class CompiledExpression;
+typedef boost::shared_ptr<CompiledExpression>  CompiledExpressionPtr;
+
+// expression parsed once and evaluated many times with different scopes
+class CompiledExpression
+{
+public:
+
+    virtual ~CompiledExpression() {}
+
+    virtual TypedValue eval(
+        const ScopePtr& scope = getDefaultScope(),
+        const TypeInfoProviderPtr& typeInfoProvider = getDefaultTypeInfoProvider()) = 0;
+};
+
+// compiled expressions are kept in a process-wide LRU cache, so evalExpr
+// parses the same expression text only once
+CompiledExpressionPtr compileExpr(const std::wstring& expr);
+CompiledExpressionPtr compileExpr(const std::string& expr);
+void resetExprCache();
+
+// expressions are lexed by the built-in lexer, falling back to the clang
+// preprocessor for the rest; this makes the clang preprocessor lex everything
+void enableClangExprLexer(bool enable = true);
+
+///////////////////////////////////////////////////////////////////////////////
+
 } // end kdlib namespace
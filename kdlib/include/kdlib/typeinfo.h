@@ -34,6 +34,16 @@ MEMOFFSET_64 getSymbolOffset( const std::wstring &name );
 std::wstring findSymbol( MEMOFFSET_64 offset);
 std::wstring findSymbol( MEMOFFSET_64 offset, MEMDISPLACEMENT &displacement );
 
+// symbols for many offsets, in the order of the offsets; the offsets are
+// resolved in the address order, an unresolved offset gives an empty name
+std::vector<std::wstring> findSymbols( const std::vector<MEMOFFSET_64>& offsets );
+std::vector<std::wstring> findSymbols( const std::vector<MEMOFFSET_64>& offsets, std::vector<MEMDISPLACEMENT>& displacements );
+
+// types loaded by name are cached per process
+void setTypeCacheLimit( size_t maxTypes = 0x4000 );
+void resetTypeCache();
+TypeCacheStatistics getTypeCacheStatistics();
+
 class TypeInfo : public NumConvertable, private boost::noncopyable {
 
     friend TypeInfoPtr loadType( const std::wstring &symName );
@@ -241,4 +251,29 @@ TypeInfoPtr evalType(const std::string& expr, const TypeInfoProviderPtr typeInfo
 
 ///////////////////////////////////////////////////////////////////////////////
 
+class FieldProjection;
+typedef boost::shared_ptr<FieldProjection>  FieldProjectionPtr;
+
+typedef std::vector<NumVariant>  NumVariantColumn;
+
+// Scalar fields of a type ( "a.b.c" paths, bit fields, enums and pointers
+// included ) resolved once into offsets and conversions. apply() reads the
+// fields of many objects with one memory request per object and returns
+// one column per field, in the order of the field paths
+class FieldProjection : private boost::noncopyable
+{
+public:
+
+    virtual ~FieldProjection() {}
+
+    virtual size_t getFieldCount() = 0;
+    virtual TypeInfoPtr getFieldType( size_t index ) = 0;
+
+    virtual std::vector<NumVariantColumn> apply( const std::vector<MEMOFFSET_64>& addresses ) = 0;
+};
+
+FieldProjectionPtr projectFields( const TypeInfoPtr& typeInfo, const std::vector<std::wstring>& fieldPaths );
+
+///////////////////////////////////////////////////////////////////////////////
+
 }; // kdlib namespace end
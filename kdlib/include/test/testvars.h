@@ -175,6 +175,18 @@ struct structWithEnum {
 
 extern structWithEnum  g_structWithEnum;
 
+enum enumSigned {
+    MINUS_ONE = -1,
+    PLUS_ONE = 1
+};
+
+struct structWithSignEnum {
+    enumSigned  sign;
+    int  tail;
+};
+
+extern structWithSignEnum  g_structWithSignEnum;
+
 struct structWithBits {
     unsigned long m_bit0_4  : 5;
     unsigned long m_bit5    : 1;
@@ -3,6 +3,7 @@
 #pragma warning( disable : 4141 4244 4291 4624 4800 4996 4267)
 
 #include "boost/tokenizer.hpp"
+#include "boost/thread/lock_guard.hpp"
 
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/RecursiveASTVisitor.h"
@@ -576,55 +577,43 @@ class DeclNextVisitor : public RecursiveASTVisitor<DeclNextVisitor>
 
 public:
 
-    DeclNextVisitor(ClangASTSessionPtr& astSession, std::map<std::string, TypeInfoPtr>* typeMap) :
-        m_session(astSession),
+    DeclNextVisitor(ClangTypeDeclMap* typeMap) :
         m_typeMap(typeMap)
     {}
 
     bool VisitCXXRecordDecl(CXXRecordDecl *Declaration)
     {
-        try {
-
-            CXXRecordDecl *   definition = Declaration->getDefinition();
+        CXXRecordDecl *   definition = Declaration->getDefinition();
 
-            if (definition)
-            {
-                if (definition->isInvalidDecl())
-                    return true;
+        if (definition)
+        {
+            if (definition->isInvalidDecl())
+                return true;
 
-                auto  templateDecl = definition->getDescribedClassTemplate();
+            auto  templateDecl = definition->getDescribedClassTemplate();
 
-                if (templateDecl)
+            if (templateDecl)
+            {
+                for (auto specIt = templateDecl->spec_begin(); specIt != templateDecl->spec_end(); specIt++)
                 {
-                    for (auto specIt = templateDecl->spec_begin(); specIt != templateDecl->spec_end(); specIt++)
-                    {
-                        LangOptions  lo;
-                        PrintingPolicy pp(lo);
-                        pp.SuppressTagKeyword = true;
-                        pp.MSVCFormatting = true;
-
-                        const std::string  &name = (*specIt)->getTypeForDecl()->getCanonicalTypeInternal().getAsString(pp);
+                    LangOptions  lo;
+                    PrintingPolicy pp(lo);
+                    pp.SuppressTagKeyword = true;
+                    pp.MSVCFormatting = true;
 
-                        auto  rr = llvm::dyn_cast<CXXRecordDecl>(*specIt);
+                    const std::string  &name = (*specIt)->getTypeForDecl()->getCanonicalTypeInternal().getAsString(pp);
 
-                        auto typeInfo = TypeInfoPtr(new TypeInfoClangStruct(strToWStr(name), m_session, rr));
-                        (*m_typeMap)[name] = typeInfo;
-                    }
-                }
-                else
-                {
-                    const std::string  &name = Declaration->getQualifiedNameAsString();
-                    (*m_typeMap)[name] = TypeInfoPtr(new TypeInfoClangStruct(strToWStr(name), m_session, definition));
+                    addDecl(name, ClangTypeDecl::StructKind, llvm::dyn_cast<CXXRecordDecl>(*specIt));
                 }
             }
             else
             {
-                const std::string  &name = Declaration->getQualifiedNameAsString();
-                (*m_typeMap)[name] = TypeInfoPtr(new TypeInfoClangStructNoDef(strToWStr(name), m_session, Declaration));
+                addDecl(Declaration->getQualifiedNameAsString(), ClangTypeDecl::StructKind, definition);
             }
         }
-        catch (TypeException&)
+        else
         {
+            addDecl(Declaration->getQualifiedNameAsString(), ClangTypeDecl::StructNoDefKind, Declaration);
         }
 
         return true;
@@ -632,22 +621,10 @@ public:
 
     bool VisitTypedefDecl(TypedefDecl  *Declaration)
     {
+        if (Declaration->isInvalidDecl())
+            return true;
 
-        try {
-
-            if (Declaration->isInvalidDecl())
-                return true;
-
-            const std::string&  name = Declaration->getQualifiedNameAsString();
-
-            QualType  decl = Declaration->getUnderlyingType().getCanonicalType();
-
-            (*m_typeMap)[name] = getTypeForClangType(m_session, decl);
-
-        }
-        catch (TypeException&)
-        {
-        }
+        addDecl(Declaration->getQualifiedNameAsString(), ClangTypeDecl::TypedefKind, Declaration);
 
         return true;
     }
@@ -655,61 +632,41 @@ public:
 
     bool VisitFunctionDecl(FunctionDecl *Declaration)
     {
-        try {
-
-            if (Declaration->isInvalidDecl())
-                return true;
-
-            if (Declaration->getTemplatedKind() == FunctionDecl::TemplatedKind::TK_FunctionTemplate)
-                return true;
-
-            if (CXXRecordDecl  *parentClassDecl = llvm::dyn_cast<CXXRecordDecl>(Declaration->getDeclContext()))
-            {
-                if (parentClassDecl->getDescribedClassTemplate())
-                    return true;
-            }
-
-            std::string  name = getFunctionNameFromDecl(Declaration);
-
-            TypeInfoPtr  typeInfo = TypeInfoPtr(new TypeInfoClangFunc(m_session, Declaration));
+        if (Declaration->isInvalidDecl())
+            return true;
 
-            (*m_typeMap)[name] = typeInfo;
+        if (Declaration->getTemplatedKind() == FunctionDecl::TemplatedKind::TK_FunctionTemplate)
+            return true;
 
-        }
-        catch (TypeException&)
+        if (CXXRecordDecl  *parentClassDecl = llvm::dyn_cast<CXXRecordDecl>(Declaration->getDeclContext()))
         {
+            if (parentClassDecl->getDescribedClassTemplate())
+                return true;
         }
 
+        addDecl(getFunctionNameFromDecl(Declaration), ClangTypeDecl::FuncKind, Declaration);
+
         return true;
     }
 
     bool VisitEnumDecl(EnumDecl *Declaration)
     {
-        try {
-            if (Declaration->isInvalidDecl())
-                return true;
-
-            std::string  name = Declaration->getQualifiedNameAsString();
-
-            TypeInfoPtr  typeInfo = TypeInfoPtr(new TypeInfoClangEnum(m_session, Declaration));
-
-
-            (*m_typeMap)[name] = typeInfo;
+        if (Declaration->isInvalidDecl())
+            return true;
 
-        }
-        catch (TypeException&)
-        {
-        }
+        addDecl(Declaration->getQualifiedNameAsString(), ClangTypeDecl::EnumKind, Declaration);
 
         return true;
     }
 
 private:
 
+    void addDecl(const std::string& name, ClangTypeDecl::DeclKind kind, Decl* decl)
+    {
+        (*m_typeMap)[name].decls.push_back(std::make_pair(kind, decl));
+    }
 
-    ClangASTSessionPtr  m_session;
-
-    std::map<std::string, TypeInfoPtr>  *m_typeMap;
+    ClangTypeDeclMap  *m_typeMap;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -842,7 +799,8 @@ TypeInfoProviderClang::TypeInfoProviderClang( const std::string& sourceCode, con
 
     m_astSession = ClangASTSession::getASTSession(ast);
 
-    DeclNextVisitor   visitor(m_astSession, &m_typeCache);
+    // only the names are collected, the types are built on the first request
+    DeclNextVisitor   visitor(&m_typeDecls);
 
     visitor.TraverseDecl( m_astSession->getASTContext().getTranslationUnitDecl() );
 }
@@ -851,12 +809,71 @@ TypeInfoProviderClang::TypeInfoProviderClang( const std::string& sourceCode, con
 
 TypeInfoPtr TypeInfoProviderClang::getTypeByName(const std::wstring& name)
 {
-    auto  foundType = m_typeCache.find( wstrToStr(name) );
+    auto  foundType = m_typeDecls.find( wstrToStr(name) );
+
+    if ( foundType == m_typeDecls.end() )
+        throw TypeException(name, L"Failed to get type");
 
-    if ( foundType == m_typeCache.end() )
+    TypeInfoPtr  typeInfo = getTypeInfo(*foundType);
+    if ( !typeInfo )
         throw TypeException(name, L"Failed to get type");
 
-    return foundType->second;
+    return typeInfo;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypeInfoPtr TypeInfoProviderClang::getTypeInfo(ClangTypeDeclMap::value_type& typeDecl)
+{
+    boost::lock_guard<boost::mutex>  l(m_typeLock);
+
+    ClangTypeDecl&  entry = typeDecl.second;
+
+    if ( entry.typeInfo )
+        return entry.typeInfo;
+
+    for ( auto declIt = entry.decls.rbegin(); declIt != entry.decls.rend(); ++declIt )
+    {
+        try
+        {
+            entry.typeInfo = makeTypeInfo(typeDecl.first, *declIt);
+            break;
+        }
+        catch (TypeException&)
+        {
+        }
+    }
+
+    // the declarations are not needed any more
+    entry.decls.clear();
+    entry.decls.shrink_to_fit();
+
+    return entry.typeInfo;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypeInfoPtr TypeInfoProviderClang::makeTypeInfo(const std::string& name, const ClangTypeDecl::DeclRef& declRef)
+{
+    switch ( declRef.first )
+    {
+    case ClangTypeDecl::StructKind:
+        return TypeInfoPtr( new TypeInfoClangStruct(strToWStr(name), m_astSession, llvm::cast<RecordDecl>(declRef.second)) );
+
+    case ClangTypeDecl::StructNoDefKind:
+        return TypeInfoPtr( new TypeInfoClangStructNoDef(strToWStr(name), m_astSession, llvm::cast<RecordDecl>(declRef.second)) );
+
+    case ClangTypeDecl::TypedefKind:
+        return getTypeForClangType(m_astSession, llvm::cast<TypedefDecl>(declRef.second)->getUnderlyingType().getCanonicalType());
+
+    case ClangTypeDecl::FuncKind:
+        return TypeInfoPtr( new TypeInfoClangFunc(m_astSession, llvm::cast<FunctionDecl>(declRef.second)) );
+
+    case ClangTypeDecl::EnumKind:
+        return TypeInfoPtr( new TypeInfoClangEnum(m_astSession, llvm::cast<EnumDecl>(declRef.second)) );
+    }
+
+    throw TypeException(strToWStr(name), L"unknown declaration kind");
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -885,26 +902,32 @@ std::wstring TypeInfoProviderClang::makeTypeName(const std::wstring& typeName, c
 
 ///////////////////////////////////////////////////////////////////////////////
 
-TypeInfoProviderClangEnum::TypeInfoProviderClangEnum(const std::wstring& mask, const boost::shared_ptr<TypeInfoProviderClang>& clangProvider )
+TypeInfoProviderClangEnum::TypeInfoProviderClangEnum(const std::wstring& mask, const boost::shared_ptr<TypeInfoProviderClang>& clangProvider ) :
+    m_clangProvider(clangProvider)
 {
     m_index = 0;
 
-    std::string  ansimask = wstrToStr(mask);
+    GlobPatternA  ansimask(wstrToStr(mask));
 
-    std::for_each( clangProvider->m_typeCache.begin(), clangProvider->m_typeCache.end(),
-        [&]( const std::pair<std::string, TypeInfoPtr> &it ) {
-            if (ansimask.empty() || fnmatch(ansimask, it.first) )
-                m_typeList.push_back(it.second);
-        }
-    );
+    for ( auto it = clangProvider->m_typeDecls.begin(); it != clangProvider->m_typeDecls.end(); ++it )
+    {
+        if (ansimask.empty() || ansimask.match(it->first) )
+            m_typeList.push_back(it);
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 TypeInfoPtr TypeInfoProviderClangEnum::Next()
 {
-    if ( m_index < m_typeList.size() )
-        return m_typeList[m_index++];
+    // the names without a valid type are skipped
+    while ( m_index < m_typeList.size() )
+    {
+        TypeInfoPtr  typeInfo = m_clangProvider->getTypeInfo(*m_typeList[m_index++]);
+        if ( typeInfo )
+            return typeInfo;
+    }
+
     return TypeInfoPtr();
 }
 
@@ -994,7 +1017,7 @@ bool SymbolEnumeratorClang::Next()
     while (m_index + 1 < symbols.size() )
     {
         const auto& sym = symbols[++m_index];
-        if (m_mask.empty() || fnmatch(m_mask, sym.first))
+        if (m_mask.empty() || m_mask.match(sym.first))
         {
             return true;
         }
@@ -1,12 +1,14 @@
 #pragma once
 
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include <clang/Frontend/ASTUnit.h>
 #include <clang/AST/Type.h>
 
 
 #include "typeinfoimp.h"
+#include "fnmatch.h"
 
 
 namespace kdlib {
@@ -360,6 +362,29 @@ protected:
 
 
 
+// A declaration found for a type name, the type is built on the first request.
+// A name declared several times keeps all the declarations: the last one that
+// makes a valid type wins
+struct ClangTypeDecl
+{
+    enum DeclKind {
+        StructKind,
+        StructNoDefKind,
+        TypedefKind,
+        FuncKind,
+        EnumKind
+    };
+
+    typedef std::pair<DeclKind, clang::Decl*>  DeclRef;
+
+    std::vector<DeclRef>  decls;    // cleared if none of them makes a valid type
+
+    TypeInfoPtr  typeInfo;
+};
+
+typedef std::map<std::string, ClangTypeDecl>  ClangTypeDeclMap;
+
+
 class TypeInfoProviderClangEnum  : public TypeInfoEnumerator {
 
 public:
@@ -373,7 +398,9 @@ private:
 
     size_t   m_index;
 
-    std::vector<TypeInfoPtr>  m_typeList;
+    std::vector<ClangTypeDeclMap::iterator>  m_typeList;
+
+    boost::shared_ptr<TypeInfoProviderClang>  m_clangProvider;
 };
 
 
@@ -394,11 +421,20 @@ private:
 
     std::wstring makeTypeName(const std::wstring& typeName, const std::wstring& typeQualifier, bool isConst) override;
 
+    // returns NULL if no declaration makes a valid type
+    TypeInfoPtr getTypeInfo(ClangTypeDeclMap::value_type& typeDecl);
+
+    TypeInfoPtr makeTypeInfo(const std::string& name, const ClangTypeDecl::DeclRef& declRef);
+
 private:
 
     ClangASTSessionPtr  m_astSession;
 
-    std::map< std::string, TypeInfoPtr>  m_typeCache;
+    // not recursive: makeTypeInfo is called under the lock, and the TypeInfoClang*
+    // types it builds only use the AST session, never this provider
+    boost::mutex  m_typeLock;
+
+    ClangTypeDeclMap  m_typeDecls;
 };
 
 
@@ -447,7 +483,7 @@ private:
 
     size_t   m_index;
 
-    std::string  m_mask;
+    GlobPatternA  m_mask;
 
     boost::shared_ptr<SymbolProviderClang> m_symbolProvider;
 };
@@ -3,6 +3,8 @@
 #include <memory>
 #include <regex>
 
+#include <boost/atomic.hpp>
+
 #include "clang/Basic/MemoryBufferCache.h"
 #include "clang/Basic/TargetOptions.h"
 #include "clang/Basic/TargetInfo.h"
@@ -19,8 +21,10 @@
 #include "kdlib/exceptions.h"
 
 #include "evalexpr.h"
+#include "exprlexer.h"
 #include "strconvert.h"
 #include "exprparser.h"
+#include "typeinfoimp.h"
 
 namespace kdlib {
 
@@ -45,90 +49,99 @@ TypedValue evalExpr(const std::wstring& expr, const ScopePtr& scope, const TypeI
 
 TypedValue evalExpr(const std::string& expr, const ScopePtr& scope, const TypeInfoProviderPtr& typeInfoProvider)
 {
-    auto  preprocessorOptions = std::make_shared<clang::PreprocessorOptions>();
-
-    llvm::IntrusiveRefCntPtr<clang::DiagnosticIDs> diagnosticIDs(new clang::DiagnosticIDs());
-
-    auto diagnosticOptions = new clang::DiagnosticOptions();
-
-    //auto textDiagnosticPrinter = new clang::TextDiagnosticPrinter(llvm::outs(), diagnosticOptions);
+    return compileExpr(expr)->eval(scope, typeInfoProvider);
+}
 
-    auto diagnosticConsumer = new clang::IgnoringDiagConsumer();
+///////////////////////////////////////////////////////////////////////////////
 
-    clang::DiagnosticsEngine  diagnosticEngine(diagnosticIDs, diagnosticOptions, diagnosticConsumer);
+TypeInfoPtr evalType(const std::wstring& expr, const TypeInfoProviderPtr typeInfoProvider)
+{
+    return evalType(wstrToStr(expr), typeInfoProvider);
+}
 
-    clang::LangOptions  langOptions;
+///////////////////////////////////////////////////////////////////////////////
 
-    llvm::IntrusiveRefCntPtr<clang::vfs::InMemoryFileSystem>  memoryFileSystem(new clang::vfs::InMemoryFileSystem());
+TypeInfoPtr evalType(const std::string& expr, const TypeInfoProviderPtr typeInfoProvider)
+{
+    boost::shared_ptr<CompiledExpressionImpl>  compiled = boost::static_pointer_cast<CompiledExpressionImpl>(compileExpr(expr));
 
-    memoryFileSystem->addFile("<input>", 0, llvm::MemoryBuffer::getMemBuffer(expr));
+    return compiled->evalType(typeInfoProvider);
+}
 
-    clang::FileSystemOptions  fileSystemOptions;
-    clang::FileManager  fileManager(fileSystemOptions, memoryFileSystem);
-    clang::SourceManager  sourceManager(diagnosticEngine, fileManager);
+///////////////////////////////////////////////////////////////////////////////
 
-    const clang::FileEntry *pFile = fileManager.getFile("<input>");
-    clang::FileID  fileID = sourceManager.getOrCreateFileID(pFile, clang::SrcMgr::C_User);
-    sourceManager.setMainFileID(fileID);
+CompiledExpressionPtr compileExpr(const std::wstring& expr)
+{
+    return compileExpr(wstrToStr(expr));
+}
 
-    clang::MemoryBufferCache  memoryBufferCache;
+///////////////////////////////////////////////////////////////////////////////
 
-    auto headerSearchOptions = std::make_shared<clang::HeaderSearchOptions>();
-    auto targetOptions = std::make_shared<clang::TargetOptions>();
-    targetOptions->Triple = llvm::sys::getDefaultTargetTriple();
-    clang::TargetInfo*  targetInfo = clang::TargetInfo::CreateTargetInfo(diagnosticEngine, targetOptions);
-    clang::HeaderSearch  headerSearch(headerSearchOptions, sourceManager, diagnosticEngine, langOptions, targetInfo);
+namespace {
 
-    clang::CompilerInstance  compilerInstance;
+CompiledExpressionCache  g_exprCache(256);
 
-    clang::Preprocessor   preprocessor(
-        preprocessorOptions,
-        diagnosticEngine,
-        langOptions,
-        sourceManager,
-        memoryBufferCache,
-        headerSearch,
-        compilerInstance
-    );
-    preprocessor.Initialize(*targetInfo);
+boost::atomic<bool>  g_clangExprLexer(false);
 
-    preprocessor.EnterMainSourceFile();
-    diagnosticConsumer->BeginSourceFile(langOptions, &preprocessor);
+}
 
-    clang::Token token;
+///////////////////////////////////////////////////////////////////////////////
 
-    std::list<clang::Token>  tokens;
+CompiledExpressionPtr compileExpr(const std::string& expr)
+{
+    CompiledExpressionPtr  compiled = g_exprCache.find(expr);
+    if (compiled)
+        return compiled;
 
-    do {
+    const bool  clangLexer = g_clangExprLexer;
 
-        preprocessor.Lex(token);
+    compiled = CompiledExpressionPtr(new CompiledExpressionImpl(expr, clangLexer));
 
-        if (diagnosticEngine.hasErrorOccurred())
-        {
-            NOT_IMPLEMENTED();
-        }
+    // an expression compiled while the lexer was switched is not cached
+    if (clangLexer == g_clangExprLexer)
+        g_exprCache.insert(expr, compiled);
 
-        tokens.push_back(token);
+    return compiled;
+}
 
-    } while (!token.is(clang::tok::eof));
+///////////////////////////////////////////////////////////////////////////////
 
-    diagnosticConsumer->EndSourceFile();
+void resetExprCache()
+{
+    g_exprCache.clear();
+}
 
-    ExprEval  exprEval(scope, typeInfoProvider, &tokens);
+///////////////////////////////////////////////////////////////////////////////
 
-    return exprEval.getResult();
+void enableClangExprLexer(bool enable)
+{
+    // the cached expressions were tokenized by the other lexer
+    if (g_clangExprLexer.exchange(enable) != enable)
+        g_exprCache.clear();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-TypeInfoPtr evalType(const std::wstring& expr, const TypeInfoProviderPtr typeInfoProvider)
+CompiledExpressionImpl::CompiledExpressionImpl(const std::string& expr, bool clangLexer) :
+    m_identifiers(m_langOptions)
 {
-    return evalType(wstrToStr(expr), typeInfoProvider);
+    if (!clangLexer)
+    {
+        ExprLexer  lexer(m_langOptions, m_identifiers, m_literals);
+
+        if (lexer.lex(expr, m_tokens))
+            return;
+
+        m_tokens.clear();
+        m_literals.clear();
+    }
+
+    lexClang(expr);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-TypeInfoPtr evalType(const std::string& expr, const TypeInfoProviderPtr typeInfoProvider)
+void CompiledExpressionImpl::lexClang(const std::string& expr)
 {
     auto  preprocessorOptions = std::make_shared<clang::PreprocessorOptions>();
 
@@ -142,10 +155,9 @@ TypeInfoPtr evalType(const std::string& expr, const TypeInfoProviderPtr typeInfo
 
     clang::DiagnosticsEngine  diagnosticEngine(diagnosticIDs, diagnosticOptions, diagnosticConsumer);
 
-    clang::LangOptions  langOptions;
-
     llvm::IntrusiveRefCntPtr<clang::vfs::InMemoryFileSystem>  memoryFileSystem(new clang::vfs::InMemoryFileSystem());
-    memoryFileSystem->addFile("<input>", 0, llvm::MemoryBuffer::getMemBuffer(expr.c_str()));
+
+    memoryFileSystem->addFile("<input>", 0, llvm::MemoryBuffer::getMemBuffer(expr));
 
     clang::FileSystemOptions  fileSystemOptions;
     clang::FileManager  fileManager(fileSystemOptions, memoryFileSystem);
@@ -161,14 +173,14 @@ TypeInfoPtr evalType(const std::string& expr, const TypeInfoProviderPtr typeInfo
     auto targetOptions = std::make_shared<clang::TargetOptions>();
     targetOptions->Triple = llvm::sys::getDefaultTargetTriple();
     clang::TargetInfo*  targetInfo = clang::TargetInfo::CreateTargetInfo(diagnosticEngine, targetOptions);
-    clang::HeaderSearch  headerSearch(headerSearchOptions, sourceManager, diagnosticEngine, langOptions, targetInfo);
+    clang::HeaderSearch  headerSearch(headerSearchOptions, sourceManager, diagnosticEngine, m_langOptions, targetInfo);
 
     clang::CompilerInstance  compilerInstance;
 
     clang::Preprocessor   preprocessor(
         preprocessorOptions,
         diagnosticEngine,
-        langOptions,
+        m_langOptions,
         sourceManager,
         memoryBufferCache,
         headerSearch,
@@ -177,12 +189,10 @@ TypeInfoPtr evalType(const std::string& expr, const TypeInfoProviderPtr typeInfo
     preprocessor.Initialize(*targetInfo);
 
     preprocessor.EnterMainSourceFile();
-    diagnosticConsumer->BeginSourceFile(langOptions, &preprocessor);
+    diagnosticConsumer->BeginSourceFile(m_langOptions, &preprocessor);
 
     clang::Token token;
 
-    std::list<clang::Token>  tokens;
-
     do {
 
         preprocessor.Lex(token);
@@ -192,11 +202,51 @@ TypeInfoPtr evalType(const std::string& expr, const TypeInfoProviderPtr typeInfo
             NOT_IMPLEMENTED();
         }
 
-        tokens.push_back(token);
+        m_tokens.push_back(detachToken(token));
 
     } while (!token.is(clang::tok::eof));
 
     diagnosticConsumer->EndSourceFile();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+clang::Token CompiledExpressionImpl::detachToken(const clang::Token& token)
+{
+    // the token must not refer the preprocessor's identifiers and buffers:
+    // they are destroyed after the expression is lexed
+
+    clang::Token  detached = token;
+
+    if (token.isLiteral() && token.getLiteralData())
+    {
+        m_literals.push_back(std::string(token.getLiteralData(), token.getLength()));
+        detached.setLiteralData(m_literals.back().c_str());
+    }
+    else if (token.getIdentifierInfo())
+    {
+        detached.setIdentifierInfo(&m_identifiers.get(token.getIdentifierInfo()->getName()));
+    }
+
+    return detached;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypedValue CompiledExpressionImpl::eval(const ScopePtr& scope, const TypeInfoProviderPtr& typeInfoProvider)
+{
+    std::list<clang::Token>  tokens(m_tokens);
+
+    ExprEval  exprEval(scope, typeInfoProvider, &tokens);
+
+    return exprEval.getResult();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypeInfoPtr CompiledExpressionImpl::evalType(const TypeInfoProviderPtr& typeInfoProvider)
+{
+    std::list<clang::Token>  tokens(m_tokens);
 
     TypeEval  exprEval(ScopePtr(new ScopeList()), typeInfoProvider, &tokens);
 
@@ -205,6 +255,49 @@ TypeInfoPtr evalType(const std::string& expr, const TypeInfoProviderPtr typeInfo
 
 ///////////////////////////////////////////////////////////////////////////////
 
+CompiledExpressionPtr CompiledExpressionCache::find(const std::string& expr)
+{
+    boost::mutex::scoped_lock  l(m_lock);
+
+    ExprMap::iterator  it = m_exprMap.find(expr);
+    if (it == m_exprMap.end())
+        return CompiledExpressionPtr();
+
+    m_exprList.splice(m_exprList.begin(), m_exprList, it->second);
+    return it->second->second;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void CompiledExpressionCache::clear()
+{
+    boost::mutex::scoped_lock  l(m_lock);
+
+    m_exprMap.clear();
+    m_exprList.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void CompiledExpressionCache::insert(const std::string& expr, const CompiledExpressionPtr& compiled)
+{
+    boost::mutex::scoped_lock  l(m_lock);
+
+    if (m_exprMap.find(expr) != m_exprMap.end())
+        return;
+
+    while (!m_exprList.empty() && m_exprList.size() >= m_maxSize)
+    {
+        m_exprMap.erase(m_exprList.back().first);
+        m_exprList.pop_back();
+    }
+
+    m_exprList.push_front(std::make_pair(expr, compiled));
+    m_exprMap[expr] = m_exprList.begin();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 ExprEval::ExprEval(const ScopePtr& scope,
     const TypeInfoProviderPtr& typeInfoProvider,
     std::list<clang::Token>* tokens,
@@ -1715,50 +1808,45 @@ TypedValue TypeCastOperation::castToBase(const TypedValue& val)
     else
         throw ExprException(L"error syntax");
 
-    if (m_type->getName() == L"Char")
-        return srcValue.asChar();
-
-    if (m_type->getName() == L"WChar")
-        return srcValue.asShort();
-
-    if (m_type->getName() == L"Long")
-        return srcValue.asLong();
-
-    if (m_type->getName() == L"ULong")
-        return srcValue.asULong();
-
-    if (m_type->getName() == L"Int1B")
+    switch (getBaseTypeKind(m_type))
+    {
+    case BaseTypeChar:
+    case BaseTypeInt1B:
         return srcValue.asChar();
 
-    if (m_type->getName() == L"UInt1B")
+    case BaseTypeUInt1B:
         return srcValue.asUChar();
 
-    if (m_type->getName() == L"Int2B")
+    case BaseTypeWChar:
+    case BaseTypeInt2B:
         return srcValue.asShort();
 
-    if (m_type->getName() == L"UInt2B")
+    case BaseTypeUInt2B:
         return srcValue.asUShort();
 
-    if (m_type->getName() == L"Int4B")
+    case BaseTypeLong:
+    case BaseTypeInt4B:
         return srcValue.asLong();
 
-    if (m_type->getName() == L"UInt4B")
+    case BaseTypeULong:
+    case BaseTypeUInt4B:
         return srcValue.asULong();
 
-    if (m_type->getName() == L"Int8B")
+    case BaseTypeInt8B:
         return srcValue.asLongLong();
 
-    if (m_type->getName() == L"UInt8B")
+    case BaseTypeUInt8B:
         return srcValue.asULongLong();
 
-    if (m_type->getName() == L"Float")
+    case BaseTypeFloat:
         return srcValue.asFloat();
 
-    if (m_type->getName() == L"Double")
+    case BaseTypeDouble:
         return srcValue.asDouble();
 
-    if (m_type->getName() == L"Bool")
+    case BaseTypeBool:
         return srcValue.asBool();
+    }
 
     NOT_IMPLEMENTED();
 }
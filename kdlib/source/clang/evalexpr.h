@@ -1,5 +1,13 @@
 #pragma once
 
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include <boost/thread/mutex.hpp>
+
+#include "clang/Basic/IdentifierTable.h"
+#include "clang/Basic/LangOptions.h"
 #include "clang/Lex/Token.h"
 
 #include "kdlib/typedvar.h"
@@ -427,6 +435,60 @@ class BoolAndOperation : public BinOperation {
 };
 
 
+///////////////////////////////////////////////////////////////////////////////
+
+// Token list of an expression lexed once. Tokens keep their own copies of
+// identifiers and literals, so the clang preprocessor is not kept alive.
+// The built-in ExprLexer is tried first, clang lexes what it can not
+class CompiledExpressionImpl : public CompiledExpression
+{
+public:
+
+    CompiledExpressionImpl(const std::string& expr, bool clangLexer);
+
+    TypedValue eval(const ScopePtr& scope, const TypeInfoProviderPtr& typeInfoProvider) override;
+
+    TypeInfoPtr evalType(const TypeInfoProviderPtr& typeInfoProvider);
+
+private:
+
+    void lexClang(const std::string& expr);
+
+    clang::Token detachToken(const clang::Token& token);
+
+    clang::LangOptions  m_langOptions;
+    clang::IdentifierTable  m_identifiers;
+    std::list<std::string>  m_literals;
+    std::list<clang::Token>  m_tokens;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class CompiledExpressionCache
+{
+public:
+
+    explicit CompiledExpressionCache(size_t maxSize) :
+        m_maxSize(maxSize)
+    {}
+
+    CompiledExpressionPtr find(const std::string& expr);
+
+    void insert(const std::string& expr, const CompiledExpressionPtr& compiled);
+
+    void clear();
+
+private:
+
+    typedef std::list< std::pair<std::string, CompiledExpressionPtr> >  ExprList;
+    typedef std::unordered_map<std::string, ExprList::iterator>  ExprMap;
+
+    boost::mutex  m_lock;
+    ExprList  m_exprList;
+    ExprMap  m_exprMap;
+    size_t  m_maxSize;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class ExprEval {
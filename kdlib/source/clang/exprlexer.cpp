@@ -0,0 +1,319 @@
+#include <stdafx.h>
+
+#include <cstring>
+
+#include "exprlexer.h"
+
+namespace kdlib {
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+
+inline bool isIdentifierHead(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline bool isIdentifierBody(char c)
+{
+    return isIdentifierHead(c) || isDigit(c);
+}
+
+inline bool isWhitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// names handled by the clang preprocessor itself ( __LINE__, __has_include, ... )
+bool isBuiltinMacro(const char* begin, size_t length)
+{
+    if (length == 7 && std::strncmp(begin, "_Pragma", length) == 0)
+        return true;
+
+    if (length < 4 || begin[0] != '_' || begin[1] != '_')
+        return false;
+
+    if (begin[length - 1] == '_' && begin[length - 2] == '_')
+        return true;
+
+    std::string  name(begin, length);
+
+    return name.compare(0, 6, "__has_") == 0 ||
+        name.compare(0, 5, "__is_") == 0 ||
+        name == "__building_module" ||
+        name == "__identifier";
+}
+
+struct Punctuator {
+    const char*  spelling;
+    clang::tok::TokenKind  kind;
+};
+
+// longest first
+const Punctuator  punctuators[] = {
+    { "...", clang::tok::ellipsis },
+    { "<<=", clang::tok::lesslessequal },
+    { ">>=", clang::tok::greatergreaterequal },
+    { "->", clang::tok::arrow },
+    { "++", clang::tok::plusplus },
+    { "--", clang::tok::minusminus },
+    { "<<", clang::tok::lessless },
+    { ">>", clang::tok::greatergreater },
+    { "<=", clang::tok::lessequal },
+    { ">=", clang::tok::greaterequal },
+    { "==", clang::tok::equalequal },
+    { "!=", clang::tok::exclaimequal },
+    { "&&", clang::tok::ampamp },
+    { "||", clang::tok::pipepipe },
+    { "*=", clang::tok::starequal },
+    { "/=", clang::tok::slashequal },
+    { "%=", clang::tok::percentequal },
+    { "+=", clang::tok::plusequal },
+    { "-=", clang::tok::minusequal },
+    { "&=", clang::tok::ampequal },
+    { "^=", clang::tok::caretequal },
+    { "|=", clang::tok::pipeequal },
+    { "[", clang::tok::l_square },
+    { "]", clang::tok::r_square },
+    { "(", clang::tok::l_paren },
+    { ")", clang::tok::r_paren },
+    { "{", clang::tok::l_brace },
+    { "}", clang::tok::r_brace },
+    { ".", clang::tok::period },
+    { "&", clang::tok::amp },
+    { "*", clang::tok::star },
+    { "+", clang::tok::plus },
+    { "-", clang::tok::minus },
+    { "~", clang::tok::tilde },
+    { "!", clang::tok::exclaim },
+    { "/", clang::tok::slash },
+    { "%", clang::tok::percent },
+    { "<", clang::tok::less },
+    { ">", clang::tok::greater },
+    { "^", clang::tok::caret },
+    { "|", clang::tok::pipe },
+    { "?", clang::tok::question },
+    { ":", clang::tok::colon },
+    { ";", clang::tok::semi },
+    { "=", clang::tok::equal },
+    { ",", clang::tok::comma }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ExprLexer::lex(const std::string& expr, std::list<clang::Token>& tokens)
+{
+    const char*  cur = expr.c_str();
+    const char*  end = cur + expr.size();
+
+    while (true)
+    {
+        while (cur < end && isWhitespace(*cur))
+            ++cur;
+
+        clang::Token  token;
+        token.startToken();
+
+        if (cur == end)
+        {
+            token.setKind(clang::tok::eof);
+            tokens.push_back(token);
+            return true;
+        }
+
+        bool  res;
+
+        if (isIdentifierHead(*cur) || (*cur == '$' && m_langOptions.DollarIdents))
+            res = lexIdentifier(cur, end, token);
+        else if (isDigit(*cur) || (*cur == '.' && cur + 1 < end && isDigit(cur[1])))
+            res = lexNumber(cur, end, token);
+        else if (*cur == '\'')
+            res = lexCharConst(cur, end, clang::tok::char_constant, cur, token);
+        else
+            res = lexPunctuator(cur, end, token);
+
+        if (!res)
+            return false;
+
+        tokens.push_back(token);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ExprLexer::lexIdentifier(const char*& cur, const char* end, clang::Token& token)
+{
+    const char*  begin = cur;
+
+    while (cur < end && (isIdentifierBody(*cur) || (*cur == '$' && m_langOptions.DollarIdents)))
+        ++cur;
+
+    size_t  length = cur - begin;
+
+    if (cur < end)
+    {
+        if (*cur == '\'' && length == 1 && *begin == 'L')
+            return lexCharConst(cur, end, clang::tok::wide_char_constant, begin, token);
+
+        // u8'', u'', U'' and string literals
+        if (*cur == '\'' || *cur == '"' || *cur == '\\' || static_cast<unsigned char>(*cur) >= 0x80)
+            return false;
+    }
+
+    if (isBuiltinMacro(begin, length))
+        return false;
+
+    clang::IdentifierInfo&  identifierInfo = m_identifiers.get(llvm::StringRef(begin, length));
+
+    token.setKind(identifierInfo.getTokenID());
+    token.setLength(static_cast<unsigned>(length));
+    token.setIdentifierInfo(&identifierInfo);
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ExprLexer::lexNumber(const char*& cur, const char* end, clang::Token& token)
+{
+    const char*  begin = cur;
+    char  prev = 0;
+
+    while (cur < end)
+    {
+        char  c = *cur;
+
+        if (isIdentifierBody(c) || c == '.')
+        {
+            prev = c;
+            ++cur;
+            continue;
+        }
+
+        if ((c == '+' || c == '-') && (prev == 'e' || prev == 'E'))
+        {
+            // MSVC mode splits 0x1e+1 into three tokens
+            if (m_langOptions.MicrosoftExt && end - begin > 1 && begin[0] == '0' && (begin[1] == 'x' || begin[1] == 'X'))
+                return false;
+
+            prev = c;
+            ++cur;
+            continue;
+        }
+
+        // hexadecimal floats, digit separators, UCNs
+        if (((c == '+' || c == '-') && (prev == 'p' || prev == 'P')) ||
+            c == '\'' || c == '\\' || c == '$' || static_cast<unsigned char>(c) >= 0x80)
+        {
+            return false;
+        }
+
+        break;
+    }
+
+    setLiteral(token, clang::tok::numeric_constant, begin, cur);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ExprLexer::lexCharConst(const char*& cur, const char* end, clang::tok::TokenKind kind, const char* start, clang::Token& token)
+{
+    // cur points to the opening quote
+    const char*  p = cur + 1;
+
+    while (p < end && *p != '\'')
+    {
+        if (*p == '\n' || *p == '\r' || *p == '\0')
+            return false;
+
+        if (*p == '\\')
+        {
+            ++p;
+            if (p == end || *p == '\n' || *p == '\r')
+                return false;
+        }
+
+        ++p;
+    }
+
+    // unterminated or empty constant: let clang report it
+    if (p == end || p == cur + 1)
+        return false;
+
+    cur = p + 1;
+
+    setLiteral(token, kind, start, cur);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ExprLexer::lexPunctuator(const char*& cur, const char* end, clang::Token& token)
+{
+    size_t  rest = end - cur;
+
+    // C++ only tokens, digraphs, trigraphs, comments, directives and
+    // escaped newlines are left to clang
+    if (m_langOptions.CPlusPlus)
+        return false;
+
+    if (rest >= 2)
+    {
+        if ((cur[0] == '/' && (cur[1] == '*' || cur[1] == '/')) || (cur[0] == '?' && cur[1] == '?'))
+            return false;
+
+        if (m_langOptions.Digraphs)
+        {
+            static const char*  digraphs[] = { "<:", ":>", "<%", "%>", "%:" };
+            for (const char* digraph : digraphs)
+            {
+                if (cur[0] == digraph[0] && cur[1] == digraph[1])
+                    return false;
+            }
+        }
+    }
+
+    for (const Punctuator& punctuator : punctuators)
+    {
+        if (punctuator.spelling[0] != cur[0])
+            continue;
+
+        size_t  length = std::strlen(punctuator.spelling);
+
+        if (length <= rest && std::strncmp(cur, punctuator.spelling, length) == 0)
+        {
+            token.setKind(punctuator.kind);
+            token.setLength(static_cast<unsigned>(length));
+            cur += length;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ExprLexer::setLiteral(clang::Token& token, clang::tok::TokenKind kind, const char* begin, const char* end)
+{
+    m_literals.push_back(std::string(begin, end));
+
+    token.setKind(kind);
+    token.setLength(static_cast<unsigned>(end - begin));
+    token.setLiteralData(m_literals.back().c_str());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <list>
+#include <string>
+
+#include "clang/Basic/IdentifierTable.h"
+#include "clang/Basic/LangOptions.h"
+#include "clang/Lex/Token.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Tokenizer for one-line expressions, producing the same tokens as the clang
+// preprocessor with the same language options. Anything it does not cover
+// ( string literals, comments, macros, escaped newlines, ... ) makes lex()
+// return false, and the caller must use the clang preprocessor instead
+class ExprLexer
+{
+public:
+
+    ExprLexer(const clang::LangOptions& langOptions, clang::IdentifierTable& identifiers, std::list<std::string>& literals) :
+        m_langOptions(langOptions),
+        m_identifiers(identifiers),
+        m_literals(literals)
+    {}
+
+    bool lex(const std::string& expr, std::list<clang::Token>& tokens);
+
+private:
+
+    bool lexIdentifier(const char*& cur, const char* end, clang::Token& token);
+    bool lexNumber(const char*& cur, const char* end, clang::Token& token);
+    bool lexCharConst(const char*& cur, const char* end, clang::tok::TokenKind kind, const char* start, clang::Token& token);
+    bool lexPunctuator(const char*& cur, const char* end, clang::Token& token);
+
+    void setLiteral(clang::Token& token, clang::tok::TokenKind kind, const char* begin, const char* end);
+
+    const clang::LangOptions&  m_langOptions;
+    clang::IdentifierTable&  m_identifiers;
+    std::list<std::string>&  m_literals;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
@@ -6,9 +6,9 @@ namespace kdlib {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-DataAccessorPtr  getMemoryAccessor( MEMOFFSET_64  offset, size_t length) 
+DataAccessorPtr  getMemoryAccessor( MEMOFFSET_64  offset, size_t length, bool prefetch) 
 {
-    return DataAccessorPtr( new MemoryAccessor(offset, length) );
+    return DataAccessorPtr( new MemoryAccessor(offset, length, prefetch) );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -43,8 +43,8 @@ DataAccessorPtr getCacheAccessor(const std::vector<char>& buffer, const std::wst
 
 DataAccessorPtr getCacheAccessor(const void* rawBuffer, size_t bufferSize, const std::wstring&  location)
 {
-    std::vector<char>  buffer( reinterpret_cast<const char*>(rawBuffer), reinterpret_cast<const char*>(rawBuffer) + bufferSize);
-    return getCacheAccessor(buffer, location);
+    const char*  begin = reinterpret_cast<const char*>(rawBuffer);
+    return getSharedCacheAccessor(boost::make_shared< std::vector<char> >(begin, begin + bufferSize), 0, bufferSize, location);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -56,4 +56,11 @@ DataAccessorPtr getCacheAccessor(const NumVariant& var, const std::wstring&  loc
 
 ///////////////////////////////////////////////////////////////////////////////
 
+DataAccessorPtr getSharedCacheAccessor(const boost::shared_ptr< std::vector<char> >& buffer, size_t offset, size_t length, const std::wstring&  location)
+{
+    return DataAccessorPtr(new CacheAccessor(buffer, offset, length, location));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 }
@@ -2,12 +2,16 @@
 
 #include <boost/noncopyable.hpp>
 #include <boost/enable_shared_from_this.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include "kdlib/dataaccessor.h"
 #include "kdlib/memaccess.h"
 #include "kdlib/exceptions.h"
 #include "kdlib/cpucontext.h"
 
+#include "memcache.h"
+
 namespace kdlib {
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -21,6 +25,16 @@ private:
         throw DbgException("data accessor no data");
     }
 
+    virtual void readRaw(void* dst, size_t length, size_t pos = 0) const
+    {
+        throw DbgException("data accessor no data");
+    }
+
+    virtual void writeRaw(const void* src, size_t length, size_t pos = 0)
+    {
+        throw DbgException("data accessor no data");
+    }
+
     virtual unsigned char readByte(size_t pos = 0) const
     {
         throw DbgException("data accessor no data");
@@ -254,13 +268,16 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
-class MemoryAccessor : public EmptyAccessor
+class MemoryAccessor : public EmptyAccessor, public boost::enable_shared_from_this<MemoryAccessor>
 {
 public:
 
-    MemoryAccessor(MEMOFFSET_64 offset, size_t length) :
+    MemoryAccessor(MEMOFFSET_64 offset, size_t length, bool prefetch = false) :
         m_begin(addr64(offset)),
-        m_length(length)
+        m_length(length),
+        m_prefetch(prefetch),
+        m_cacheState(CacheEmpty),
+        m_cacheGeneration(0)
     {}
 
 private:
@@ -270,12 +287,36 @@ private:
         return m_length;
     }
 
+    virtual void readRaw(void* dst, size_t length, size_t pos = 0) const
+    {
+        if ( length > m_length || pos > m_length - length )
+            throw DbgException("memory accessor range error");
+
+        if ( length == 0 )
+            return;
+
+        if ( !m_prefetch || !readCache(dst, length, pos) )
+            readMemory(m_begin + pos, dst, length);
+    }
+
+    virtual void writeRaw(const void* src, size_t length, size_t pos = 0)
+    {
+        if ( length > m_length || pos > m_length - length )
+            throw DbgException("memory accessor range error");
+
+        if ( length == 0 )
+            return;
+
+        // the write changes the memory generation so the snapshot is refetched
+        writeMemory(m_begin + pos, src, length);
+    }
+
     virtual unsigned char readByte(size_t pos = 0) const
     {
         if (pos >= m_length)
             throw DbgException("memory accessor range error");
 
-        return ptrByte(m_begin + pos);
+        return readValue<unsigned char>(pos);
     }
 
     virtual void writeByte(unsigned char value, size_t pos=0) 
@@ -283,112 +324,112 @@ private:
         if (pos >= m_length)
             throw DbgException("memory accessor range error");
 
-        setByte(m_begin + pos, value);
+        writeValue<unsigned char>(value, pos);
     }
 
     virtual char readSignByte(size_t pos = 0) const
     {
         if (pos >= m_length)
             throw DbgException("memory accessor range error");
-        return ptrSignByte(m_begin + pos);
+        return readValue<char>(pos);
     }
 
     virtual void writeSignByte(char value, size_t pos=0)
     {
         if (pos >= m_length)
             throw DbgException("memory accessor range error");
-        setSignByte(m_begin + pos, value);
+        writeValue<char>(value, pos);
     }
 
     virtual unsigned short readWord(size_t pos = 0) const
     {
         if (pos >= m_length / sizeof(unsigned short) )
             throw DbgException("memory accessor range error");
-        return ptrWord(m_begin + pos * sizeof(unsigned short));
+        return readValue<unsigned short>(pos);
     }
 
     virtual void writeWord(unsigned short value, size_t pos=0)
     {
         if (pos >= m_length / sizeof(unsigned short) )
             throw DbgException("memory accessor range error");
-        setWord(m_begin + pos * sizeof(unsigned short), value);
+        writeValue<unsigned short>(value, pos);
     }
 
     virtual short readSignWord(size_t pos = 0) const
     {
         if (pos  >= m_length / sizeof(short) )
             throw DbgException("memory accessor range error");
-        return ptrSignWord(m_begin + pos * sizeof(short));
+        return readValue<short>(pos);
     }
 
     virtual void writeSignWord(short value, size_t pos=0)
     {
         if (pos >= m_length / sizeof(short) )
             throw DbgException("memory accessor range error");
-        setSignWord(m_begin + pos * sizeof(short), value);
+        writeValue<short>(value, pos);
     }
 
     virtual unsigned long readDWord(size_t pos = 0) const
     {
         if (pos >= m_length / sizeof(unsigned long) )
             throw DbgException("memory accessor range error");
-        return ptrDWord(m_begin + pos * sizeof(unsigned long));
+        return readValue<unsigned long>(pos);
     }
 
     virtual void writeDWord(unsigned long value, size_t pos)
     {
         if (pos >= m_length / sizeof(unsigned long) )
             throw DbgException("memory accessor range error");
-        setDWord(m_begin + pos * sizeof(unsigned long), value);
+        writeValue<unsigned long>(value, pos);
     }
 
     virtual long readSignDWord(size_t pos = 0) const
     {
         if (pos >= m_length /sizeof(long) )
             throw DbgException("memory accessor range error");
-        return ptrSignDWord(m_begin + pos * sizeof(long));
+        return readValue<long>(pos);
     }
 
     virtual void writeSignDWord(long value, size_t pos=0)
     {
         if (pos >= m_length /sizeof(long) )
             throw DbgException("memory accessor range error");
-        setSignDWord(m_begin + pos * sizeof(long), value);
+        writeValue<long>(value, pos);
     }
 
     virtual unsigned long long readQWord(size_t pos = 0) const
     {
         if (pos >= m_length / sizeof(unsigned long long) )
             throw DbgException("memory accessor range error");
-        return ptrQWord(m_begin + pos * sizeof(unsigned long long));
+        return readValue<unsigned long long>(pos);
     }
 
     virtual void writeQWord(unsigned long long value, size_t pos=0)
     {
         if (pos >= m_length / sizeof(unsigned long long) )
             throw DbgException("memory accessor range error");
-        setQWord(m_begin + pos * sizeof(unsigned long long), value);
+        writeValue<unsigned long long>(value, pos);
     }
 
     virtual long long readSignQWord(size_t pos = 0) const
     {
         if ( pos >= m_length / sizeof(long long) )
             throw DbgException("memory accessor range error");
-        return ptrSignQWord(m_begin + pos * sizeof(long long));
+        return readValue<long long>(pos);
     }
 
     virtual void writeSignQWord(long long value, size_t pos=0) 
     {
         if ( pos >= m_length / sizeof(long long) )
             throw DbgException("memory accessor range error");
-        setSignQWord(m_begin + pos * sizeof(long long), value);
+        writeValue<long long>(value, pos);
     }
 
     virtual float readFloat(size_t pos = 0) const
     {
         if (pos >= m_length / sizeof(float) )
             throw DbgException("memory accessor range error");
-        return ptrSingleFloat(m_begin + pos * sizeof(float));
+        return readValue<float>(pos);
     }
 
     virtual void writeFloat(float value, size_t pos=0) 
@@ -396,14 +437,14 @@ private:
         if (pos >= m_length / sizeof(float) )
             throw DbgException("memory accessor range error");
 
-        setSingleFloat(m_begin + pos * sizeof(float), value);
+        writeValue<float>(value, pos);
     }
 
     virtual double readDouble(size_t pos = 0) const
     {
         if (pos >= m_length / sizeof(double) )
             throw DbgException("memory accessor range error");
-        return ptrDoubleFloat(m_begin + pos * sizeof(double));
+        return readValue<double>(pos);
     }
 
     virtual void writeDouble(double value, size_t pos=0)
@@ -411,7 +452,7 @@ private:
         if (pos >= m_length / sizeof(double) )
             throw DbgException("memory accessor range error");
         
-        setDoubleFloat(m_begin + pos * sizeof(double), value);
+        writeValue<double>(value, pos);
     }
 
     virtual void readBytes(std::vector<unsigned char>& dataRange, size_t count, size_t pos = 0) const
@@ -419,14 +460,14 @@ private:
         if ( count > m_length - pos )
             throw DbgException("memory accessor range error");
  
-        dataRange = loadBytes(m_begin + pos, static_cast<unsigned long>(count) );
+        readValues(dataRange, count, pos);
     }
 
     virtual void writeBytes( const std::vector<unsigned char>&  dataRange, size_t pos=0) 
     {
         if ( dataRange.size() > m_length - pos )
             throw DbgException("memory accessor range error");
-        kdlib::writeBytes(m_begin + pos, dataRange);
+        writeValues(dataRange, pos);
     }
 
     virtual void readWords(std::vector<unsigned short>& dataRange, size_t count, size_t pos = 0) const
@@ -434,7 +475,7 @@ private:
         if ( count > m_length / sizeof(unsigned short) - pos )
             throw DbgException("memory accessor range error");
 
-        dataRange = loadWords(m_begin + pos* sizeof(unsigned short), static_cast<unsigned long>(count) );
+        readValues(dataRange, count, pos);
     }
 
     virtual void writeWords( const std::vector<unsigned short>&  dataRange, size_t pos=0) 
@@ -442,7 +483,7 @@ private:
         if ( dataRange.size() > m_length / sizeof(unsigned short) - pos )
             throw DbgException("memory accessor range error");
 
-        kdlib::writeWords(m_begin + pos* sizeof(unsigned short), dataRange);
+        writeValues(dataRange, pos);
     }
 
     virtual void readDWords(std::vector<unsigned long>& dataRange, size_t count, size_t pos = 0) const
@@ -450,7 +491,7 @@ private:
         if ( count > m_length / sizeof(unsigned long) - pos )
             throw DbgException("memory accessor range error");
 
-        dataRange = loadDWords(m_begin + pos* sizeof(unsigned long), static_cast<unsigned long>(count) );
+        readValues(dataRange, count, pos);
     }
 
     virtual void writeDWords( const std::vector<unsigned long>&  dataRange, size_t  pos=0)
@@ -458,7 +499,7 @@ private:
         if ( dataRange.size() > m_length / sizeof(unsigned long) - pos )
             throw DbgException("memory accessor range error");
 
-        kdlib::writeDWords(m_begin + pos* sizeof(unsigned long), dataRange);
+        writeValues(dataRange, pos);
     }
 
     virtual void readQWords(std::vector<unsigned long long>& dataRange, size_t count, size_t pos = 0) const
@@ -466,7 +507,7 @@ private:
         if ( count > m_length / sizeof(unsigned long long) - pos )
             throw DbgException("memory accessor range error");
 
-        dataRange = loadQWords(m_begin + pos* sizeof(unsigned long long), static_cast<unsigned long>(count) );
+        readValues(dataRange, count, pos);
     }
 
     virtual void writeQWords( const std::vector<unsigned long long>&  dataRange, size_t  pos=0)
@@ -474,7 +515,7 @@ private:
         if ( dataRange.size() > m_length / sizeof(unsigned long long) - pos )
             throw DbgException("memory accessor range error");
 
-        kdlib::writeQWords(m_begin + pos * sizeof(unsigned long long), dataRange);
+        writeValues(dataRange, pos);
     }
 
     virtual void readSignBytes(std::vector<char>& dataRange, size_t count, size_t pos = 0) const
@@ -482,7 +523,7 @@ private:
         if ( count > m_length - pos )
             throw DbgException("memory accessor range error");
 
-        dataRange = loadSignBytes(m_begin + pos* sizeof(char), static_cast<unsigned long>(count) );
+        readValues(dataRange, count, pos);
     }
 
     virtual void writeSignBytes( const std::vector<char>&  dataRange, size_t  pos=0)
@@ -490,7 +531,7 @@ private:
         if ( dataRange.size() > m_length  - pos )
             throw DbgException("memory accessor range error");
 
-        kdlib::writeSignBytes(m_begin + pos, dataRange);
+        writeValues(dataRange, pos);
     }
 
     virtual void readSignWords(std::vector<short>& dataRange, size_t count, size_t pos = 0) const
@@ -498,7 +539,7 @@ private:
         if ( count > m_length / sizeof(short) - pos )
             throw DbgException("memory accessor range error");
 
-        dataRange = loadSignWords(m_begin + pos* sizeof(short), static_cast<unsigned long>(count) );
+        readValues(dataRange, count, pos);
     }
 
     virtual void writeSignWords( const std::vector<short>&  dataRange, size_t  pos=0)
@@ -506,7 +547,7 @@ private:
         if ( dataRange.size() > m_length / sizeof(short) - pos )
             throw DbgException("memory accessor range error");
 
-        kdlib::writeSignWords(m_begin + pos * sizeof(short), dataRange);
+        writeValues(dataRange, pos);
     }
 
     virtual void readSignDWords(std::vector<long>& dataRange, size_t count, size_t pos = 0) const
@@ -514,7 +555,7 @@ private:
         if ( count > m_length / sizeof(long) - pos )
             throw DbgException("memory accessor range error");
 
-        dataRange = loadSignDWords(m_begin + pos* sizeof(long), static_cast<unsigned long>(count));
+        readValues(dataRange, count, pos);
     }
 
     virtual void writeSignDWords( const std::vector<long>&  dataRange, size_t  pos=0)
@@ -522,7 +563,7 @@ private:
         if ( dataRange.size() > m_length / sizeof(long) - pos )
             throw DbgException("memory accessor range error");
 
-        kdlib::writeSignDWords(m_begin + pos * sizeof(long), dataRange);
+        writeValues(dataRange, pos);
     }
 
     virtual void readSignQWords(std::vector<long long>& dataRange, size_t count, size_t pos = 0) const
@@ -530,7 +571,7 @@ private:
         if ( count > m_length / sizeof(long long) - pos )
             throw DbgException("memory accessor range error");
 
-        dataRange = loadSignQWords(m_begin + pos* sizeof(long long), static_cast<unsigned long>(count) );
+        readValues(dataRange, count, pos);
     }
 
     virtual void writeSignQWords( const std::vector<long long>&  dataRange, size_t  pos=0)
@@ -538,7 +579,7 @@ private:
         if ( dataRange.size() > m_length / sizeof(long long) - pos )
             throw DbgException("memory accessor range error");
 
-        kdlib::writeSignQWords(m_begin + pos * sizeof(long long), dataRange);
+        writeValues(dataRange, pos);
     }
 
     virtual void readFloats(std::vector<float>& dataRange, size_t count, size_t pos = 0) const
@@ -546,7 +587,7 @@ private:
         if ( count > m_length / sizeof(float) - pos )
             throw DbgException("memory accessor range error");
 
-        dataRange = loadFloats(m_begin + pos* sizeof(float), static_cast<unsigned long>(count));
+        readValues(dataRange, count, pos);
     }
 
     virtual void writeFloats( const std::vector<float>&  dataRange, size_t  pos=0) 
@@ -554,7 +595,7 @@ private:
         if ( dataRange.size() > m_length / sizeof(float) - pos )
             throw DbgException("memory accessor range error");
 
-        kdlib::writeFloats(m_begin + pos * sizeof(float), dataRange);
+        writeValues(dataRange, pos);
     }
 
     virtual void readDoubles(std::vector<double>& dataRange, size_t count, size_t pos = 0) const
@@ -562,7 +603,7 @@ private:
         if ( count > m_length / sizeof(double) || pos > m_length / sizeof(double) - count )
             throw DbgException("memory accessor range error");
 
-        dataRange = loadDoubles(m_begin + pos* sizeof(double), static_cast<unsigned long>(count));
+        readValues(dataRange, count, pos);
     }
 
     virtual void writeDoubles( const std::vector<double>&  dataRange, size_t  pos=0) 
@@ -570,7 +611,7 @@ private:
         if ( dataRange.size() > m_length / sizeof(double) - pos )
             throw DbgException("memory accessor range error");
 
-        kdlib::writeDoubles(m_begin + pos * sizeof(double), dataRange);
+        writeValues(dataRange, pos);
     }
 
     virtual MEMOFFSET_64 getAddress() const {
@@ -589,24 +630,100 @@ private:
         return sstr.str();
     }
 
-    DataAccessorPtr copy( size_t startOffset = 0, size_t length = -1 )
+    DataAccessorPtr copy( size_t startOffset = 0, size_t length = -1 );
+
+private:
+
+    enum CacheState {
+        CacheEmpty,
+        CacheDone,
+        CacheFailed
+    };
+
+    bool readCache(void* dst, size_t length, size_t pos) const
     {
-        if ( length == -1 )
-            length = m_length - startOffset;
+        boost::mutex::scoped_lock  l(m_cacheLock);
 
-        if ( length > 0 && startOffset >= m_length )
-            throw DbgException("memory accessor range error");
+        // the snapshot is taken again after a write or a change of the target state
+        const unsigned long long  generation = getMemoryGeneration();
 
-        if ( m_length - startOffset < length )
-            throw DbgException("memory accessor range error");
+        if ( m_cacheState == CacheEmpty || m_cacheGeneration != generation )
+        {
+            // a window with an invalid part falls back to the direct reads
+            // so an error is reported for the element really accessed
+            std::vector<char>  buffer(m_length);
+            unsigned long  readed = 0;
+
+            if ( readMemoryUnsafe(m_begin, &buffer[0], m_length, false, &readed) && readed == m_length )
+            {
+                m_cache.swap(buffer);
+                m_cacheState = CacheDone;
+            }
+            else
+            {
+                m_cache.clear();
+                m_cacheState = CacheFailed;
+            }
+
+            m_cacheGeneration = generation;
+        }
+
+        if ( m_cacheState != CacheDone )
+            return false;
 
-        return getMemoryAccessor( m_begin + startOffset, length);
+        memcpy(dst, &m_cache[pos], length);
+        return true;
     }
 
-private:
+    template <typename T>
+    T readValue(size_t pos) const
+    {
+        T  value;
+        readRaw(&value, sizeof(T), pos * sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void writeValue(T value, size_t pos)
+    {
+        writeRaw(&value, sizeof(T), pos * sizeof(T));
+    }
+
+    template <typename T>
+    void readValues(std::vector<T>& dataRange, size_t count, size_t pos) const
+    {
+        std::vector<T>  buffer(count);
+
+        if ( count > 0 )
+            readRaw(&buffer[0], count * sizeof(T), pos * sizeof(T));
+
+        dataRange.swap(buffer);
+    }
+
+    template <typename T>
+    void writeValues(const std::vector<T>& dataRange, size_t pos)
+    {
+        if ( dataRange.empty() )
+            return;
+
+        const size_t  offset = pos * sizeof(T);
+        const size_t  length = dataRange.size() * sizeof(T);
+
+        if ( !isVaRegionValid(m_begin + offset, length) )
+            throw MemoryException(m_begin + offset);
+
+        writeRaw(&dataRange[0], length, offset);
+    }
 
     MEMOFFSET_64  m_begin;
     size_t  m_length;
+
+    const bool  m_prefetch;
+
+    mutable boost::mutex  m_cacheLock;
+    mutable CacheState  m_cacheState;
+    mutable unsigned long long  m_cacheGeneration;
+    mutable std::vector<char>  m_cache;
 };
 
 
@@ -636,6 +753,22 @@ private:
         return m_length;
     }
 
+    virtual void readRaw(void* dst, size_t length, size_t pos = 0) const
+    {
+        if ( length > m_length || pos > m_length - length )
+            throw DbgException("data accessor range error");
+
+        m_parentAccessor->readRaw(dst, length, m_pos + pos);
+    }
+
+    virtual void writeRaw(const void* src, size_t length, size_t pos = 0)
+    {
+        if ( length > m_length || pos > m_length - length )
+            throw DbgException("data accessor range error");
+
+        m_parentAccessor->writeRaw(src, length, m_pos + pos);
+    }
+
     virtual unsigned char readByte(size_t pos = 0) const
     {
         return readValue<unsigned char>(pos);
@@ -838,7 +971,7 @@ private:
 
     virtual MEMOFFSET_64 getAddress() const
     {
-        return m_parentAccessor->getAddress();
+        return m_parentAccessor->getAddress() + m_pos;
     }
 
     virtual VarStorage getStorageType() const
@@ -853,6 +986,13 @@ private:
 
     virtual std::wstring getLocationAsStr() const
     {
+        if ( m_parentAccessor->getStorageType() == MemoryVar )
+        {
+            std::wstringstream  sstr;
+            sstr << L"0x" << std::hex << getAddress();
+            return sstr.str();
+        }
+
         return m_parentAccessor->getLocationAsStr();
     }
 
@@ -879,11 +1019,11 @@ private:
         if ( pos >= m_length / sizeof(T) )
             throw DbgException("data accessor range error");
 
-        std::vector<unsigned char>  buffer(sizeof(T));
+        T  value;
 
-        m_parentAccessor->readBytes(buffer, sizeof(T), m_pos + pos * sizeof(T));
+        m_parentAccessor->readRaw(&value, sizeof(T), m_pos + pos * sizeof(T));
 
-        return *reinterpret_cast<T*>(&buffer[0]);
+        return value;
     }
 
     template <typename T>
@@ -892,11 +1032,7 @@ private:
         if ( pos >= m_length / sizeof(T) )
             throw DbgException("data accessor range error");
 
-        std::vector<unsigned char>  buffer(sizeof(T));
-
-        *reinterpret_cast<T*>(&buffer[0]) = value;
-
-        m_parentAccessor->writeBytes(buffer, m_pos + pos * sizeof(T));
+        m_parentAccessor->writeRaw(&value, sizeof(T), m_pos + pos * sizeof(T));
     }
 
     template <typename T>
@@ -905,26 +1041,22 @@ private:
         if ( count > m_length / sizeof(T)  - pos)
             throw DbgException("data accessor range error");
 
-        std::vector<unsigned char>  buffer(sizeof(T)*count);
+        std::vector<T>  buffer(count);
 
-        m_parentAccessor->readBytes(buffer, count, m_pos+pos*sizeof(T));
+        if ( count > 0 )
+            m_parentAccessor->readRaw(&buffer[0], count*sizeof(T), m_pos+pos*sizeof(T));
 
-        dataRange = std::vector<T>(
-            reinterpret_cast<const T*>(&buffer.front()),
-            reinterpret_cast<const T*>(&buffer.front()) + count);
+        dataRange.swap(buffer);
     }
 
     template <typename T>
     void writeValues( const std::vector<T>&  dataRange, size_t pos) 
     {
-        if ( dataRange.size() > m_length / sizeof(double) - pos )
+        if ( dataRange.size() > m_length / sizeof(T) - pos )
             throw DbgException("data accessor range error");
 
-        std::vector<unsigned char> buffer(
-            reinterpret_cast<const unsigned char*>(&dataRange.front()),
-            reinterpret_cast<const unsigned char*>(&dataRange.front() + dataRange.size()) );
-
-        m_parentAccessor->writeBytes(buffer, m_pos+pos*sizeof(T));
+        if ( !dataRange.empty() )
+            m_parentAccessor->writeRaw(&dataRange[0], dataRange.size()*sizeof(T), m_pos+pos*sizeof(T));
     }
 
 
@@ -935,21 +1067,66 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
-class CacheAccessor : public EmptyAccessor, public boost::enable_shared_from_this<CacheAccessor>
+inline DataAccessorPtr MemoryAccessor::copy( size_t startOffset, size_t length )
+{
+    if ( length == -1 )
+        length = m_length - startOffset;
+
+    if ( length > 0 && startOffset >= m_length )
+        throw DbgException("memory accessor range error");
+
+    if ( m_length - startOffset < length )
+        throw DbgException("memory accessor range error");
+
+    // slices of the prefetched window are served from its buffer
+    if ( m_prefetch )
+        return DataAccessorPtr( new CopyAccessor( shared_from_this(), startOffset, length) );
+
+    return getMemoryAccessor( m_begin + startOffset, length);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+class CacheAccessor : public EmptyAccessor
 {
 public:
 
+    typedef boost::shared_ptr< std::vector<char> >  BufferPtr;
+
     CacheAccessor(const std::vector<char>& buffer, const std::wstring& location):
-        m_buffer(buffer),
+        m_buffer(boost::make_shared< std::vector<char> >(buffer)),
+        m_offset(0),
+        m_length(buffer.size()),
         m_location(location.empty() ?  L"cached data" : location)
     {}
     
     CacheAccessor(size_t size, const std::wstring& location):
-        m_buffer(size),
+        m_buffer(boost::make_shared< std::vector<char> >(size)),
+        m_offset(0),
+        m_length(size),
         m_location(location.empty() ?  L"cached data" : location)
     {}
 
-    CacheAccessor(const NumVariant& var, const std::wstring&  location) 
+    CacheAccessor(const BufferPtr& buffer, size_t offset, size_t length, const std::wstring& location):
+        m_buffer(buffer),
+        m_offset(offset),
+        m_length(length),
+        m_location(location.empty() ?  L"cached data" : location)
+    {
+        if ( !m_buffer )
+            throw DbgException("cache accessor has no buffer");
+
+        if ( m_length == -1 && m_offset <= m_buffer->size() )
+            m_length = m_buffer->size() - m_offset;
+
+        if ( m_offset > m_buffer->size() || m_length > m_buffer->size() - m_offset )
+            throw DbgException("cache accessor range error");
+    }
+
+    CacheAccessor(const NumVariant& var, const std::wstring&  location) :
+        m_buffer(boost::make_shared< std::vector<char> >()),
+        m_offset(0),
+        m_length(0)
     {
         m_location = location.empty() ?  L"cached data" : location;
 
@@ -1007,7 +1184,25 @@ private:
 
     virtual size_t getLength() const
     {
-        return m_buffer.size();
+        return m_length;
+    }
+
+    virtual void readRaw(void* dst, size_t length, size_t pos = 0) const
+    {
+        if ( length > m_length || pos > m_length - length )
+            throw DbgException("cache accessor range error");
+
+        if ( length > 0 )
+            memcpy(dst, getData() + pos, length);
+    }
+
+    virtual void writeRaw(const void* src, size_t length, size_t pos = 0)
+    {
+        if ( length > m_length || pos > m_length - length )
+            throw DbgException("cache accessor range error");
+
+        if ( length > 0 )
+            memcpy(getData() + pos, src, length);
     }
 
     virtual unsigned char readByte(size_t pos = 0) const
@@ -1232,58 +1427,82 @@ private:
 
     DataAccessorPtr copy( size_t startOffset = 0, size_t length = -1 )
     {
-        return DataAccessorPtr( new CopyAccessor( shared_from_this(), startOffset, length) );
+        if ( length == -1 )
+            length = m_length - startOffset;
+
+        if ( length > 0 && startOffset >= m_length )
+            throw DbgException("cache accessor range error");
+
+        if ( m_length - startOffset < length )
+            throw DbgException("cache accessor range error");
+
+        // the slice shares the buffer
+        return DataAccessorPtr( new CacheAccessor( m_buffer, m_offset + startOffset, length, m_location) );
     }
 
 private:
 
-    std::vector<char>  m_buffer;
+    BufferPtr  m_buffer;
+    size_t  m_offset;
+    size_t  m_length;
 
     std::wstring  m_location;
 
+    char* getData() const
+    {
+        return m_buffer->empty() ? 0 : &m_buffer->front() + m_offset;
+    }
+
     template <typename T>
     T getValue(size_t pos) const
     {
-        if ( pos >= m_buffer.size() / sizeof(T) )
+        if ( pos >= m_length / sizeof(T) )
             throw DbgException("cache accessor range error");
 
-        return *reinterpret_cast<const T*>( &m_buffer[pos*sizeof(T)] );
+        T  value;
+        memcpy( &value, getData() + pos*sizeof(T), sizeof(T) );
+        return value;
     }
 
     template <typename T>
     void setValue(T value, size_t pos)
     {
-        if ( pos >= m_buffer.size() / sizeof(T) )
+        if ( pos >= m_length / sizeof(T) )
             throw DbgException("cache accessor range error");
 
-        *reinterpret_cast<T*>( &m_buffer[pos*sizeof(T)] ) = value;
+        memcpy( getData() + pos*sizeof(T), &value, sizeof(T) );
     }
 
     template <typename T>
     void resetValue(T value)
     {
-        m_buffer.resize(sizeof(T));
-        *reinterpret_cast<T*>( &m_buffer[0] ) = value;
+        m_buffer->resize(sizeof(T));
+        m_length = sizeof(T);
+        memcpy( getData(), &value, sizeof(T) );
     }
 
     template <typename T>
     void readValues(std::vector<T>& dataRange, size_t count, size_t pos) const
     {
-        if ( count > m_buffer.size() / sizeof(T)  - pos)
+        if ( count > m_length / sizeof(T) || pos > m_length / sizeof(T) - count )
             throw DbgException("cache accessor range error");
 
-        dataRange = std::vector<T>(
-            reinterpret_cast<const T*>(&m_buffer[pos*sizeof(T)]), 
-            reinterpret_cast<const T*>(&m_buffer[pos*sizeof(T)]) + count );
+        std::vector<T>  buffer(count);
+
+        if ( count > 0 )
+            memcpy( &buffer[0], getData() + pos*sizeof(T), count*sizeof(T) );
+
+        dataRange.swap(buffer);
     }
 
     template <typename T>
     void writeValues( const std::vector<T>&  dataRange, size_t pos) 
     {
-        if ( dataRange.size() > m_buffer.size() / sizeof(T) - pos )
+        if ( dataRange.size() > m_length / sizeof(T) || pos > m_length / sizeof(T) - dataRange.size() )
             throw DbgException("cache accessor range error");
 
-        memcpy( &m_buffer[pos*sizeof(T)], &dataRange[0], dataRange.size()*sizeof(T) );
+        if ( !dataRange.empty() )
+            memcpy( getData() + pos*sizeof(T), &dataRange[0], dataRange.size()*sizeof(T) );
     }
 };
 
@@ -1314,6 +1533,34 @@ public:
         return kdlib::getRegisterSize(m_regIndex);
     }
 
+    virtual void readRaw(void* dst, size_t length, size_t pos = 0) const
+    {
+        size_t  regSize = kdlib::getRegisterSize(m_regIndex);
+        if ( length > regSize || pos > regSize - length )
+            throw DbgException("register accessor range error");
+
+        std::vector<char>  regValue(regSize);
+        kdlib::getRegisterValue(m_regIndex, &regValue[0], regSize);
+
+        if ( length > 0 )
+            memcpy(dst, &regValue[pos], length);
+    }
+
+    virtual void writeRaw(const void* src, size_t length, size_t pos = 0)
+    {
+        size_t  regSize = kdlib::getRegisterSize(m_regIndex);
+        if ( length > regSize || pos > regSize - length )
+            throw DbgException("register accessor range error");
+
+        std::vector<char>  regValue(regSize);
+        kdlib::getRegisterValue(m_regIndex, &regValue[0], regSize);
+
+        if ( length > 0 )
+            memcpy(&regValue[pos], src, length);
+
+        kdlib::setRegisterValue(m_regIndex, &regValue[0], regSize);
+    }
+
     virtual unsigned char readByte(size_t pos = 0) const
     {
         return getValue<unsigned char>(pos);
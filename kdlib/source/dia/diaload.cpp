@@ -549,6 +549,11 @@ public:
     {
         NOT_IMPLEMENTED();
     }
+
+    unsigned long getIndexId() override
+    {
+        NOT_IMPLEMENTED();
+    }
 };
 
 
@@ -834,6 +834,13 @@ SymbolPtr DiaSymbol::getLexicalParent()
 
 //////////////////////////////////////////////////////////////////////////////
 
+unsigned long DiaSymbol::getIndexId()
+{
+    return callSymbol(get_symIndexId);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 std::wstring DiaSession::getScopeName( IDiaSession* session, IDiaSymbol *globalScope )
 {
   std::wstring scopeName;
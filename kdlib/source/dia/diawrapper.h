@@ -154,6 +154,8 @@ public:
 
     SymbolPtr getLexicalParent() override;
 
+    unsigned long getIndexId() override;
+
 public:
     typedef std::pair<ULONG, const wchar_t *> ValueNameEntry;
     static const ValueNameEntry basicTypeName[];
@@ -4,58 +4,28 @@
 #include <comutil.h>
 #include <DbgHelp.h>
 
+#include <map>
+#include <tuple>
+
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/tag.hpp>
 
-#include <boost/algorithm/string/replace.hpp>
-#include <boost/regex.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
 
 #include "kdlib/symengine.h"
 #include "kdlib/exceptions.h"
 #include "kdlib/memaccess.h"
 
+#include "fnmatch.h"
+
 namespace bmi = boost::multi_index;
 
 ///////////////////////////////////////////////////////////////////////////////
 
-namespace {
-
-    
-    void escapeRegex(std::wstring &regex)
-    {
-        boost::replace_all(regex, L"\\", L"\\\\");
-        boost::replace_all(regex, L"^", L"\\^");
-        boost::replace_all(regex, L".", L"\\.");
-        boost::replace_all(regex, L"$", L"\\$");
-        boost::replace_all(regex, L"|", L"\\|");
-        boost::replace_all(regex, L"(", L"\\(");
-        boost::replace_all(regex, L")", L"\\)");
-        boost::replace_all(regex, L"[", L"\\[");
-        boost::replace_all(regex, L"]", L"\\]");
-        boost::replace_all(regex, L"*", L"\\*");
-        boost::replace_all(regex, L"+", L"\\+");
-        boost::replace_all(regex, L"?", L"\\?");
-        boost::replace_all(regex, L"/", L"\\/");
-    }
-
-    bool fnmatch(const std::wstring&  str, const std::wstring& match)
-    {
-        std::wstring  reStr = match;
-        escapeRegex(reStr);
-
-        boost::replace_all(reStr, L"\\?", L".");
-        boost::replace_all(reStr, L"\\*", L".*");
-
-        boost::wregex pattern(reStr, boost::regex::normal);
-
-        return boost::regex_match(str, pattern);
-    }
-}
-
-
 namespace kdlib {
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -272,6 +242,11 @@ class ExportSymbolBase : public Symbol
     {
         NOT_IMPLEMENTED();
     }
+
+    unsigned long getIndexId() override
+    {
+        NOT_IMPLEMENTED();
+    }
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -382,18 +357,25 @@ public:
         return m_storage.size();
     }
 
-    bool findByIndex(const size_t index, FunctionName& name, FunctionAddress& funcAddress) const
+    // calls "callback(name, address)" for the names matched by the mask
+    // ( "?" and "*" wildcards ) in the name order. Only the names with the
+    // literal prefix of the mask are checked
+    template<typename Callback>
+    void enumerate(const std::wstring& mask, Callback callback) const
     {
-        if (index >= size())
-            return false;
-
-        NameIndex::const_iterator it = GetNameIndex().begin();
-        std::advance(it, index);
+        const std::wstring  prefix = mask.substr(0, mask.find_first_of(L"?*"));
+        const bool  matchAll = mask.empty() || mask == L"*";
+        const bool  literal = prefix.size() == mask.size();
+        const GlobPattern  pattern(mask);
 
-        name = (*it).Name;
-        funcAddress = (*it).Address;
+        const NameOrderIndex&  index = GetNameOrderIndex();
 
-        return true;
+        for (NameOrderIndex::const_iterator it = index.lower_bound(prefix);
+             it != index.end() && (*it).Name.compare(0, prefix.size(), prefix) == 0; ++it)
+        {
+            if (matchAll || (literal ? (*it).Name == mask : pattern.match((*it).Name)))
+                callback((*it).Name, (*it).Address);
+        }
     }
 
 private:
@@ -410,6 +392,7 @@ private:
 
     struct ByAddress {};
     struct ByName {};
+    struct ByNameOrder {};
 
     typedef bmi::multi_index_container<
         Entry,
@@ -421,12 +404,17 @@ private:
             bmi::hashed_unique<
                 bmi::tag<ByName>,
                 bmi::member<Entry, FunctionName, &Entry::Name>
+            >,
+            bmi::ordered_unique<
+                bmi::tag<ByNameOrder>,
+                bmi::member<Entry, FunctionName, &Entry::Name>
             >
         >
     > Container;
 
     typedef Container::index<ByAddress>::type AddressIndex;
     typedef Container::index<ByName>::type NameIndex;
+    typedef Container::index<ByNameOrder>::type NameOrderIndex;
 
 private:
     const AddressIndex& GetAddressIndex() const
@@ -449,12 +437,192 @@ private:
         return m_storage.get<ByName>();
     }
 
+    const NameOrderIndex& GetNameOrderIndex() const
+    {
+        return m_storage.get<ByNameOrder>();
+    }
+
 private:
     Container m_storage;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
+typedef boost::shared_ptr<const FunctionMap>  FunctionMapPtr;
+
+// Export maps are shared by all sessions of the same image, it is
+// identified by the export directory name, timestamps and checksum
+class FunctionMapCache
+{
+public:
+
+    static const size_t  maxImages = 0x100;
+
+    struct Key
+    {
+        std::string  name;
+        ULONG  timeDateStamp;
+        ULONG  exportTimeDateStamp;
+        ULONG  checkSum;
+        ULONG  sizeOfImage;
+        USHORT  machineType;
+
+        bool operator<(const Key& key) const
+        {
+            return std::tie(name, timeDateStamp, exportTimeDateStamp, checkSum, sizeOfImage, machineType) <
+                std::tie(key.name, key.timeDateStamp, key.exportTimeDateStamp, key.checkSum, key.sizeOfImage, key.machineType);
+        }
+    };
+
+    FunctionMapPtr find(const Key& key)
+    {
+        boost::lock_guard<boost::mutex>  lock(m_lock);
+
+        std::map<Key, FunctionMapPtr>::const_iterator  it = m_maps.find(key);
+        return it != m_maps.end() ? it->second : FunctionMapPtr();
+    }
+
+    void insert(const Key& key, const FunctionMapPtr& functionMap)
+    {
+        boost::lock_guard<boost::mutex>  lock(m_lock);
+
+        if (m_maps.size() >= maxImages)
+            m_maps.clear();
+
+        m_maps[key] = functionMap;
+    }
+
+private:
+
+    boost::mutex  m_lock;
+    std::map<Key, FunctionMapPtr>  m_maps;
+};
+
+namespace {
+    FunctionMapCache  g_functionMapCache;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// UnDecorateSymbolName is not thread safe, the calls are serialized and
+// the results are kept. Only C++ names ( "?..." ) are decorated
+class UndecoratedNameCache
+{
+public:
+
+    static const size_t  maxNames = 0x10000;
+
+    std::wstring undecorate(const std::string& name)
+    {
+        if (name.empty() || name[0] != '?')
+            return std::wstring(_bstr_t(name.c_str()));
+
+        boost::lock_guard<boost::mutex>  lock(m_lock);
+
+        std::map<std::string, std::wstring>::const_iterator  it = m_names.find(name);
+        if (it != m_names.end())
+            return it->second;
+
+        std::string  undecoratedName = name;
+
+        DWORD  undecorLength = UnDecorateSymbolName(name.c_str(), m_buffer, sizeof(m_buffer), UNDNAME_NAME_ONLY);
+        if (undecorLength > 0)
+            undecoratedName = std::string(m_buffer, undecorLength);
+
+        if (m_names.size() >= maxNames)
+            m_names.clear();
+
+        return m_names[name] = std::wstring(_bstr_t(undecoratedName.c_str()));
+    }
+
+private:
+
+    boost::mutex  m_lock;
+    std::map<std::string, std::wstring>  m_names;
+    char  m_buffer[1000];
+};
+
+namespace {
+    UndecoratedNameCache  g_undecoratedNames;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Image range read with one request; the export tables and names are
+// usually inside the export data directory, anything else is read apart
+class ExportImage
+{
+public:
+
+    ExportImage(ULONG64 moduleBase, ULONG imageSize, ULONG rva, ULONG size) :
+        m_moduleBase(moduleBase),
+        m_imageSize(imageSize),
+        m_rva(rva)
+    {
+        if (!isInImage(rva, size))
+            throw SymbolException(L"invalid export directory");
+
+        m_data.resize(size);
+
+        if (size > 0)
+            readMemory(moduleBase + rva, &m_data[0], size);
+    }
+
+    void read(ULONG rva, void* buffer, size_t length) const
+    {
+        if (contains(rva, length))
+            memcpy(buffer, &m_data[rva - m_rva], length);
+        else
+            readMemory(m_moduleBase + rva, buffer, length);
+    }
+
+    template<typename T>
+    void readTable(ULONG rva, ULONG count, std::vector<T>& table) const
+    {
+        // a broken or hostile count must not turn into a huge allocation
+        if (count > m_imageSize / sizeof(T) || !isInImage(rva, count * sizeof(T)))
+            throw SymbolException(L"invalid export table");
+
+        table.resize(count);
+
+        if (count > 0)
+            read(rva, &table[0], count * sizeof(T));
+    }
+
+    std::string readString(ULONG rva) const
+    {
+        if (contains(rva, 1))
+        {
+            const char*  begin = &m_data[rva - m_rva];
+            const char*  end = static_cast<const char*>(memchr(begin, 0, m_data.size() - (rva - m_rva)));
+
+            if (end)
+                return std::string(begin, end);
+        }
+
+        return loadCStr(m_moduleBase + rva);
+    }
+
+private:
+
+    bool contains(ULONG rva, size_t length) const
+    {
+        return rva >= m_rva && rva - m_rva <= m_data.size() && length <= m_data.size() - (rva - m_rva);
+    }
+
+    bool isInImage(ULONG rva, size_t length) const
+    {
+        return rva <= m_imageSize && length <= m_imageSize - rva;
+    }
+
+    ULONG64  m_moduleBase;
+    ULONG  m_imageSize;
+    ULONG  m_rva;
+    std::vector<char>  m_data;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 class ExportSymbolDir;
 typedef boost::shared_ptr<ExportSymbolDir> ExportSymbolDirPtr;
 
@@ -473,7 +641,7 @@ public:
         ULONG address;
         LONG offset;
 
-        if ( !m_exportMap.findByAddress( rva, name, address, offset ) )
+        if ( !m_exportMap->findByAddress( rva, name, address, offset ) )
             throw SymbolException( L"symbol can not be found by rva");
 
         if ( displacement )
@@ -499,7 +667,7 @@ public:
     {
         FunctionMap::FunctionAddress addr;
 
-        if (!m_exportMap.findByName(name, addr))
+        if (!m_exportMap->findByName(name, addr))
             throw SymbolException(name + L" symbol is not found");
 
         return SymbolPtr(new ExportSymbol(name, addr, m_moduleBase, getMachineType()));
@@ -511,15 +679,11 @@ public:
 
         if (symTag == SymTagPublicSymbol)
         {
-            for (size_t i = 0; i < m_exportMap.size(); ++i)
-            {
-                std::wstring funcName;
-                ULONG address;
-                m_exportMap.findByIndex(i, funcName, address);
-
-                if (mask.empty() || mask == L"*" || fnmatch(funcName, mask) )
-                    symLst.push_back(SymbolPtr(new ExportSymbol(funcName, address, m_moduleBase, getMachineType())));
-            }
+            const MachineTypes  machineType = getMachineType();
+
+            m_exportMap->enumerate(mask, [&](const std::wstring& funcName, ULONG address) {
+                symLst.push_back(SymbolPtr(new ExportSymbol(funcName, address, m_moduleBase, machineType)));
+            });
         }
 
         return symLst;
@@ -531,24 +695,24 @@ private:
     {
         ULONG64  ntHeaderOffset = moduleBase + ptrDWord( moduleBase + 0x3c );
 
-        IMAGE_NT_HEADERS  ntHeaders;
-        readMemory( ntHeaderOffset, &ntHeaders, sizeof(ntHeaders) );
+        IMAGE_FILE_HEADER  fileHeader;
+        readMemory( ntHeaderOffset + FIELD_OFFSET(IMAGE_NT_HEADERS, FileHeader), &fileHeader, sizeof(fileHeader) );
 
-        m_machineType = ntHeaders.FileHeader.Machine;
+        m_machineType = fileHeader.Machine;
 
         m_moduleBase = moduleBase;
 
         if ( m_machineType == IMAGE_FILE_MACHINE_I386 ||
              m_machineType == IMAGE_FILE_MACHINE_ARMNT )
         {
-            GetExport<IMAGE_NT_HEADERS32>( moduleBase );
+            m_exportMap = GetExport<IMAGE_NT_HEADERS32>( moduleBase, ntHeaderOffset );
             return;
         }
         
         if ( m_machineType == IMAGE_FILE_MACHINE_AMD64 ||
              m_machineType == IMAGE_FILE_MACHINE_ARM64 )
         {
-            GetExport<IMAGE_NT_HEADERS64>( moduleBase );
+            m_exportMap = GetExport<IMAGE_NT_HEADERS64>( moduleBase, ntHeaderOffset );
             return;
         }
 
@@ -556,41 +720,68 @@ private:
     }
 
     template<typename NTHEADERT>
-    void  GetExport( ULONG64 moduleBase )
+    FunctionMapPtr  GetExport( ULONG64 moduleBase, ULONG64 ntHeaderOffset )
     {
-        ULONG64  ntHeaderOffset = moduleBase + ptrDWord( moduleBase + 0x3c );
-
         NTHEADERT  ntHeader;
         readMemory( ntHeaderOffset, &ntHeader, sizeof(ntHeader) );
-    
-        if ( ntHeader.OptionalHeader.DataDirectory[0].Size == 0 )
-            return;
 
-        ULONG64  exportDirOffset = moduleBase + ntHeader.OptionalHeader.DataDirectory[0].VirtualAddress;
+        const IMAGE_DATA_DIRECTORY&  exportData = ntHeader.OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
+
+        if ( exportData.Size < sizeof(IMAGE_EXPORT_DIRECTORY) )
+            return FunctionMapPtr( new FunctionMap() );
+
+        // the directory, its tables and names are read with one request
+        ExportImage  exportImage( moduleBase, ntHeader.OptionalHeader.SizeOfImage, exportData.VirtualAddress, exportData.Size );
+
+        IMAGE_EXPORT_DIRECTORY  exportDir;
+        exportImage.read( exportData.VirtualAddress, &exportDir, sizeof(exportDir) );
+
+        FunctionMapCache::Key  key;
+        key.name = exportDir.Name != 0 ? exportImage.readString( exportDir.Name ) : std::string();
+        key.timeDateStamp = ntHeader.FileHeader.TimeDateStamp;
+        key.exportTimeDateStamp = exportDir.TimeDateStamp;
+        key.checkSum = ntHeader.OptionalHeader.CheckSum;
+        key.sizeOfImage = ntHeader.OptionalHeader.SizeOfImage;
+        key.machineType = ntHeader.FileHeader.Machine;
 
-        ULONG  namesCount = (ULONG) ptrDWord( exportDirOffset + 0x18 );
-        ULONG64  funcRvaOffset = moduleBase + ptrDWord( exportDirOffset + 0x1C );
-        ULONG64  namesOffset = moduleBase + ptrDWord( exportDirOffset + 0x20 ); 
-        ULONG64  ordinalsOffset = moduleBase + ptrDWord( exportDirOffset + 0x24 );
+        // without a timestamp and a checksum different builds can not be told apart
+        bool  cacheable = key.timeDateStamp != 0 || key.checkSum != 0;
 
-        for ( ULONG i = 0; i < namesCount; ++i ) 
+        if ( cacheable )
         {
-            std::string  exportName = loadCStr( moduleBase + ptrDWord( namesOffset + 4 * i ) );
-            USHORT  exportOrdinal = (USHORT)ptrWord( ordinalsOffset + 2 * i );
-            ULONG rva = (ULONG)ptrDWord( funcRvaOffset + 4 * exportOrdinal );
+            FunctionMapPtr  cachedMap = g_functionMapCache.find( key );
+            if ( cachedMap )
+                return cachedMap;
+        }
+
+        std::vector<ULONG>  names;
+        exportImage.readTable( exportDir.AddressOfNames, exportDir.NumberOfNames, names );
+
+        std::vector<USHORT>  ordinals;
+        exportImage.readTable( exportDir.AddressOfNameOrdinals, exportDir.NumberOfNames, ordinals );
+
+        std::vector<ULONG>  functions;
+        exportImage.readTable( exportDir.AddressOfFunctions, exportDir.NumberOfFunctions, functions );
 
-            std::vector<char> undecorBuffer(1000);
-            DWORD  undecorLength = UnDecorateSymbolName(exportName.c_str(), &undecorBuffer[0], (DWORD)undecorBuffer.size(), UNDNAME_NAME_ONLY);
-            if (undecorLength > 0)
-                exportName = std::string(&undecorBuffer[0], undecorLength);
+        boost::shared_ptr<FunctionMap>  exportMap( new FunctionMap() );
 
-            std::wstring wideExportNamr = _bstr_t( exportName.c_str() );
+        for ( ULONG i = 0; i < names.size(); ++i ) 
+        {
+            if ( ordinals[i] >= functions.size() )
+                continue;
+
+            std::wstring  exportName = g_undecoratedNames.undecorate( exportImage.readString( names[i] ) );
 
-            m_exportMap.add( wideExportNamr, rva );
+            exportMap->add( exportName, functions[ ordinals[i] ] );
         }
+
+        if ( cacheable )
+            g_functionMapCache.insert( key, exportMap );
+
+        return exportMap;
     }
 
-    FunctionMap m_exportMap;
+    FunctionMapPtr  m_exportMap;
 
     ULONG  m_machineType;
 
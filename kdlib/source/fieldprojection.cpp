@@ -0,0 +1,348 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "kdlib/typeinfo.h"
+#include "kdlib/memaccess.h"
+#include "kdlib/exceptions.h"
+
+#include "typeinfoimp.h"
+
+namespace kdlib {
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+
+class FieldProjectionImpl : public FieldProjection
+{
+public:
+
+    FieldProjectionImpl( const TypeInfoPtr& typeInfo, const std::vector<std::wstring>& fieldPaths );
+
+    size_t getFieldCount() override
+    {
+        return m_fields.size();
+    }
+
+    TypeInfoPtr getFieldType( size_t index ) override
+    {
+        if ( index >= m_fields.size() )
+            throw IndexException( index );
+
+        return m_fields[index].typeInfo;
+    }
+
+    std::vector<NumVariantColumn> apply( const std::vector<MEMOFFSET_64>& addresses ) override;
+
+private:
+
+    enum ValueKind {
+        SignByteValue,
+        ByteValue,
+        SignWordValue,
+        WordValue,
+        SignDWordValue,
+        DWordValue,
+        SignQWordValue,
+        QWordValue,
+        FloatValue,
+        DoubleValue,
+        BoolValue,
+        PtrValue
+    };
+
+    struct Field {
+        TypeInfoPtr  typeInfo;
+        size_t  offset;  // from the start of the object window
+        size_t  width;
+        ValueKind  kind;
+        BITOFFSET  bitOffset;
+        BITOFFSET  bitWidth;  // zero for not bit fields
+    };
+
+    static ValueKind getValueKind( const TypeInfoPtr& typeInfo, size_t& width );
+
+    static NumVariant makeValue( ValueKind kind, unsigned long long value );
+
+    static NumVariant readValue( const Field& field, const char* data );
+
+    std::vector<Field>  m_fields;
+
+    // the smallest range covering all fields
+    MEMOFFSET_REL  m_windowOffset;
+    size_t  m_windowSize;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+FieldProjectionImpl::FieldProjectionImpl( const TypeInfoPtr& typeInfo, const std::vector<std::wstring>& fieldPaths ) :
+    m_windowOffset( 0 ),
+    m_windowSize( 0 )
+{
+    std::vector<MEMOFFSET_REL>  offsets;
+
+    for ( const std::wstring& fieldPath : fieldPaths )
+    {
+        Field  field;
+
+        field.typeInfo = typeInfo->getElement( fieldPath );
+        field.bitOffset = 0;
+        field.bitWidth = 0;
+
+        TypeInfoPtr  valueType = field.typeInfo;
+
+        if ( valueType->isBitField() )
+        {
+            field.bitOffset = valueType->getBitOffset();
+            field.bitWidth = valueType->getBitWidth();
+            valueType = valueType->getBitType();
+        }
+
+        field.kind = getValueKind( valueType, field.width );
+
+        if ( field.bitWidth != 0 && ( field.kind == FloatValue || field.kind == DoubleValue || field.kind == PtrValue ) )
+            throw TypeException( fieldPath, L" unsupported bit field type" );
+
+        offsets.push_back( typeInfo->getElementOffset( fieldPath ) );
+        m_fields.push_back( field );
+    }
+
+    if ( m_fields.empty() )
+        return;
+
+    m_windowOffset = *std::min_element( offsets.begin(), offsets.end() );
+
+    for ( size_t i = 0; i < m_fields.size(); ++i )
+    {
+        m_fields[i].offset = static_cast<size_t>( offsets[i] - m_windowOffset );
+        m_windowSize = (std::max)( m_windowSize, m_fields[i].offset + m_fields[i].width );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+FieldProjectionImpl::ValueKind FieldProjectionImpl::getValueKind( const TypeInfoPtr& typeInfo, size_t& width )
+{
+    if ( typeInfo->isPointer() )
+    {
+        width = typeInfo->getPtrSize();
+        return PtrValue;
+    }
+
+    if ( typeInfo->isEnum() )
+    {
+        // projected as TypedVar::getValue reads an enum: the first four
+        // bytes as an unsigned value
+        if ( typeInfo->getSize() < 4 )
+            throw TypeException( typeInfo->getName(), L" unsupported enum size" );
+
+        width = 4;
+        return DWordValue;
+    }
+
+    if ( !typeInfo->isBase() )
+        throw TypeException( typeInfo->getName(), L" is not a scalar type" );
+
+    switch ( getBaseTypeKind( typeInfo ) )
+    {
+    case BaseTypeChar:
+    case BaseTypeInt1B:
+        width = 1;
+        return SignByteValue;
+
+    case BaseTypeUInt1B:
+        width = 1;
+        return ByteValue;
+
+    case BaseTypeWChar:
+    case BaseTypeInt2B:
+        width = 2;
+        return SignWordValue;
+
+    case BaseTypeUInt2B:
+        width = 2;
+        return WordValue;
+
+    case BaseTypeLong:
+    case BaseTypeInt4B:
+        width = 4;
+        return SignDWordValue;
+
+    case BaseTypeULong:
+    case BaseTypeUInt4B:
+    case BaseTypeHresult:
+        width = 4;
+        return DWordValue;
+
+    case BaseTypeInt8B:
+        width = 8;
+        return SignQWordValue;
+
+    case BaseTypeUInt8B:
+        width = 8;
+        return QWordValue;
+
+    case BaseTypeFloat:
+        width = 4;
+        return FloatValue;
+
+    case BaseTypeDouble:
+        width = 8;
+        return DoubleValue;
+
+    case BaseTypeBool:
+        width = 1;
+        return BoolValue;
+    }
+
+    throw TypeException( typeInfo->getName(), L" unsupported based type" );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+NumVariant FieldProjectionImpl::makeValue( ValueKind kind, unsigned long long value )
+{
+    switch ( kind )
+    {
+    case SignByteValue:
+        return NumVariant( static_cast<char>(value) );
+
+    case ByteValue:
+        return NumVariant( static_cast<unsigned char>(value) );
+
+    case SignWordValue:
+        return NumVariant( static_cast<short>(value) );
+
+    case WordValue:
+        return NumVariant( static_cast<unsigned short>(value) );
+
+    case SignDWordValue:
+        return NumVariant( static_cast<long>(value) );
+
+    case DWordValue:
+        return NumVariant( static_cast<unsigned long>(value) );
+
+    case SignQWordValue:
+        return NumVariant( static_cast<long long>(value) );
+
+    case QWordValue:
+        return NumVariant( value );
+
+    case BoolValue:
+        return NumVariant( 0 != value );
+
+    default:
+        break;
+    }
+
+    throw DbgException( "unexpected value kind" );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+NumVariant FieldProjectionImpl::readValue( const Field& field, const char* data )
+{
+    data += field.offset;
+
+    switch ( field.kind )
+    {
+    case FloatValue:
+        {
+            float  value;
+            std::memcpy( &value, data, sizeof(value) );
+            return NumVariant( value );
+        }
+
+    case DoubleValue:
+        {
+            double  value;
+            std::memcpy( &value, data, sizeof(value) );
+            return NumVariant( value );
+        }
+
+    case PtrValue:
+        {
+            if ( field.width == 4 )
+            {
+                unsigned long  value;
+                std::memcpy( &value, data, sizeof(value) );
+                return NumVariant( addr64(value) );
+            }
+
+            unsigned long long  value;
+            std::memcpy( &value, data, sizeof(value) );
+            return NumVariant( addr64(value) );
+        }
+
+    default:
+        break;
+    }
+
+    unsigned long long  value = 0;
+    std::memcpy( &value, data, field.width );
+
+    if ( field.bitWidth != 0 )
+    {
+        value >>= field.bitOffset;
+
+        if ( field.bitWidth < 64 )
+        {
+            unsigned long long  mask = ( 1ULL << field.bitWidth ) - 1;
+
+            bool  isSigned = field.kind == SignByteValue || field.kind == SignWordValue ||
+                field.kind == SignDWordValue || field.kind == SignQWordValue;
+
+            if ( isSigned && ( value & ( 1ULL << ( field.bitWidth - 1 ) ) ) != 0 )
+                value |= ~mask;
+            else
+                value &= mask;
+        }
+    }
+
+    return makeValue( field.kind, value );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::vector<NumVariantColumn> FieldProjectionImpl::apply( const std::vector<MEMOFFSET_64>& addresses )
+{
+    std::vector<NumVariantColumn>  columns( m_fields.size() );
+
+    for ( NumVariantColumn& column : columns )
+        column.reserve( addresses.size() );
+
+    if ( m_fields.empty() )
+        return columns;
+
+    std::vector<char>  window( m_windowSize );
+
+    for ( MEMOFFSET_64 address : addresses )
+    {
+        readMemory( addr64(address) + m_windowOffset, &window[0], m_windowSize );
+
+        for ( size_t i = 0; i < m_fields.size(); ++i )
+            columns[i].push_back( readValue( m_fields[i], &window[0] ) );
+    }
+
+    return columns;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+FieldProjectionPtr projectFields( const TypeInfoPtr& typeInfo, const std::vector<std::wstring>& fieldPaths )
+{
+    if ( !typeInfo )
+        throw DbgException( "type info is null" );
+
+    return FieldProjectionPtr( new FieldProjectionImpl( typeInfo, fieldPaths ) );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
@@ -1,43 +1,70 @@
 #include "stdafx.h"
 
-#include <boost/regex.hpp>
+#include <unordered_map>
 
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+#include "fnmatch.h"
 
 /////////////////////////////////////////////////////////////////////////////////
 
 namespace kdlib {
 
+namespace {
+
+template<typename CharT>
+class GlobPatternCache
+{
+public:
+
+    typedef BasicGlobPattern<CharT>  PatternT;
+    typedef boost::shared_ptr<const PatternT>  PatternPtr;
+
+    static const size_t  maxPatterns = 64;
+
+    PatternPtr get( const std::basic_string<CharT>& pattern )
+    {
+        boost::lock_guard<boost::mutex>  lock(m_lock);
+
+        typename PatternMap::const_iterator  it = m_patterns.find(pattern);
+        if ( it != m_patterns.end() )
+            return it->second;
+
+        if ( m_patterns.size() >= maxPatterns )
+            m_patterns.clear();
+
+        PatternPtr  compiled( new PatternT(pattern) );
+        m_patterns.insert( std::make_pair(pattern, compiled) );
+        return compiled;
+    }
 
-const boost::regex  r1("\\?");
-const boost::regex  r2("\\*");
-const boost::regex  r3("\\.");
+private:
+
+    typedef std::unordered_map< std::basic_string<CharT>, PatternPtr >  PatternMap;
+
+    boost::mutex  m_lock;
+    PatternMap  m_patterns;
+};
+
+GlobPatternCache<char>  g_patternCache;
+GlobPatternCache<wchar_t>  g_widePatternCache;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////////
 
 bool fnmatch( const std::string& pattern, const std::string& str)
 {
-    std::string mask = pattern;
-    mask = boost::regex_replace(mask, r1, ".");
-    mask = boost::regex_replace(mask, r2, ".*");
-    mask = boost::regex_replace(mask, r3, "\\.");
-
-    boost::smatch  matchResult;
-    boost::regex  regEx(mask);
-    return boost::regex_match(str, matchResult, regEx);
+    return g_patternCache.get(pattern)->match(str);
 }
 
-const boost::wregex  wr1(L"\\?");
-const boost::wregex  wr2(L"\\*");
-const boost::wregex  wr3(L"\\.");
+/////////////////////////////////////////////////////////////////////////////////
 
 bool fnmatch( const std::wstring& pattern, const std::wstring& str)
 {
-    std::wstring mask = pattern;
-    mask = boost::regex_replace(mask, wr1, L".");
-    mask = boost::regex_replace(mask, wr2, L".*");
-    mask = boost::regex_replace(mask, wr3, L"\\.");
-
-    boost::wsmatch  matchResult;
-    boost::wregex  regEx(mask);
-    return boost::regex_match(str, matchResult, regEx);
+    return g_widePatternCache.get(pattern)->match(str);
 }
 
 }
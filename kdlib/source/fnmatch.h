@@ -1,11 +1,138 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 namespace kdlib {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Shell style mask: "?" matches any character, "*" matches any sequence,
+// all other characters match themselves. The mask is split into the
+// literal segments between the stars once, the matching does not backtrack:
+// the first segment is checked at the start, the last one at the end and
+// the middle ones are searched in order
+template<typename CharT>
+class BasicGlobPattern
+{
+public:
+
+    typedef std::basic_string<CharT>  StringT;
+
+    explicit BasicGlobPattern( const StringT& pattern = StringT() ) :
+        m_pattern(pattern),
+        m_hasStar(false),
+        m_hasQuestion(false)
+    {
+        size_t  begin = 0;
+
+        while ( true )
+        {
+            size_t  star = pattern.find( CharT('*'), begin );
+
+            m_segments.push_back( pattern.substr( begin, star == StringT::npos ? StringT::npos : star - begin ) );
+
+            if ( star == StringT::npos )
+                break;
+
+            m_hasStar = true;
+            begin = star + 1;
+        }
+
+        m_hasQuestion = pattern.find( CharT('?') ) != StringT::npos;
+    }
+
+    const StringT& getPattern() const {
+        return m_pattern;
+    }
+
+    bool empty() const {
+        return m_pattern.empty();
+    }
+
+    bool match( const StringT& str ) const
+    {
+        if ( !m_hasStar )
+            return str.size() == m_pattern.size() && matchAt( str, 0, m_pattern );
+
+        const StringT&  prefix = m_segments.front();
+        const StringT&  suffix = m_segments.back();
+
+        if ( str.size() < prefix.size() + suffix.size() )
+            return false;
+
+        if ( !matchAt( str, 0, prefix ) || !matchAt( str, str.size() - suffix.size(), suffix ) )
+            return false;
+
+        size_t  pos = prefix.size();
+        const size_t  end = str.size() - suffix.size();
+
+        for ( size_t i = 1; i + 1 < m_segments.size(); ++i )
+        {
+            const StringT&  segment = m_segments[i];
+
+            if ( segment.empty() )
+                continue;
+
+            pos = find( str, pos, end, segment );
+            if ( pos == StringT::npos )
+                return false;
+
+            pos += segment.size();
+        }
+
+        return true;
+    }
+
+private:
+
+    bool matchAt( const StringT& str, size_t pos, const StringT& segment ) const
+    {
+        if ( !m_hasQuestion )
+            return str.compare( pos, segment.size(), segment ) == 0;
+
+        for ( size_t i = 0; i < segment.size(); ++i )
+        {
+            if ( segment[i] != CharT('?') && segment[i] != str[pos + i] )
+                return false;
+        }
+
+        return true;
+    }
+
+    size_t find( const StringT& str, size_t begin, size_t end, const StringT& segment ) const
+    {
+        if ( end - begin < segment.size() )
+            return StringT::npos;
+
+        if ( !m_hasQuestion )
+        {
+            size_t  pos = str.find( segment, begin );
+            return pos != StringT::npos && pos + segment.size() <= end ? pos : StringT::npos;
+        }
+
+        for ( size_t pos = begin; pos + segment.size() <= end; ++pos )
+        {
+            if ( matchAt( str, pos, segment ) )
+                return pos;
+        }
+
+        return StringT::npos;
+    }
+
+    StringT  m_pattern;
+    std::vector<StringT>  m_segments;
+    bool  m_hasStar;
+    bool  m_hasQuestion;
+};
+
+typedef BasicGlobPattern<char>  GlobPatternA;
+typedef BasicGlobPattern<wchar_t>  GlobPattern;
+
+///////////////////////////////////////////////////////////////////////////////
+
+// the compiled patterns of the recent calls are cached, loops over many
+// strings should compile a GlobPattern once instead
 bool fnmatch( const std::string& pattern, const std::string& str);
 
 bool fnmatch( const std::wstring& pattern, const std::wstring& str);
@@ -0,0 +1,241 @@
+#include "stdafx.h"
+
+#include <functional>
+
+#include <boost/thread/lock_guard.hpp>
+
+#include "kdlib/exceptions.h"
+
+#include "framescope.h"
+
+namespace kdlib {
+
+typedef std::pair<MEMOFFSET_64, MEMOFFSET_64>   DebugRange;
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+
+DebugRange getFuncDebugRange(SymbolPtr& sym)
+{
+    SymbolPtrList lstFuncDebugStart;
+    SymbolPtrList lstFuncDebugEnd;
+
+    try
+    {
+        lstFuncDebugStart = sym->findChildren(SymTagFuncDebugStart);
+        if ( lstFuncDebugStart.empty() )
+            return std::make_pair(0, 0);
+
+        lstFuncDebugEnd = sym->findChildren(SymTagFuncDebugEnd);
+        if ( lstFuncDebugEnd.empty() )
+            return std::make_pair(0, 0);
+
+        return std::make_pair( (*lstFuncDebugStart.begin())->getVa(), (*lstFuncDebugEnd.begin())->getVa());
+    }
+    catch (const SymbolException&)
+    {
+    }
+
+    return std::make_pair(0, 0);
+}
+
+DebugRange getBlockRange(SymbolPtr& sym)
+{
+    MEMOFFSET_64   blockBegin = sym->getVa();
+    MEMOFFSET_64   blockEnd = blockBegin + sym->getSize();
+
+    return std::make_pair(blockBegin, blockEnd);
+}
+
+bool inDebugRange( const DebugRange& range, MEMOFFSET_64 offset)
+{
+    return range.first <= offset && range.second >= offset;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void FrameScope::VarList::push_back(const SymbolPtr& sym)
+{
+    names.insert( std::make_pair(sym->getName(), symbols.size()) );
+    symbols.push_back(sym);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SymbolPtr FrameScope::VarList::find(const std::wstring& name) const
+{
+    std::unordered_map<std::wstring, size_t>::const_iterator  it = names.find(name);
+
+    return it != names.end() ? symbols[it->second] : SymbolPtr();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+FrameScope::FrameScope(ModulePtr& module, MEMOFFSET_64 ip)
+{
+    SymbolPtr  symFunc;
+    SymbolPtrList  symList;
+
+    try
+    {
+        MEMDISPLACEMENT displacemnt;
+        symFunc = module->getSymbolByVa(ip, SymTagFunction, &displacemnt);
+
+        symList = symFunc->findChildrenByRVA(SymTagData, static_cast<MEMOFFSET_32>(ip - module->getBase()));
+
+        for (SymbolPtrList::iterator it = symList.begin(); it != symList.end(); ++it)
+        {
+            unsigned long dataKind = (*it)->getDataKind();
+
+            if ( dataKind == DataIsParam || dataKind == DataIsObjectPtr )
+                m_params.push_back(*it);
+        }
+    }
+    catch (SymbolException&)
+    {
+        m_params = VarList();
+        m_error = std::current_exception();
+        return;
+    }
+
+    DebugRange  debugRange = getFuncDebugRange(symFunc);
+
+    if ( !inDebugRange(debugRange, ip) )
+        return;
+
+    try
+    {
+        // find var in current scope
+        for (SymbolPtrList::iterator it = symList.begin(); it != symList.end(); ++it)
+        {
+            unsigned long dataKind = (*it)->getDataKind();
+
+            if ( dataKind == DataIsLocal )
+                m_locals.push_back(*it);
+            else if ( dataKind == DataIsStaticLocal && !(*it)->getName().empty() )
+                m_statics.push_back(*it);
+        }
+
+        // find inners scopes
+        SymbolPtrList scopeList = symFunc->findChildren(SymTagBlock);
+
+        for (SymbolPtrList::iterator itScope = scopeList.begin(); itScope != scopeList.end(); ++itScope)
+            addBlockVars(*itScope, ip);
+    }
+    catch (SymbolException&)
+    {
+        m_locals = VarList();
+        m_statics = VarList();
+        m_error = std::current_exception();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void FrameScope::addBlockVars(SymbolPtr& block, MEMOFFSET_64 ip)
+{
+    DebugRange  debugRange = getBlockRange(block);
+
+    if ( !inDebugRange(debugRange, ip) )
+        return;
+
+    SymbolPtrList symList = block->findChildren(SymTagData);
+
+    for (SymbolPtrList::iterator it = symList.begin(); it != symList.end(); ++it)
+    {
+        unsigned long dataKind = (*it)->getDataKind();
+
+        if ( dataKind == DataIsLocal )
+            m_locals.push_back(*it);
+        else if ( dataKind == DataIsStaticLocal && !(*it)->getName().empty() )
+            m_statics.push_back(*it);
+    }
+
+    SymbolPtrList scopeList = block->findChildren(SymTagBlock);
+
+    for (SymbolPtrList::iterator itScope = scopeList.begin(); itScope != scopeList.end(); ++itScope)
+        addBlockVars(*itScope, ip);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t FrameScopeCache::KeyHash::operator()(const Key& key) const
+{
+    size_t  hash = std::hash<MEMOFFSET_64>()(key.second);
+    return hash ^ ( std::hash<MEMOFFSET_64>()(key.first) + 0x9e3779b9 + (hash << 6) + (hash >> 2) );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+FrameScopePtr FrameScopeCache::get(ModulePtr& module, MEMOFFSET_64 ip)
+{
+    Key  key( module->getBase(), ip - module->getBase() );
+
+    {
+        boost::lock_guard<boost::mutex>  l(m_lock);
+
+        ScopeMap::const_iterator  it = m_scopes.find(key);
+        if ( it != m_scopes.end() )
+        {
+            ++m_hits;
+            return it->second;
+        }
+    }
+
+    // symbol queries are made without the lock; a failed scope is cached too,
+    // a frame without private symbols would query them on every access else
+    FrameScopePtr  scope( new FrameScope(module, ip) );
+
+    boost::lock_guard<boost::mutex>  l(m_lock);
+
+    ++m_misses;
+
+    if ( m_scopes.size() >= maxScopes )
+        m_scopes.clear();
+
+    return m_scopes.insert( std::make_pair(key, scope) ).first->second;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void FrameScopeCache::invalidate(MEMOFFSET_64 moduleBase)
+{
+    boost::lock_guard<boost::mutex>  l(m_lock);
+
+    for (ScopeMap::iterator it = m_scopes.begin(); it != m_scopes.end(); )
+    {
+        if ( it->first.first == moduleBase )
+            it = m_scopes.erase(it);
+        else
+            ++it;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+FrameScopeStatistics FrameScopeCache::getStatistics()
+{
+    boost::lock_guard<boost::mutex>  l(m_lock);
+
+    FrameScopeStatistics  stat = {};
+    stat.hits = m_hits;
+    stat.misses = m_misses;
+    stat.cachedScopes = m_scopes.size();
+
+    for (ScopeMap::const_iterator it = m_scopes.begin(); it != m_scopes.end(); ++it)
+    {
+        if ( !it->second->isComplete() )
+            ++stat.failedScopes;
+    }
+
+    return stat;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
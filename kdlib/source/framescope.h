@@ -0,0 +1,130 @@
+#pragma once
+
+#include <exception>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "kdlib/dbgtypedef.h"
+#include "kdlib/module.h"
+#include "kdlib/symengine.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Parameters, local and static variables visible in a function at one
+// address. All frames stopped at the same address ( including the inline
+// frames ) share one scope
+class FrameScope : private boost::noncopyable
+{
+public:
+
+    typedef std::vector<SymbolPtr>  SymbolVector;
+
+    FrameScope(ModulePtr& module, MEMOFFSET_64 ip);
+
+    const SymbolVector& getParams() const {
+        return m_params.symbols;
+    }
+
+    const SymbolVector& getLocalVars() const {
+        return m_locals.symbols;
+    }
+
+    // the statics rethrow the symbol error as they did before the scopes
+    const SymbolVector& getStaticVars() const {
+        if ( m_error )
+            std::rethrow_exception(m_error);
+        return m_statics.symbols;
+    }
+
+    SymbolPtr findParam(const std::wstring& name) const {
+        return m_params.find(name);
+    }
+
+    SymbolPtr findLocalVar(const std::wstring& name) const {
+        return m_locals.find(name);
+    }
+
+    SymbolPtr findStaticVar(const std::wstring& name) const {
+        if ( m_error )
+            std::rethrow_exception(m_error);
+        return m_statics.find(name);
+    }
+
+    // false if a symbol query failed; such a scope is cached with its error
+    // until the module symbols are reset
+    bool isComplete() const {
+        return !m_error;
+    }
+
+private:
+
+    struct VarList {
+        SymbolVector  symbols;
+        std::unordered_map<std::wstring, size_t>  names;  // the first variable with the name
+
+        void push_back(const SymbolPtr& sym);
+
+        SymbolPtr find(const std::wstring& name) const;
+    };
+
+    void addBlockVars(SymbolPtr& block, MEMOFFSET_64 ip);
+
+    VarList  m_params;
+    VarList  m_locals;
+    VarList  m_statics;
+
+    std::exception_ptr  m_error;
+};
+
+typedef boost::shared_ptr<const FrameScope>  FrameScopePtr;
+
+///////////////////////////////////////////////////////////////////////////////
+
+class FrameScopeCache;
+typedef boost::shared_ptr<FrameScopeCache>  FrameScopeCachePtr;
+
+// Frame scopes of a process keyed by ( module base, RVA )
+class FrameScopeCache : private boost::noncopyable
+{
+public:
+
+    static const size_t  maxScopes = 0x1000;
+
+    FrameScopeCache() :
+        m_hits(0),
+        m_misses(0)
+        {}
+
+    FrameScopePtr get(ModulePtr& module, MEMOFFSET_64 ip);
+
+    void invalidate(MEMOFFSET_64 moduleBase);
+
+    FrameScopeStatistics getStatistics();
+
+private:
+
+    typedef std::pair<MEMOFFSET_64, MEMOFFSET_64>  Key;
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    typedef std::unordered_map<Key, FrameScopePtr, KeyHash>  ScopeMap;
+
+    boost::mutex  m_lock;
+    ScopeMap  m_scopes;
+
+    unsigned long long  m_hits;
+    unsigned long long  m_misses;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
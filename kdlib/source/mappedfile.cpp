@@ -0,0 +1,112 @@
+#include "stdafx.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <codecvt>
+#include <locale>
+#endif
+
+#include "kdlib/exceptions.h"
+
+#include "mappedfile.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::wstring& fileName) :
+    m_data(0),
+    m_size(0),
+    m_file(INVALID_HANDLE_VALUE),
+    m_mapping(0)
+{
+    m_file = CreateFileW(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m_file == INVALID_HANDLE_VALUE)
+        throw DbgWideException(std::wstring(L"failed to open file ") + fileName);
+
+    LARGE_INTEGER  fileSize = {};
+    if (!GetFileSizeEx(m_file, &fileSize))
+    {
+        CloseHandle(m_file);
+        throw DbgWideException(std::wstring(L"failed to get size of file ") + fileName);
+    }
+
+    m_size = fileSize.QuadPart;
+    if (m_size == 0)
+        return;
+
+    m_mapping = CreateFileMappingW(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (m_mapping)
+        m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+
+    if (!m_data)
+    {
+        if (m_mapping)
+            CloseHandle(m_mapping);
+        CloseHandle(m_file);
+        throw DbgWideException(std::wstring(L"failed to map file ") + fileName);
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    CloseHandle(m_file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::wstring& fileName) :
+    m_data(0),
+    m_size(0),
+    m_file(-1)
+{
+    std::string  path = std::wstring_convert<std::codecvt_utf8<wchar_t> >().to_bytes(fileName);
+
+    m_file = open(path.c_str(), O_RDONLY);
+    if (m_file < 0)
+        throw DbgWideException(std::wstring(L"failed to open file ") + fileName);
+
+    struct stat  fileStat = {};
+    if (fstat(m_file, &fileStat) != 0)
+    {
+        close(m_file);
+        throw DbgWideException(std::wstring(L"failed to get size of file ") + fileName);
+    }
+
+    m_size = fileStat.st_size;
+    if (m_size == 0)
+        return;
+
+    void*  view = mmap(0, static_cast<size_t>(m_size), PROT_READ, MAP_PRIVATE, m_file, 0);
+    if (view == MAP_FAILED)
+    {
+        close(m_file);
+        throw DbgWideException(std::wstring(L"failed to map file ") + fileName);
+    }
+
+    m_data = static_cast<const char*>(view);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data)
+        munmap(const_cast<char*>(m_data), static_cast<size_t>(m_size));
+    close(m_file);
+}
+
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+class MappedFile;
+typedef boost::shared_ptr<MappedFile>  MappedFilePtr;
+
+// read only view of the whole file
+class MappedFile : private boost::noncopyable
+{
+public:
+
+    explicit MappedFile(const std::wstring& fileName);
+
+    ~MappedFile();
+
+    const char* data() const {
+        return m_data;
+    }
+
+    unsigned long long size() const {
+        return m_size;
+    }
+
+private:
+
+    const char*  m_data;
+    unsigned long long  m_size;
+
+#ifdef _WIN32
+    void*  m_file;
+    void*  m_mapping;
+#else
+    int  m_file;
+#endif
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
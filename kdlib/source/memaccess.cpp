@@ -2,11 +2,272 @@
 
 #include <vector>
 
+#include <boost/numeric/conversion/cast.hpp>
+
 #include "kdlib/memaccess.h"
+#include "kdlib/memprovider.h"
 #include "kdlib/exceptions.h"
 
+#include "processmon.h"
+
+using boost::numeric_cast;
+
 namespace kdlib {
 
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+MemoryProviderPtr  g_memoryProvider;
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void setMemoryProvider( const MemoryProviderPtr& provider )
+{
+    boost::atomic_store( &g_memoryProvider, provider );
+    nextMemoryGeneration();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MemoryProviderPtr getMemoryProvider()
+{
+    MemoryProviderPtr  provider = boost::atomic_load( &g_memoryProvider );
+    return provider ? provider : getDebugEngineMemoryProvider();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static bool readCachePage( MEMOFFSET_64 offset, void* buffer, size_t length )
+{
+    unsigned long  readed = 0;
+    return getDebugEngineMemoryProvider()->readMemory( offset, buffer, length, false, &readed ) && readed == length;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static MemoryCachePtr getMemoryCache( const MemoryProviderPtr& provider )
+{
+    // the page cache belongs to the debug engine process
+    if ( provider != getDebugEngineMemoryProvider() )
+        return MemoryCachePtr();
+
+    return ProcessMonitor::getMemoryCache();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static size_t readMemoryCached( const MemoryProviderPtr& provider, MEMOFFSET_64 offset, void* buffer, size_t length, bool phyAddr )
+{
+    if ( phyAddr || length == 0 )
+        return 0;
+
+    MemoryCachePtr  cache = getMemoryCache( provider );
+    if ( !cache )
+        return 0;
+
+    return cache->read( offset, buffer, length, readCachePage );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MEMOFFSET_64 addr64( MEMOFFSET_64 offset )
+{
+    return getMemoryProvider()->addr64( offset );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void readMemory( MEMOFFSET_64 offset, void* buffer, size_t length, bool phyAddr, unsigned long *readed )
+{
+    MemoryProviderPtr  provider = getMemoryProvider();
+
+    if ( readed )
+        *readed = 0;
+
+    if ( phyAddr == false )
+        offset = provider->addr64( offset );
+
+    size_t  cached = readMemoryCached( provider, offset, buffer, length, phyAddr );
+
+    if ( cached == length )
+    {
+        if ( readed )
+            *readed = numeric_cast<unsigned long>(length);
+        return;
+    }
+
+    unsigned long  rest = 0;
+
+    if ( !provider->readMemory( offset + cached, reinterpret_cast<char*>(buffer) + cached, length - cached, phyAddr, &rest ) )
+    {
+        // a partial read is an error unless "readed" can return its length
+        if ( !readed || cached + rest == 0 )
+            throw MemoryException( offset + cached + rest, phyAddr );
+    }
+
+    if ( readed )
+        *readed = numeric_cast<unsigned long>(cached + rest);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool readMemoryUnsafe( MEMOFFSET_64 offset, void* buffer, size_t length, bool phyAddr, unsigned long *readed  )
+{
+    MemoryProviderPtr  provider = getMemoryProvider();
+
+    if ( phyAddr == false )
+        offset = provider->addr64( offset );
+
+    size_t  cached = readMemoryCached( provider, offset, buffer, length, phyAddr );
+
+    if ( cached == length )
+    {
+        if ( readed )
+            *readed = numeric_cast<unsigned long>(length);
+        return true;
+    }
+
+    unsigned long  rest = 0;
+
+    bool  result = provider->readMemory( offset + cached, reinterpret_cast<char*>(buffer) + cached, length - cached, phyAddr, &rest );
+
+    if ( readed )
+        *readed = numeric_cast<unsigned long>(cached + rest);
+
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void writeMemory( MEMOFFSET_64 offset, const void* buffer, size_t length, bool phyAddr, unsigned long *written )
+{
+    MemoryProviderPtr  provider = getMemoryProvider();
+
+    if ( written )
+        *written = 0;
+
+    if ( phyAddr == false )
+        offset = provider->addr64( offset );
+
+    bool  result = provider->writeMemory( offset, buffer, length, phyAddr, written );
+
+    nextMemoryGeneration();
+
+    MemoryCachePtr  cache = getMemoryCache( provider );
+    if ( cache )
+    {
+        if ( phyAddr )
+            cache->invalidate();
+        else
+            cache->invalidate( offset, length );
+    }
+
+    if ( !result )
+        throw MemoryException( offset, phyAddr );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool isVaValid( MEMOFFSET_64 offset )
+{
+    MemoryProviderPtr  provider = getMemoryProvider();
+    return provider->isVaValid( provider->addr64(offset) );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool isVaRegionValid( MEMOFFSET_64 addr, size_t length )
+{
+    MemoryProviderPtr  provider = getMemoryProvider();
+    return provider->isVaRegionValid( provider->addr64(addr), length );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MEMOFFSET_64 searchMemory( MEMOFFSET_64 beginOffset, unsigned long length, const std::vector<char>& pattern )
+{
+    if ( pattern.empty() )
+        throw DbgException( "searchMemeory: pattern parameter can not have 0 length" );
+
+    MemoryProviderPtr  provider = getMemoryProvider();
+
+    MEMOFFSET_64  foundOffset = 0;
+
+    if ( !provider->searchMemory( provider->addr64(beginOffset), length, pattern, foundOffset ) )
+        return 0LL;
+
+    return foundOffset;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static MemoryRegionInfo queryRegion( MEMOFFSET_64 offset )
+{
+    MemoryProviderPtr  provider = getMemoryProvider();
+
+    offset = provider->addr64(offset);
+
+    MemoryRegionInfo  regionInfo = {};
+
+    if ( !provider->queryRegion( offset, regionInfo ) )
+        throw MemoryException( offset );
+
+    return regionInfo;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MEMOFFSET_64 findMemoryRegion( MEMOFFSET_64 beginOffset, MEMOFFSET_64& regionOffset, unsigned long long &regionLength )
+{
+    MemoryProviderPtr  provider = getMemoryProvider();
+
+    if ( provider == getDebugEngineMemoryProvider() && isKernelDebugging() )
+        throw DbgException("findMemoryRegion does not work in the kernel mode");
+
+    beginOffset = provider->addr64(beginOffset);
+
+    while ( true )
+    {
+        MemoryRegionInfo  regionInfo = {};
+
+        if ( !provider->queryRegion( beginOffset, regionInfo ) )
+            throw MemoryException( beginOffset );
+
+        if ( regionInfo.state == MemCommit )
+        {
+            regionOffset = regionInfo.baseOffset;
+            regionLength = regionInfo.regionLength;
+
+            return regionOffset;
+        }
+
+        beginOffset = regionInfo.baseOffset + regionInfo.regionLength;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MemoryProtect getVaProtect( MEMOFFSET_64 offset )
+{
+    return queryRegion( offset ).protect;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MemoryState getVaState( MEMOFFSET_64 offset )
+{
+    return queryRegion( offset ).state;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MemoryType getVaType( MEMOFFSET_64 offset )
+{
+    return queryRegion( offset ).type;
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -405,6 +666,80 @@ std::wstring loadWChars( MEMOFFSET_64 offset, unsigned long number, bool phyAddr
 
 ///////////////////////////////////////////////////////////////////////////////
 
+template<typename T>
+std::basic_string<T>
+loadStr( MEMOFFSET_64 offset )
+{
+    // the limit of the engine string reads: 0x10000 bytes with the terminator
+    const size_t  maxLength = 0x10000 / sizeof(T);
+    const size_t  pageSize = 0x1000;
+
+    offset = addr64( offset );
+
+    std::basic_string<T>  str;
+
+    while ( str.size() < maxLength )
+    {
+        // do not cross a page boundary: the next page may be invalid
+        T  buffer[pageSize / sizeof(T)];
+
+        MEMOFFSET_64  current = offset + str.size() * sizeof(T);
+        size_t  chunk = ( pageSize - static_cast<size_t>(current % pageSize) ) / sizeof(T);
+        if ( chunk == 0 )
+            chunk = 1;
+
+        chunk = (std::min)( chunk, maxLength - str.size() );
+
+        // a partial read is fine if the terminator is in the read part
+        unsigned long  readed = 0;
+        readMemoryUnsafe( current, buffer, chunk * sizeof(T), false, &readed );
+        if ( readed < sizeof(T) )
+            throw MemoryException( current );
+
+        size_t  count = readed / sizeof(T);
+
+        for ( size_t i = 0; i < count; ++i )
+        {
+            if ( buffer[i] == 0 )
+                return str;
+
+            str.push_back( buffer[i] );
+        }
+    }
+
+    throw MemoryException( offset );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string loadCStr( MEMOFFSET_64 offset )
+{
+    return loadStr<char>( offset );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::wstring loadWStr( MEMOFFSET_64 offset )
+{
+    return loadStr<wchar_t>( offset );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void writeCStr( MEMOFFSET_64 offset, const std::string& str)
+{
+   writeMemory( offset, str.c_str(), str.size() + 1 );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void writeWStr( MEMOFFSET_64 offset, const std::wstring& str)
+{
+   writeMemory( offset, str.c_str(), sizeof(wchar_t)*( str.size() + 1 ) );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 MEMOFFSET_64 ptrPtr( MEMOFFSET_64 offset, size_t psize)
 {
     psize = psize == 0 ? ptrSize() : psize;
@@ -491,4 +826,40 @@ bool compareMemory( MEMOFFSET_64 addr1, MEMOFFSET_64 addr2, size_t length, bool
 
 ///////////////////////////////////////////////////////////////////////////////
 
+void enableMemoryCache( bool enable, size_t maxPages )
+{
+    ProcessMonitor::enableMemoryCache( enable, maxPages );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool isMemoryCacheEnabled()
+{
+    return ProcessMonitor::isMemoryCacheEnabled();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void resetMemoryCache()
+{
+    ProcessMonitor::resetMemoryCache();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MemoryCacheStatistics getMemoryCacheStatistics()
+{
+    MemoryCachePtr  cache = ProcessMonitor::getMemoryCache();
+
+    if ( !cache )
+    {
+        MemoryCacheStatistics  stat = {};
+        return stat;
+    }
+
+    return cache->getStatistics();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 } // kdlib namespace end
@@ -0,0 +1,173 @@
+#include "stdafx.h"
+
+#include <algorithm>
+
+#include <boost/atomic.hpp>
+
+#include "memcache.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+boost::atomic<unsigned long long>  g_memoryGeneration(0);
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+unsigned long long getMemoryGeneration()
+{
+    return g_memoryGeneration.load();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void nextMemoryGeneration()
+{
+    ++g_memoryGeneration;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MemoryCache::MemoryCache(size_t maxPages) :
+    m_maxPages(maxPages),
+    m_hits(0),
+    m_misses(0),
+    m_evictions(0)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t MemoryCache::read(MEMOFFSET_64 offset, void* buffer, size_t length, const PageReader& reader)
+{
+    boost::recursive_mutex::scoped_lock l(m_lock);
+
+    // a bulk read larger than a quarter of the cache would only flush it
+    if ( m_maxPages == 0 || length / pageSize >= m_maxPages / 4 + 1 )
+        return 0;
+
+    unsigned char*  dst = reinterpret_cast<unsigned char*>(buffer);
+    size_t  copied = 0;
+
+    while ( copied < length )
+    {
+        MEMOFFSET_64  current = offset + copied;
+        MEMOFFSET_64  pageOffset = current & ~static_cast<MEMOFFSET_64>(pageSize - 1);
+        size_t  inPage = static_cast<size_t>(current - pageOffset);
+        size_t  chunk = (std::min)(pageSize - inPage, length - copied);
+
+        const PageData*  page = getPage(pageOffset, reader);
+        if ( !page )
+            break;
+
+        memcpy(dst + copied, &page->at(inPage), chunk);
+        copied += chunk;
+    }
+
+    return copied;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const MemoryCache::PageData* MemoryCache::getPage(MEMOFFSET_64 pageOffset, const PageReader& reader)
+{
+    PageMap::iterator  it = m_pageMap.find(pageOffset);
+
+    if ( it != m_pageMap.end() )
+    {
+        ++m_hits;
+        m_pages.splice(m_pages.begin(), m_pages, it->second);
+        return &it->second->second;
+    }
+
+    ++m_misses;
+
+    PageData  data(pageSize);
+    if ( !reader(pageOffset, &data[0], pageSize) )
+        return 0;
+
+    shrink(m_maxPages - 1);
+
+    m_pages.push_front(Page(pageOffset, PageData()));
+    m_pages.front().second.swap(data);
+    m_pageMap[pageOffset] = m_pages.begin();
+
+    return &m_pages.front().second;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MemoryCache::shrink(size_t maxPages)
+{
+    while ( m_pages.size() > maxPages )
+    {
+        m_pageMap.erase(m_pages.back().first);
+        m_pages.pop_back();
+        ++m_evictions;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MemoryCache::invalidate()
+{
+    boost::recursive_mutex::scoped_lock l(m_lock);
+
+    m_pageMap.clear();
+    m_pages.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MemoryCache::invalidate(MEMOFFSET_64 offset, size_t length)
+{
+    if ( length == 0 )
+        return;
+
+    boost::recursive_mutex::scoped_lock l(m_lock);
+
+    MEMOFFSET_64  pageOffset = offset & ~static_cast<MEMOFFSET_64>(pageSize - 1);
+    MEMOFFSET_64  pageCount = (offset + length - 1 - pageOffset) / pageSize + 1;
+
+    for ( MEMOFFSET_64 i = 0; i < pageCount; ++i, pageOffset += pageSize )
+    {
+        PageMap::iterator  it = m_pageMap.find(pageOffset);
+        if ( it != m_pageMap.end() )
+        {
+            m_pages.erase(it->second);
+            m_pageMap.erase(it);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MemoryCache::setLimit(size_t maxPages)
+{
+    boost::recursive_mutex::scoped_lock l(m_lock);
+
+    m_maxPages = maxPages;
+    shrink(m_maxPages);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MemoryCacheStatistics MemoryCache::getStatistics()
+{
+    boost::recursive_mutex::scoped_lock l(m_lock);
+
+    MemoryCacheStatistics  stat = {};
+    stat.hits = m_hits;
+    stat.misses = m_misses;
+    stat.evictions = m_evictions;
+    stat.cachedPages = m_pages.size();
+    stat.maxPages = m_maxPages;
+    return stat;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
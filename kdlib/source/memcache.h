@@ -0,0 +1,78 @@
+#pragma once
+
+#include <list>
+#include <vector>
+#include <unordered_map>
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+
+#include "kdlib/dbgtypedef.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+class MemoryCache;
+typedef boost::shared_ptr<MemoryCache>  MemoryCachePtr;
+
+// Page-granular LRU cache of the target virtual memory.
+// A page is cached only if it was read completely, so a partially valid range
+// is never served from the cache beyond its last good page
+class MemoryCache : private boost::noncopyable
+{
+public:
+
+    static const size_t  pageSize = 0x1000;
+
+    typedef boost::function<bool (MEMOFFSET_64 pageOffset, void* buffer, size_t length)>  PageReader;
+
+    explicit MemoryCache(size_t maxPages);
+
+    // returns the number of bytes copied from the beginning of the range;
+    // the rest of the range ( if any ) must be read directly
+    size_t read(MEMOFFSET_64 offset, void* buffer, size_t length, const PageReader& reader);
+
+    void invalidate();
+
+    void invalidate(MEMOFFSET_64 offset, size_t length);
+
+    void setLimit(size_t maxPages);
+
+    MemoryCacheStatistics getStatistics();
+
+private:
+
+    typedef std::vector<unsigned char>  PageData;
+    typedef std::pair<MEMOFFSET_64, PageData>  Page;
+    typedef std::list<Page>  PageList;
+    typedef std::unordered_map<MEMOFFSET_64, PageList::iterator>  PageMap;
+
+    const PageData* getPage(MEMOFFSET_64 pageOffset, const PageReader& reader);
+
+    void shrink(size_t maxPages);
+
+    boost::recursive_mutex  m_lock;
+
+    PageList  m_pages;
+    PageMap  m_pageMap;
+    size_t  m_maxPages;
+
+    unsigned long long  m_hits;
+    unsigned long long  m_misses;
+    unsigned long long  m_evictions;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// The generation of the target memory changes on every write and on every
+// change of the target state, so a snapshot of the memory taken by a reader
+// can check it is still actual
+unsigned long long getMemoryGeneration();
+void nextMemoryGeneration();
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
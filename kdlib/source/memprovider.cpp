@@ -0,0 +1,289 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <boost/make_shared.hpp>
+#include <boost/numeric/conversion/cast.hpp>
+
+#include "kdlib/memaccess.h"
+#include "kdlib/exceptions.h"
+
+#include "memproviderimpl.h"
+#include "mappedfile.h"
+
+using boost::numeric_cast;
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+void BufferMemoryProvider::addRegion(MEMOFFSET_64 baseOffset, const std::vector<char>& buffer)
+{
+    boost::shared_ptr< std::vector<char> >  storage = boost::make_shared< std::vector<char> >(buffer);
+
+    addRegion(baseOffset, storage->empty() ? 0 : &storage->front(), storage->size(), storage);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void BufferMemoryProvider::addRegion(MEMOFFSET_64 baseOffset, const char* data, size_t length, const boost::shared_ptr<void>& storage)
+{
+    if (length == 0)
+        return;
+
+    RegionMap::const_iterator  next = m_regions.lower_bound(baseOffset);
+
+    if (next != m_regions.end() && next->first - baseOffset < length)
+        throw DbgException("memory regions can not overlap");
+
+    if (next != m_regions.begin())
+    {
+        RegionMap::const_iterator  prev = next;
+        --prev;
+        if (baseOffset - prev->first < prev->second.length)
+            throw DbgException("memory regions can not overlap");
+    }
+
+    Region  region = { data, length, storage };
+    m_regions.insert(std::make_pair(baseOffset, region));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+BufferMemoryProvider::RegionMap::const_iterator BufferMemoryProvider::findRegion(MEMOFFSET_64 offset) const
+{
+    RegionMap::const_iterator  it = m_regions.upper_bound(offset);
+
+    if (it == m_regions.begin())
+        return m_regions.end();
+
+    --it;
+
+    if (offset - it->first >= it->second.length)
+        return m_regions.end();
+
+    return it;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t BufferMemoryProvider::copyMemory(MEMOFFSET_64 offset, char* dst, const char* src, size_t length)
+{
+    size_t  copied = 0;
+
+    RegionMap::const_iterator  it = findRegion(offset);
+
+    while (copied < length && it != m_regions.end())
+    {
+        MEMOFFSET_64  current = offset + copied;
+        size_t  inRegion = static_cast<size_t>(current - it->first);
+        size_t  chunk = (std::min)(it->second.length - inRegion, length - copied);
+
+        char*  regionData = const_cast<char*>(it->second.data) + inRegion;
+
+        if (dst)
+            memcpy(dst + copied, regionData, chunk);
+        else
+            memcpy(regionData, src + copied, chunk);
+
+        copied += chunk;
+
+        MEMOFFSET_64  regionEnd = it->first + it->second.length;
+        ++it;
+
+        if (it == m_regions.end() || it->first != regionEnd)
+            break;
+    }
+
+    return copied;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool BufferMemoryProvider::readMemory(MEMOFFSET_64 offset, void* buffer, size_t length, bool phyAddr, unsigned long *readed)
+{
+    if (readed)
+        *readed = 0;
+
+    if (phyAddr)
+        return false;
+
+    if (length == 0)
+        return true;
+
+    size_t  copied = copyMemory(offset, static_cast<char*>(buffer), 0, length);
+
+    if (readed)
+        *readed = numeric_cast<unsigned long>(copied);
+
+    return copied == length;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool BufferMemoryProvider::writeMemory(MEMOFFSET_64 offset, const void* buffer, size_t length, bool phyAddr, unsigned long *written)
+{
+    if (written)
+        *written = 0;
+
+    if (phyAddr || m_readOnly)
+        return false;
+
+    if (length == 0)
+        return true;
+
+    size_t  copied = copyMemory(offset, 0, static_cast<const char*>(buffer), length);
+
+    if (written)
+        *written = numeric_cast<unsigned long>(copied);
+
+    return copied > 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool BufferMemoryProvider::isVaValid(MEMOFFSET_64 offset)
+{
+    return findRegion(offset) != m_regions.end();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool BufferMemoryProvider::isVaRegionValid(MEMOFFSET_64 offset, size_t length)
+{
+    RegionMap::const_iterator  it = findRegion(offset);
+
+    if (it == m_regions.end())
+        return false;
+
+    MEMOFFSET_64  endOffset = offset + length;
+
+    while (true)
+    {
+        MEMOFFSET_64  regionEnd = it->first + it->second.length;
+
+        if (endOffset <= regionEnd)
+            return true;
+
+        ++it;
+
+        if (it == m_regions.end() || it->first != regionEnd)
+            return false;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool BufferMemoryProvider::queryRegion(MEMOFFSET_64 offset, MemoryRegionInfo& regionInfo)
+{
+    RegionMap::const_iterator  it = findRegion(offset);
+
+    if (it != m_regions.end())
+    {
+        regionInfo.baseOffset = it->first;
+        regionInfo.regionLength = it->second.length;
+        regionInfo.state = MemCommit;
+        regionInfo.protect = m_readOnly ? PageReadOnly : PageReadWrite;
+        regionInfo.type = MemPrivate;
+        return true;
+    }
+
+    it = m_regions.upper_bound(offset);
+
+    if (it == m_regions.end())
+        return false;
+
+    regionInfo.baseOffset = offset;
+    regionInfo.regionLength = it->first - offset;
+    regionInfo.state = MemFree;
+    regionInfo.protect = PageNoAccess;
+    regionInfo.type = MemPrivate;
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool BufferMemoryProvider::searchMemory(MEMOFFSET_64 beginOffset, unsigned long length, const std::vector<char>& pattern, MEMOFFSET_64& foundOffset)
+{
+    MEMOFFSET_64  endOffset = beginOffset + length;
+
+    RegionMap::const_iterator  it = findRegion(beginOffset);
+    if (it == m_regions.end())
+        it = m_regions.upper_bound(beginOffset);
+
+    for (; it != m_regions.end() && it->first < endOffset; ++it)
+    {
+        MEMOFFSET_64  from = (std::max)(beginOffset, it->first);
+        MEMOFFSET_64  to = (std::min)(endOffset, it->first + it->second.length);
+
+        const char*  first = it->second.data + (from - it->first);
+        const char*  last = it->second.data + (to - it->first);
+
+        const char*  found = std::search(first, last, pattern.begin(), pattern.end());
+        if (found != last)
+        {
+            foundOffset = from + (found - first);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MemoryProviderPtr getBufferMemoryProvider( MEMOFFSET_64 baseOffset, const std::vector<char>& buffer )
+{
+    boost::shared_ptr<BufferMemoryProvider>  provider = boost::make_shared<BufferMemoryProvider>();
+    provider->addRegion(baseOffset, buffer);
+    return provider;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MemoryProviderPtr getBufferMemoryProvider( MEMOFFSET_64 baseOffset, const void* rawBuffer, size_t bufferSize )
+{
+    const char*  data = static_cast<const char*>(rawBuffer);
+    return getBufferMemoryProvider(baseOffset, std::vector<char>(data, data + bufferSize));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MemoryProviderPtr getSnapshotMemoryProvider( const std::vector< std::pair<MEMOFFSET_64, size_t> >& ranges )
+{
+    boost::shared_ptr<BufferMemoryProvider>  provider = boost::make_shared<BufferMemoryProvider>();
+
+    for (size_t i = 0; i < ranges.size(); ++i)
+    {
+        MEMOFFSET_64  offset = addr64(ranges[i].first);
+
+        std::vector<char>  buffer(ranges[i].second);
+        if (!buffer.empty())
+            readMemory(offset, &buffer[0], buffer.size());
+
+        provider->addRegion(offset, buffer);
+    }
+
+    return provider;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MemoryProviderPtr getFileMemoryProvider( const std::wstring& fileName, MEMOFFSET_64 baseOffset, unsigned long long fileOffset, unsigned long long length )
+{
+    MappedFilePtr  file = boost::make_shared<MappedFile>(fileName);
+
+    if (fileOffset > file->size())
+        throw DbgException("file offset is out of the file");
+
+    length = (std::min)(length, file->size() - fileOffset);
+
+    boost::shared_ptr<BufferMemoryProvider>  provider = boost::make_shared<BufferMemoryProvider>(true);
+    provider->addRegion(baseOffset, file->data() + fileOffset, numeric_cast<size_t>(length), file);
+    return provider;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
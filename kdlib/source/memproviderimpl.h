@@ -0,0 +1,70 @@
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "kdlib/memprovider.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Flat target memory made of the non overlapped regions.
+// The region data is owned by the "storage" object: a copy of the buffer
+// or a mapped file
+class BufferMemoryProvider : public MemoryProvider
+{
+public:
+
+    explicit BufferMemoryProvider(bool readOnly = false) :
+        m_readOnly(readOnly)
+    {}
+
+    void addRegion(MEMOFFSET_64 baseOffset, const std::vector<char>& buffer);
+
+    void addRegion(MEMOFFSET_64 baseOffset, const char* data, size_t length, const boost::shared_ptr<void>& storage);
+
+public:
+
+    virtual MEMOFFSET_64 addr64( MEMOFFSET_64 offset ) {
+        return offset;
+    }
+
+    virtual bool readMemory( MEMOFFSET_64 offset, void* buffer, size_t length, bool phyAddr, unsigned long *readed );
+
+    virtual bool writeMemory( MEMOFFSET_64 offset, const void* buffer, size_t length, bool phyAddr, unsigned long *written );
+
+    virtual bool isVaValid( MEMOFFSET_64 offset );
+
+    virtual bool isVaRegionValid( MEMOFFSET_64 offset, size_t length );
+
+    virtual bool queryRegion( MEMOFFSET_64 offset, MemoryRegionInfo& regionInfo );
+
+    virtual bool searchMemory( MEMOFFSET_64 beginOffset, unsigned long length, const std::vector<char>& pattern, MEMOFFSET_64& foundOffset );
+
+private:
+
+    struct Region {
+        const char*  data;
+        size_t  length;
+        boost::shared_ptr<void>  storage;
+    };
+
+    typedef std::map<MEMOFFSET_64, Region>  RegionMap;
+
+    RegionMap::const_iterator findRegion( MEMOFFSET_64 offset ) const;
+
+    // copies to "dst" or from "src" while the memory is contiguous,
+    // returns the number of bytes copied
+    size_t copyMemory( MEMOFFSET_64 offset, char* dst, const char* src, size_t length );
+
+    RegionMap  m_regions;
+
+    bool  m_readOnly;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
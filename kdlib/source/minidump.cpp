@@ -0,0 +1,557 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+
+#include <boost/make_shared.hpp>
+
+#include "kdlib/minidump.h"
+#include "kdlib/exceptions.h"
+
+#include "memproviderimpl.h"
+#include "mappedfile.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+const unsigned long  MinidumpSignature = 0x504d444d;  // "MDMP"
+
+enum MinidumpStreamType {
+    ThreadListStream = 3,
+    ModuleListStream = 4,
+    MemoryListStream = 5,
+    SystemInfoStream = 7,
+    Memory64ListStream = 9
+};
+
+enum MinidumpArchitecture {
+    ArchitectureIntel = 0,
+    ArchitectureArm = 5,
+    ArchitectureAmd64 = 9,
+    ArchitectureArm64 = 12
+};
+
+// sizes of the packed minidump structures
+const unsigned long  HeaderSize = 32;
+const unsigned long  DirectorySize = 12;
+const unsigned long  MemoryDescriptorSize = 16;
+const unsigned long  MemoryDescriptor64Size = 16;
+const unsigned long  ModuleSize = 108;
+const unsigned long  ThreadSize = 48;
+
+// offsets of the IP, SP and FP in the CONTEXT structures
+struct ContextLayout {
+    size_t  ipOffset;
+    size_t  spOffset;
+    size_t  fpOffset;
+    size_t  regSize;
+};
+
+const ContextLayout  ContextI386 = { 0xB8, 0xC4, 0xB4, 4 };
+const ContextLayout  ContextAmd64 = { 0xF8, 0x98, 0xA0, 8 };
+const ContextLayout  ContextArm = { 0x40, 0x38, 0x30, 4 };
+const ContextLayout  ContextArm64 = { 0x108, 0x100, 0xF0, 8 };
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+class MinidumpImpl : public Minidump
+{
+public:
+
+    explicit MinidumpImpl(const std::wstring& fileName);
+
+public:
+
+    virtual MEMOFFSET_64 addr64( MEMOFFSET_64 offset );
+
+    virtual bool readMemory( MEMOFFSET_64 offset, void* buffer, size_t length, bool phyAddr, unsigned long *readed ) {
+        return m_memory.readMemory(toDumpOffset(offset), buffer, length, phyAddr, readed);
+    }
+
+    virtual bool writeMemory( MEMOFFSET_64 offset, const void* buffer, size_t length, bool phyAddr, unsigned long *written ) {
+        return m_memory.writeMemory(toDumpOffset(offset), buffer, length, phyAddr, written);
+    }
+
+    virtual bool isVaValid( MEMOFFSET_64 offset ) {
+        return m_memory.isVaValid(toDumpOffset(offset));
+    }
+
+    virtual bool isVaRegionValid( MEMOFFSET_64 offset, size_t length ) {
+        return m_memory.isVaRegionValid(toDumpOffset(offset), length);
+    }
+
+    virtual bool queryRegion( MEMOFFSET_64 offset, MemoryRegionInfo& regionInfo );
+
+    virtual bool searchMemory( MEMOFFSET_64 beginOffset, unsigned long length, const std::vector<char>& pattern, MEMOFFSET_64& foundOffset );
+
+public:
+
+    virtual CPUType getCPUType() {
+        return m_cpuType;
+    }
+
+    virtual std::vector<MEMOFFSET_64> getModuleBasesList();
+
+    virtual MEMOFFSET_64 findModuleBase( MEMOFFSET_64 offset );
+
+    virtual std::wstring getModuleName( MEMOFFSET_64 baseOffset );
+
+    virtual std::wstring getModuleImageName( MEMOFFSET_64 baseOffset ) {
+        return getModule(baseOffset).imageName;
+    }
+
+    virtual MEMOFFSET_32 getModuleSize( MEMOFFSET_64 baseOffset ) {
+        return getModule(baseOffset).size;
+    }
+
+    virtual unsigned long getModuleTimeStamp( MEMOFFSET_64 baseOffset ) {
+        return getModule(baseOffset).timeStamp;
+    }
+
+    virtual unsigned long getModuleCheckSum( MEMOFFSET_64 baseOffset ) {
+        return getModule(baseOffset).checkSum;
+    }
+
+    virtual unsigned long getNumberThreads() {
+        return static_cast<unsigned long>(m_threads.size());
+    }
+
+    virtual THREAD_ID getThreadSystemId( unsigned long index ) {
+        return getThread(index).threadId;
+    }
+
+    virtual MEMOFFSET_64 getThreadOffset( unsigned long index ) {
+        return addr64(getThread(index).teb);
+    }
+
+    virtual std::vector<unsigned char> getThreadContext( unsigned long index );
+
+    virtual MEMOFFSET_64 getThreadIP( unsigned long index ) {
+        return getContextRegister(index, m_contextLayout.ipOffset);
+    }
+
+    virtual MEMOFFSET_64 getThreadSP( unsigned long index ) {
+        return getContextRegister(index, m_contextLayout.spOffset);
+    }
+
+    virtual MEMOFFSET_64 getThreadFP( unsigned long index ) {
+        return getContextRegister(index, m_contextLayout.fpOffset);
+    }
+
+private:
+
+    struct ModuleEntry {
+        MEMOFFSET_32  size;
+        unsigned long  timeStamp;
+        unsigned long  checkSum;
+        std::wstring  imageName;
+    };
+
+    struct ThreadEntry {
+        THREAD_ID  threadId;
+        MEMOFFSET_64  teb;
+        unsigned long  contextSize;
+        unsigned long  contextRva;
+    };
+
+    // read with the fixed size types: the dump layout does not depend on the host
+    template<typename T>
+    T get(unsigned long long rva) const
+    {
+        checkRange(rva, sizeof(T));
+        T  value;
+        memcpy(&value, m_file->data() + rva, sizeof(T));
+        return value;
+    }
+
+    void checkRange(unsigned long long rva, unsigned long long length) const
+    {
+        if (rva > m_file->size() || length > m_file->size() - rva)
+            throw DbgException("minidump is corrupted");
+    }
+
+    std::wstring getString(unsigned long rva) const;
+
+    void readSystemInfo(unsigned long rva);
+    void readMemoryList(unsigned long rva);
+    void readMemory64List(unsigned long rva);
+    void readModuleList(unsigned long rva);
+    void readThreadList(unsigned long rva);
+
+    void addMemoryRegion(MEMOFFSET_64 offset, unsigned long long rva, unsigned long long length);
+
+    MEMOFFSET_64 toDumpOffset(MEMOFFSET_64 offset) const {
+        return m_ptrSize == 4 ? (offset & 0xFFFFFFFF) : offset;
+    }
+
+    const ModuleEntry& getModule(MEMOFFSET_64 baseOffset);
+
+    const ThreadEntry& getThread(unsigned long index);
+
+    MEMOFFSET_64 getContextRegister(unsigned long index, size_t regOffset);
+
+    typedef std::map<MEMOFFSET_64, ModuleEntry>  ModuleMap;
+
+    MappedFilePtr  m_file;
+
+    BufferMemoryProvider  m_memory;
+
+    CPUType  m_cpuType;
+    size_t  m_ptrSize;
+    ContextLayout  m_contextLayout;
+
+    ModuleMap  m_modules;
+    std::vector<ThreadEntry>  m_threads;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+MinidumpImpl::MinidumpImpl(const std::wstring& fileName) :
+    m_file(boost::make_shared<MappedFile>(fileName)),
+    m_memory(true),
+    m_cpuType(CPU_AMD64),
+    m_ptrSize(8),
+    m_contextLayout(ContextAmd64)
+{
+    if (m_file->size() < HeaderSize || get<std::uint32_t>(0) != MinidumpSignature)
+        throw DbgWideException(fileName + L" is not a minidump file");
+
+    const unsigned long  numberOfStreams = get<std::uint32_t>(8);
+    const unsigned long  directoryRva = get<std::uint32_t>(12);
+
+    checkRange(directoryRva, static_cast<unsigned long long>(numberOfStreams) * DirectorySize);
+
+    // system info defines the pointer size, so it goes first
+    for (unsigned long i = 0; i < numberOfStreams; ++i)
+    {
+        const unsigned long long  entry = directoryRva + static_cast<unsigned long long>(i) * DirectorySize;
+        if (get<std::uint32_t>(entry) == SystemInfoStream)
+            readSystemInfo(get<std::uint32_t>(entry + 8));
+    }
+
+    for (unsigned long i = 0; i < numberOfStreams; ++i)
+    {
+        const unsigned long long  entry = directoryRva + static_cast<unsigned long long>(i) * DirectorySize;
+        const unsigned long  rva = get<std::uint32_t>(entry + 8);
+
+        switch (get<std::uint32_t>(entry))
+        {
+        case MemoryListStream:
+            readMemoryList(rva);
+            break;
+
+        case Memory64ListStream:
+            readMemory64List(rva);
+            break;
+
+        case ModuleListStream:
+            readModuleList(rva);
+            break;
+
+        case ThreadListStream:
+            readThreadList(rva);
+            break;
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MinidumpImpl::readSystemInfo(unsigned long rva)
+{
+    switch (get<std::uint16_t>(rva))
+    {
+    case ArchitectureIntel:
+        m_cpuType = CPU_I386;
+        m_ptrSize = 4;
+        m_contextLayout = ContextI386;
+        break;
+
+    case ArchitectureAmd64:
+        m_cpuType = CPU_AMD64;
+        m_ptrSize = 8;
+        m_contextLayout = ContextAmd64;
+        break;
+
+    case ArchitectureArm:
+        m_cpuType = CPU_ARM;
+        m_ptrSize = 4;
+        m_contextLayout = ContextArm;
+        break;
+
+    case ArchitectureArm64:
+        m_cpuType = CPU_ARM64;
+        m_ptrSize = 8;
+        m_contextLayout = ContextArm64;
+        break;
+
+    default:
+        throw DbgException("minidump has unknown processor architecture");
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MinidumpImpl::readMemoryList(unsigned long rva)
+{
+    const unsigned long  number = get<std::uint32_t>(rva);
+
+    checkRange(rva + 4ULL, static_cast<unsigned long long>(number) * MemoryDescriptorSize);
+
+    for (unsigned long i = 0; i < number; ++i)
+    {
+        const unsigned long long  desc = rva + 4ULL + static_cast<unsigned long long>(i) * MemoryDescriptorSize;
+
+        addMemoryRegion(get<std::uint64_t>(desc), get<std::uint32_t>(desc + 12), get<std::uint32_t>(desc + 8));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MinidumpImpl::readMemory64List(unsigned long rva)
+{
+    const unsigned long long  number = get<std::uint64_t>(rva);
+    unsigned long long  dataRva = get<std::uint64_t>(rva + 8ULL);
+
+    if (number > m_file->size() / MemoryDescriptor64Size)
+        throw DbgException("minidump is corrupted");
+
+    checkRange(rva + 16ULL, number * MemoryDescriptor64Size);
+
+    // the memory of all ranges follows each other from the base rva
+    for (unsigned long long i = 0; i < number; ++i)
+    {
+        const unsigned long long  desc = rva + 16ULL + i * MemoryDescriptor64Size;
+        const unsigned long long  length = get<std::uint64_t>(desc + 8);
+
+        addMemoryRegion(get<std::uint64_t>(desc), dataRva, length);
+
+        dataRva += length;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MinidumpImpl::addMemoryRegion(MEMOFFSET_64 offset, unsigned long long rva, unsigned long long length)
+{
+    checkRange(rva, length);
+
+    try {
+        m_memory.addRegion(offset, m_file->data() + rva, static_cast<size_t>(length), m_file);
+    }
+    catch (DbgException&)
+    {
+        // a range overlapped with the already loaded one is skipped
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MinidumpImpl::readModuleList(unsigned long rva)
+{
+    const unsigned long  number = get<std::uint32_t>(rva);
+
+    checkRange(rva + 4ULL, static_cast<unsigned long long>(number) * ModuleSize);
+
+    for (unsigned long i = 0; i < number; ++i)
+    {
+        const unsigned long long  module = rva + 4ULL + static_cast<unsigned long long>(i) * ModuleSize;
+
+        ModuleEntry  entry;
+        entry.size = get<std::uint32_t>(module + 8);
+        entry.checkSum = get<std::uint32_t>(module + 12);
+        entry.timeStamp = get<std::uint32_t>(module + 16);
+        entry.imageName = getString(get<std::uint32_t>(module + 20));
+
+        m_modules[toDumpOffset(get<std::uint64_t>(module))] = entry;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MinidumpImpl::readThreadList(unsigned long rva)
+{
+    const unsigned long  number = get<std::uint32_t>(rva);
+
+    checkRange(rva + 4ULL, static_cast<unsigned long long>(number) * ThreadSize);
+
+    m_threads.reserve(number);
+
+    for (unsigned long i = 0; i < number; ++i)
+    {
+        const unsigned long long  thread = rva + 4ULL + static_cast<unsigned long long>(i) * ThreadSize;
+
+        ThreadEntry  entry;
+        entry.threadId = get<std::uint32_t>(thread);
+        entry.teb = get<std::uint64_t>(thread + 16);
+        entry.contextSize = get<std::uint32_t>(thread + 40);
+        entry.contextRva = get<std::uint32_t>(thread + 44);
+
+        checkRange(entry.contextRva, entry.contextSize);
+
+        m_threads.push_back(entry);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::wstring MinidumpImpl::getString(unsigned long rva) const
+{
+    const unsigned long  length = get<std::uint32_t>(rva);
+
+    checkRange(rva + 4ULL, length);
+
+    // MINIDUMP_STRING is UTF-16 regardless of the host wchar_t size
+    std::wstring  str;
+    str.reserve(length / 2);
+
+    for (unsigned long i = 0; i + 1 < length; i += 2)
+        str.push_back(static_cast<wchar_t>(get<std::uint16_t>(rva + 4ULL + i)));
+
+    return str;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MEMOFFSET_64 MinidumpImpl::addr64( MEMOFFSET_64 offset )
+{
+    if (m_ptrSize == 4 && (offset >> 32) == 0)
+        return static_cast<MEMOFFSET_64>(static_cast<long long>(static_cast<int>(offset)));
+
+    return offset;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MinidumpImpl::queryRegion( MEMOFFSET_64 offset, MemoryRegionInfo& regionInfo )
+{
+    if (!m_memory.queryRegion(toDumpOffset(offset), regionInfo))
+        return false;
+
+    regionInfo.baseOffset = addr64(regionInfo.baseOffset);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MinidumpImpl::searchMemory( MEMOFFSET_64 beginOffset, unsigned long length, const std::vector<char>& pattern, MEMOFFSET_64& foundOffset )
+{
+    if (!m_memory.searchMemory(toDumpOffset(beginOffset), length, pattern, foundOffset))
+        return false;
+
+    foundOffset = addr64(foundOffset);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::vector<MEMOFFSET_64> MinidumpImpl::getModuleBasesList()
+{
+    std::vector<MEMOFFSET_64>  bases;
+    bases.reserve(m_modules.size());
+
+    for (ModuleMap::const_iterator it = m_modules.begin(); it != m_modules.end(); ++it)
+        bases.push_back(addr64(it->first));
+
+    return bases;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MEMOFFSET_64 MinidumpImpl::findModuleBase( MEMOFFSET_64 offset )
+{
+    offset = toDumpOffset(offset);
+
+    ModuleMap::const_iterator  it = m_modules.upper_bound(offset);
+
+    if (it != m_modules.begin())
+    {
+        --it;
+        if (offset - it->first < it->second.size)
+            return addr64(it->first);
+    }
+
+    throw DbgException("module not found");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const MinidumpImpl::ModuleEntry& MinidumpImpl::getModule(MEMOFFSET_64 baseOffset)
+{
+    ModuleMap::const_iterator  it = m_modules.find(toDumpOffset(baseOffset));
+
+    if (it == m_modules.end())
+        throw DbgException("module not found");
+
+    return it->second;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::wstring MinidumpImpl::getModuleName( MEMOFFSET_64 baseOffset )
+{
+    const std::wstring&  imageName = getModule(baseOffset).imageName;
+
+    size_t  nameBegin = imageName.find_last_of(L"\\/");
+    nameBegin = nameBegin == std::wstring::npos ? 0 : nameBegin + 1;
+
+    size_t  nameEnd = imageName.find_last_of(L'.');
+    if (nameEnd == std::wstring::npos || nameEnd < nameBegin)
+        nameEnd = imageName.size();
+
+    return imageName.substr(nameBegin, nameEnd - nameBegin);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const MinidumpImpl::ThreadEntry& MinidumpImpl::getThread(unsigned long index)
+{
+    if (index >= m_threads.size())
+        throw IndexException(index);
+
+    return m_threads[index];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::vector<unsigned char> MinidumpImpl::getThreadContext( unsigned long index )
+{
+    const ThreadEntry&  thread = getThread(index);
+
+    const unsigned char*  context = reinterpret_cast<const unsigned char*>(m_file->data()) + thread.contextRva;
+
+    return std::vector<unsigned char>(context, context + thread.contextSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MEMOFFSET_64 MinidumpImpl::getContextRegister(unsigned long index, size_t regOffset)
+{
+    const ThreadEntry&  thread = getThread(index);
+
+    if (regOffset + m_contextLayout.regSize > thread.contextSize)
+        throw DbgException("minidump thread context is too small");
+
+    if (m_contextLayout.regSize == 4)
+        return addr64(get<std::uint32_t>(thread.contextRva + regOffset));
+
+    return get<std::uint64_t>(thread.contextRva + regOffset);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MinidumpPtr openMinidump( const std::wstring& fileName )
+{
+    return MinidumpPtr( new MinidumpImpl(fileName) );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
@@ -32,7 +32,10 @@ ModulePtr loadModule( const std::wstring &name )
 
 ModulePtr loadModule( MEMOFFSET_64 offset )
 {
-   
+    ModulePtr  module = ProcessMonitor::getModule( addr64(offset) );
+    if ( module )
+        return module;
+
     MEMOFFSET_64  moduleOffset = 0;
 
     try {
@@ -47,7 +50,7 @@ ModulePtr loadModule( MEMOFFSET_64 offset )
         throw DbgWideException(sstr.str());
     }
 
-    ModulePtr  module = ProcessMonitor::getModule(offset);
+    module = ProcessMonitor::getModule(moduleOffset);
 
     if ( !module )
     {
@@ -72,6 +75,7 @@ ModulePtr loadModule( MEMOFFSET_64 offset )
 ModuleImp::ModuleImp(MEMOFFSET_64 offset )
 {
     m_base = findModuleBase( addr64(offset) );
+    m_processId = getCurrentProcessId();
     m_name = getModuleName( m_base );
     m_noSymbols = true;
     fillFields();
@@ -218,11 +222,58 @@ std::wstring ModuleImp::getSymFile()
 void ModuleImp::reloadSymbols()
 {
     m_symSession.reset();
+    invalidateFieldTypes();
+    ProcessMonitor::resetTypeCache(m_base, m_processId);
+    ProcessMonitor::resetFrameScopes(m_base, m_processId);
+    ProcessMonitor::resetSymbolIndex(m_base, m_processId);
     getSymSession();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
+void ModuleImp::resetSymbols()
+{
+    m_symSession.reset();
+    invalidateFieldTypes();
+    ProcessMonitor::resetTypeCache(m_base, m_processId);
+    ProcessMonitor::resetFrameScopes(m_base, m_processId);
+    ProcessMonitor::resetSymbolIndex(m_base, m_processId);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypeInfoPtr ModuleImp::getTypeByName(const std::wstring &typeName)
+{
+    TypeInfoCachePtr  typeCache = ProcessMonitor::getTypeCache();
+
+    TypeInfoPtr  typeInfo;
+
+    if (typeCache->lookup(m_base, typeName, typeInfo))
+    {
+        if (!typeInfo)
+            throw SymbolException(L'\'' + typeName + L"' - symbol not found");
+
+        return typeInfo;
+    }
+
+    try
+    {
+        typeInfo = loadType(getSymbolScope(), typeName);
+    }
+    catch (SymbolException&)
+    {
+        // failed lookups are remembered until the module symbols are reset
+        typeCache->insert(m_base, typeName, TypeInfoPtr());
+        throw;
+    }
+
+    typeCache->insert(m_base, typeName, typeInfo);
+
+    return typeInfo;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 SymbolPtr ModuleImp::getSymbolByVa( MEMOFFSET_64 offset,  MEMDISPLACEMENT* displacemnt )
 {
     return getSymbolByVa( offset, SymTagNull, displacemnt );
@@ -704,11 +755,63 @@ ScopePtr ModuleImp::getScope()
 //}
 ///////////////////////////////////////////////////////////////////////////////
 
+void enableSymbolIndex( bool enable )
+{
+    ProcessMonitor::enableSymbolIndex( enable );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool isSymbolIndexEnabled()
+{
+    return ProcessMonitor::isSymbolIndexEnabled();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 MEMOFFSET_64 findModuleBySymbol( const std::wstring &symbolName )
 {
+    SymbolNameIndexPtr  symbolIndex = ProcessMonitor::getSymbolIndex();
+
     std::vector<MEMOFFSET_64>   moduleList = getModuleBasesList();
 
     std::vector<MEMOFFSET_64>::const_iterator it;
+
+    MEMOFFSET_64  moduleBase;
+
+    if ( symbolIndex )
+    {
+        // modules loaded since the last lookup are added to the index
+        for ( it = moduleList.begin(); it != moduleList.end(); ++it )
+        {
+            if ( symbolIndex->isModuleIndexed( *it ) )
+                continue;
+
+            try {
+                ModulePtr  module = loadModule( *it );
+                SymbolPtr  symbolScope = module->getSymbolScope();
+                symbolIndex->insertModule( *it, symbolScope, module->isSymbolLoaded() );
+            }
+            catch( SymbolException& )
+            {}
+        }
+
+        // the first module defining the name wins: the found one is taken only
+        // if all modules before it are completely indexed
+        if ( symbolIndex->find( symbolName, moduleBase ) )
+        {
+            for ( it = moduleList.begin(); it != moduleList.end() && *it != moduleBase; ++it )
+            {
+                if ( !symbolIndex->isModuleComplete( *it ) )
+                    break;
+            }
+
+            if ( it != moduleList.end() && *it == moduleBase )
+                return moduleBase;
+        }
+    }
+
+    // ambiguous names, complex type names and so on
     for ( it = moduleList.begin(); it != moduleList.end(); ++it )
     {
         ModulePtr  module = loadModule( *it );
@@ -302,10 +302,7 @@ protected:
         reloadSymbols();
 
     void
-        resetSymbols()
-    {
-        m_symSession.reset();
-    }
+        resetSymbols();
 
     bool isSymbolLoaded() const
     {
@@ -326,10 +323,7 @@ protected:
 
     size_t getSymbolSize(const std::wstring &symName);
 
-    TypeInfoPtr getTypeByName(const std::wstring &typeName)
-    {
-        return loadType(getSymbolScope(), typeName);
-    }
+    TypeInfoPtr getTypeByName(const std::wstring &typeName);
 
     TypedVarPtr getTypedVarByAddr( MEMOFFSET_64 offset );
     TypedVarPtr getTypedVarByName( const std::wstring &symName );
@@ -380,6 +374,7 @@ protected:
     std::wstring  m_name;
     std::wstring  m_imageName;
     MEMOFFSET_64  m_base;
+    PROCESS_DEBUG_ID  m_processId;
     size_t  m_size;
     unsigned long  m_timeDataStamp;
     unsigned long  m_checkSum;
@@ -0,0 +1,710 @@
+#include "stdafx.h"
+
+#include <algorithm>
+
+#include "kdlib/exceptions.h"
+
+#include "net/climetadata.h"
+
+namespace kdlib {
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+
+const std::uint16_t  imageDosSignature = 0x5A4D;        // MZ
+const std::uint32_t  imageNtSignature = 0x00004550;     // PE00
+const std::uint16_t  imageNtOptionalHdr32Magic = 0x10B;
+const std::uint16_t  imageNtOptionalHdr64Magic = 0x20B;
+const std::uint32_t  imageDirectoryEntryComDescriptor = 14;
+const std::uint32_t  metaDataSignature = 0x424A5342;    // BSJB
+
+const unsigned char  heapStringsWide = 0x01;
+const unsigned char  heapGuidWide = 0x02;
+const unsigned char  heapBlobWide = 0x04;
+const unsigned char  heapExtraData = 0x40;
+
+enum MetaDataTable {
+    ModuleTable, TypeRefTable, TypeDefTable, FieldPtrTable, FieldTable, MethodPtrTable,
+    MethodDefTable, ParamPtrTable, ParamTable, InterfaceImplTable, MemberRefTable,
+    ConstantTable, CustomAttributeTable, FieldMarshalTable, DeclSecurityTable,
+    ClassLayoutTable, FieldLayoutTable, StandAloneSigTable, EventMapTable, EventPtrTable,
+    EventTable, PropertyMapTable, PropertyPtrTable, PropertyTable, MethodSemanticsTable,
+    MethodImplTable, ModuleRefTable, TypeSpecTable, ImplMapTable, FieldRVATable,
+    EncLogTable, EncMapTable, AssemblyTable, AssemblyProcessorTable, AssemblyOSTable,
+    AssemblyRefTable, AssemblyRefProcessorTable, AssemblyRefOSTable, FileTable,
+    ExportedTypeTable, ManifestResourceTable, NestedClassTable, GenericParamTable,
+    MethodSpecTable, GenericParamConstraintTable,
+    MetaDataTableCount,
+    MaxMetaDataTables = 64
+};
+
+enum CodedIndex {
+    TypeDefOrRef, HasConstant, HasCustomAttribute, HasFieldMarshal, HasDeclSecurity,
+    MemberRefParent, HasSemantics, MethodDefOrRef, MemberForwarded, Implementation,
+    CustomAttributeType, ResolutionScope, TypeOrMethodDef,
+    CodedIndexCount
+};
+
+// column kinds: a table index is the table number, a coded index is codedColumn + CodedIndex
+enum ColumnKind {
+    Fixed2 = -2,
+    Fixed4 = -4,
+    StringColumn = -10,
+    GuidColumn = -11,
+    BlobColumn = -12,
+    codedColumn = 0x100
+};
+
+#define CODED(index) (codedColumn + index)
+
+const std::vector<int>  codedIndexTables[CodedIndexCount] = {
+    { TypeDefTable, TypeRefTable, TypeSpecTable },
+    { FieldTable, ParamTable, PropertyTable },
+    { MethodDefTable, FieldTable, TypeRefTable, TypeDefTable, ParamTable, InterfaceImplTable,
+      MemberRefTable, ModuleTable, DeclSecurityTable, PropertyTable, EventTable,
+      StandAloneSigTable, ModuleRefTable, TypeSpecTable, AssemblyTable, AssemblyRefTable,
+      FileTable, ExportedTypeTable, ManifestResourceTable, GenericParamTable,
+      GenericParamConstraintTable, MethodSpecTable },
+    { FieldTable, ParamTable },
+    { TypeDefTable, MethodDefTable, AssemblyTable },
+    { TypeDefTable, TypeRefTable, ModuleRefTable, MethodDefTable, TypeSpecTable },
+    { EventTable, PropertyTable },
+    { MethodDefTable, MemberRefTable },
+    { FieldTable, MethodDefTable },
+    { FileTable, AssemblyRefTable, ExportedTypeTable },
+    { -1, -1, MethodDefTable, MemberRefTable, -1 },
+    { ModuleTable, ModuleRefTable, AssemblyRefTable, TypeRefTable },
+    { TypeDefTable, MethodDefTable }
+};
+
+// ECMA-335 II.22
+const std::vector<int>  tableColumns[MetaDataTableCount] = {
+    { Fixed2, StringColumn, GuidColumn, GuidColumn, GuidColumn },                   // Module
+    { CODED(ResolutionScope), StringColumn, StringColumn },                         // TypeRef
+    { Fixed4, StringColumn, StringColumn, CODED(TypeDefOrRef), FieldTable, MethodDefTable }, // TypeDef
+    { FieldTable },                                                                 // FieldPtr
+    { Fixed2, StringColumn, BlobColumn },                                           // Field
+    { MethodDefTable },                                                             // MethodPtr
+    { Fixed4, Fixed2, Fixed2, StringColumn, BlobColumn, ParamTable },               // MethodDef
+    { ParamTable },                                                                 // ParamPtr
+    { Fixed2, Fixed2, StringColumn },                                               // Param
+    { TypeDefTable, CODED(TypeDefOrRef) },                                          // InterfaceImpl
+    { CODED(MemberRefParent), StringColumn, BlobColumn },                           // MemberRef
+    { Fixed2, CODED(HasConstant), BlobColumn },                                     // Constant
+    { CODED(HasCustomAttribute), CODED(CustomAttributeType), BlobColumn },          // CustomAttribute
+    { CODED(HasFieldMarshal), BlobColumn },                                         // FieldMarshal
+    { Fixed2, CODED(HasDeclSecurity), BlobColumn },                                 // DeclSecurity
+    { Fixed2, Fixed4, TypeDefTable },                                               // ClassLayout
+    { Fixed4, FieldTable },                                                         // FieldLayout
+    { BlobColumn },                                                                 // StandAloneSig
+    { TypeDefTable, EventTable },                                                   // EventMap
+    { EventTable },                                                                 // EventPtr
+    { Fixed2, StringColumn, CODED(TypeDefOrRef) },                                  // Event
+    { TypeDefTable, PropertyTable },                                                // PropertyMap
+    { PropertyTable },                                                              // PropertyPtr
+    { Fixed2, StringColumn, BlobColumn },                                           // Property
+    { Fixed2, MethodDefTable, CODED(HasSemantics) },                                // MethodSemantics
+    { TypeDefTable, CODED(MethodDefOrRef), CODED(MethodDefOrRef) },                 // MethodImpl
+    { StringColumn },                                                               // ModuleRef
+    { BlobColumn },                                                                 // TypeSpec
+    { Fixed2, CODED(MemberForwarded), StringColumn, ModuleRefTable },               // ImplMap
+    { Fixed4, FieldTable },                                                         // FieldRVA
+    { Fixed4, Fixed4 },                                                             // EncLog
+    { Fixed4 },                                                                     // EncMap
+    { Fixed4, Fixed2, Fixed2, Fixed2, Fixed2, Fixed4, BlobColumn, StringColumn, StringColumn }, // Assembly
+    { Fixed4 },                                                                     // AssemblyProcessor
+    { Fixed4, Fixed4, Fixed4 },                                                     // AssemblyOS
+    { Fixed2, Fixed2, Fixed2, Fixed2, Fixed4, BlobColumn, StringColumn, StringColumn, BlobColumn }, // AssemblyRef
+    { Fixed4, AssemblyRefTable },                                                   // AssemblyRefProcessor
+    { Fixed4, Fixed4, Fixed4, AssemblyRefTable },                                   // AssemblyRefOS
+    { Fixed4, StringColumn, BlobColumn },                                           // File
+    { Fixed4, Fixed4, StringColumn, StringColumn, CODED(Implementation) },          // ExportedType
+    { Fixed4, Fixed4, StringColumn, CODED(Implementation) },                        // ManifestResource
+    { TypeDefTable, TypeDefTable },                                                 // NestedClass
+    { Fixed2, Fixed2, CODED(TypeOrMethodDef), StringColumn },                       // GenericParam
+    { CODED(MethodDefOrRef), BlobColumn },                                          // MethodSpec
+    { GenericParamTable, CODED(TypeDefOrRef) }                                      // GenericParamConstraint
+};
+
+#undef CODED
+
+///////////////////////////////////////////////////////////////////////////////
+
+void throwInvalidMetaData()
+{
+    throw DbgException("invalid CLI metadata");
+}
+
+template <typename T>
+T readValue(const std::vector<unsigned char>& buffer, size_t offset)
+{
+    if ( offset > buffer.size() || buffer.size() - offset < sizeof(T) )
+        throwInvalidMetaData();
+
+    T  value = 0;
+    for ( size_t i = 0; i < sizeof(T); ++i )
+        value |= static_cast<T>(buffer[offset + i]) << (8 * i);
+
+    return value;
+}
+
+size_t rvaToOffset(const std::vector<unsigned char>& image, size_t sections, size_t numberOfSections, std::uint32_t rva, bool mappedImage)
+{
+    if ( mappedImage )
+        return rva;
+
+    for ( size_t i = 0; i < numberOfSections; ++i )
+    {
+        size_t  section = sections + i * 40;
+
+        std::uint32_t  virtualSize = readValue<std::uint32_t>(image, section + 8);
+        std::uint32_t  virtualAddress = readValue<std::uint32_t>(image, section + 12);
+        std::uint32_t  sizeOfRawData = readValue<std::uint32_t>(image, section + 16);
+        std::uint32_t  pointerToRawData = readValue<std::uint32_t>(image, section + 20);
+
+        if ( rva >= virtualAddress && rva - virtualAddress < std::max(virtualSize, sizeOfRawData) )
+            return rva - virtualAddress + pointerToRawData;
+    }
+
+    throwInvalidMetaData();
+    return 0;
+}
+
+std::wstring utf8ToWStr(const unsigned char* str, size_t length)
+{
+    std::wstring  wstr;
+    wstr.reserve(length);
+
+    for ( size_t i = 0; i < length; )
+    {
+        std::uint32_t  ch = str[i++];
+        size_t  tail = 0;
+
+        if ( ch >= 0xF0 )
+        {
+            ch &= 0x07;
+            tail = 3;
+        }
+        else if ( ch >= 0xE0 )
+        {
+            ch &= 0x0F;
+            tail = 2;
+        }
+        else if ( ch >= 0xC0 )
+        {
+            ch &= 0x1F;
+            tail = 1;
+        }
+
+        for ( ; tail > 0 && i < length; --tail )
+            ch = ( ch << 6 ) | ( str[i++] & 0x3F );
+
+        if ( sizeof(wchar_t) == 2 && ch > 0xFFFF )
+        {
+            ch -= 0x10000;
+            wstr += static_cast<wchar_t>( 0xD800 + ( ch >> 10 ) );
+            wstr += static_cast<wchar_t>( 0xDC00 + ( ch & 0x3FF ) );
+        }
+        else
+        {
+            wstr += static_cast<wchar_t>(ch);
+        }
+    }
+
+    return wstr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+CliMetaData::CliMetaData(const std::vector<unsigned char>& image, bool mappedImage)
+{
+    if ( readValue<std::uint16_t>(image, 0) != imageDosSignature )
+        throwInvalidMetaData();
+
+    size_t  ntHeaders = readValue<std::uint32_t>(image, 0x3C);
+    if ( readValue<std::uint32_t>(image, ntHeaders) != imageNtSignature )
+        throwInvalidMetaData();
+
+    size_t  fileHeader = ntHeaders + 4;
+    size_t  numberOfSections = readValue<std::uint16_t>(image, fileHeader + 2);
+    size_t  sizeOfOptionalHeader = readValue<std::uint16_t>(image, fileHeader + 16);
+
+    size_t  optionalHeader = fileHeader + 20;
+    size_t  dataDirectory = 0;
+
+    switch ( readValue<std::uint16_t>(image, optionalHeader) )
+    {
+    case imageNtOptionalHdr32Magic:
+        dataDirectory = optionalHeader + 92;
+        break;
+
+    case imageNtOptionalHdr64Magic:
+        dataDirectory = optionalHeader + 108;
+        break;
+
+    default:
+        throwInvalidMetaData();
+    }
+
+    if ( readValue<std::uint32_t>(image, dataDirectory) <= imageDirectoryEntryComDescriptor )
+        throwInvalidMetaData();
+
+    std::uint32_t  corHeaderRva = readValue<std::uint32_t>(image, dataDirectory + 4 + imageDirectoryEntryComDescriptor * 8);
+    if ( corHeaderRva == 0 )
+        throwInvalidMetaData();
+
+    size_t  sections = optionalHeader + sizeOfOptionalHeader;
+    size_t  corHeader = rvaToOffset(image, sections, numberOfSections, corHeaderRva, mappedImage);
+
+    std::uint32_t  metaDataRva = readValue<std::uint32_t>(image, corHeader + 8);
+    std::uint32_t  metaDataSize = readValue<std::uint32_t>(image, corHeader + 12);
+    size_t  metaData = rvaToOffset(image, sections, numberOfSections, metaDataRva, mappedImage);
+
+    if ( metaData > image.size() || image.size() - metaData < metaDataSize )
+        throwInvalidMetaData();
+
+    // the rest of the image is not needed
+    m_metaData.assign(image.begin() + metaData, image.begin() + metaData + metaDataSize);
+
+    readMetaDataRoot();
+    readTables();
+    buildTypeNames();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void CliMetaData::readMetaDataRoot()
+{
+    if ( readValue<std::uint32_t>(m_metaData, 0) != metaDataSignature )
+        throwInvalidMetaData();
+
+    size_t  versionLength = readValue<std::uint32_t>(m_metaData, 12);
+    size_t  offset = 16 + ( ( versionLength + 3 ) & ~3 );
+
+    size_t  numberOfStreams = readValue<std::uint16_t>(m_metaData, offset + 2);
+    offset += 4;
+
+    m_stringsOffset = m_stringsSize = 0;
+    m_blobOffset = m_blobSize = 0;
+    m_tablesOffset = m_tablesSize = 0;
+
+    for ( size_t i = 0; i < numberOfStreams; ++i )
+    {
+        size_t  streamOffset = readValue<std::uint32_t>(m_metaData, offset);
+        size_t  streamSize = readValue<std::uint32_t>(m_metaData, offset + 4);
+
+        if ( streamOffset > m_metaData.size() || m_metaData.size() - streamOffset < streamSize )
+            throwInvalidMetaData();
+
+        offset += 8;
+
+        std::string  streamName;
+        for ( char ch; ( ch = readValue<char>(m_metaData, offset + streamName.size()) ) != 0; )
+            streamName += ch;
+
+        offset += ( streamName.size() + 4 ) & ~3;
+
+        if ( streamName == "#~" || streamName == "#-" )
+        {
+            m_tablesOffset = streamOffset;
+            m_tablesSize = streamSize;
+        }
+        else if ( streamName == "#Strings" )
+        {
+            m_stringsOffset = streamOffset;
+            m_stringsSize = streamSize;
+        }
+        else if ( streamName == "#Blob" )
+        {
+            m_blobOffset = streamOffset;
+            m_blobSize = streamSize;
+        }
+    }
+
+    if ( m_tablesSize == 0 || m_stringsSize == 0 )
+        throwInvalidMetaData();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void CliMetaData::readTables()
+{
+    unsigned char  heapSizes = readValue<unsigned char>(m_metaData, m_tablesOffset + 6);
+    std::uint64_t  validTables = readValue<std::uint64_t>(m_metaData, m_tablesOffset + 8);
+
+    size_t  offset = m_tablesOffset + 24;
+
+    std::uint32_t  rows[MaxMetaDataTables] = {};
+
+    for ( size_t i = 0; i < MaxMetaDataTables; ++i )
+    {
+        if ( ( validTables >> i ) & 1 )
+        {
+            rows[i] = readValue<std::uint32_t>(m_metaData, offset);
+            offset += 4;
+        }
+    }
+
+    if ( heapSizes & heapExtraData )
+        offset += 4;
+
+    size_t  codedIndexSize[CodedIndexCount];
+
+    for ( size_t i = 0; i < CodedIndexCount; ++i )
+    {
+        const std::vector<int>&  tables = codedIndexTables[i];
+
+        size_t  tagBits = 0;
+        while ( ( size_t(1) << tagBits ) < tables.size() )
+            ++tagBits;
+
+        std::uint32_t  maxRows = 0;
+        for ( size_t j = 0; j < tables.size(); ++j )
+        {
+            if ( tables[j] >= 0 )
+                maxRows = std::max(maxRows, rows[tables[j]]);
+        }
+
+        codedIndexSize[i] = maxRows < ( std::uint32_t(1) << ( 16 - tagBits ) ) ? 2 : 4;
+    }
+
+    std::vector<size_t>  columnSizes[MetaDataTableCount];
+    size_t  tableOffsets[MetaDataTableCount];
+
+    for ( size_t i = 0; i < MetaDataTableCount; ++i )
+    {
+        size_t  rowSize = 0;
+
+        for ( size_t j = 0; j < tableColumns[i].size(); ++j )
+        {
+            int  column = tableColumns[i][j];
+            size_t  columnSize;
+
+            if ( column >= codedColumn )
+                columnSize = codedIndexSize[column - codedColumn];
+            else if ( column >= 0 )
+                columnSize = rows[column] < 0x10000 ? 2 : 4;
+            else if ( column == StringColumn )
+                columnSize = heapSizes & heapStringsWide ? 4 : 2;
+            else if ( column == GuidColumn )
+                columnSize = heapSizes & heapGuidWide ? 4 : 2;
+            else if ( column == BlobColumn )
+                columnSize = heapSizes & heapBlobWide ? 4 : 2;
+            else
+                columnSize = -column;
+
+            columnSizes[i].push_back(columnSize);
+            rowSize += columnSize;
+        }
+
+        tableOffsets[i] = offset;
+        offset += rowSize * rows[i];
+    }
+
+    if ( offset - m_tablesOffset > m_tablesSize )
+        throwInvalidMetaData();
+
+    const std::vector<size_t>&  typeDefColumns = columnSizes[TypeDefTable];
+    m_typeDefs.resize(rows[TypeDefTable]);
+
+    for ( size_t i = 0, row = tableOffsets[TypeDefTable]; i < m_typeDefs.size(); ++i )
+    {
+        TypeDefRow&  typeDef = m_typeDefs[i];
+
+        typeDef.flags = readIndex(row, typeDefColumns[0]);
+        row += typeDefColumns[0];
+        typeDef.name = readIndex(row, typeDefColumns[1]);
+        row += typeDefColumns[1];
+        typeDef.nameSpace = readIndex(row, typeDefColumns[2]);
+        row += typeDefColumns[2] + typeDefColumns[3];
+        typeDef.fieldList = readIndex(row, typeDefColumns[4]);
+        row += typeDefColumns[4] + typeDefColumns[5];
+        typeDef.enclosing = 0;
+    }
+
+    const std::vector<size_t>&  fieldColumns = columnSizes[FieldTable];
+    m_fields.resize(rows[FieldTable]);
+
+    for ( size_t i = 0, row = tableOffsets[FieldTable]; i < m_fields.size(); ++i )
+    {
+        FieldRow&  field = m_fields[i];
+
+        field.flags = static_cast<std::uint16_t>( readIndex(row, fieldColumns[0]) );
+        row += fieldColumns[0];
+        field.name = readIndex(row, fieldColumns[1]);
+        row += fieldColumns[1];
+        field.signature = readIndex(row, fieldColumns[2]);
+        row += fieldColumns[2];
+    }
+
+    const std::vector<size_t>&  fieldPtrColumns = columnSizes[FieldPtrTable];
+    m_fieldPtrs.resize(rows[FieldPtrTable]);
+
+    for ( size_t i = 0, row = tableOffsets[FieldPtrTable]; i < m_fieldPtrs.size(); ++i )
+    {
+        m_fieldPtrs[i] = readIndex(row, fieldPtrColumns[0]);
+        row += fieldPtrColumns[0];
+    }
+
+    const std::vector<size_t>&  nestedColumns = columnSizes[NestedClassTable];
+
+    for ( size_t i = 0, row = tableOffsets[NestedClassTable]; i < rows[NestedClassTable]; ++i )
+    {
+        std::uint32_t  nested = readIndex(row, nestedColumns[0]);
+        row += nestedColumns[0];
+        std::uint32_t  enclosing = readIndex(row, nestedColumns[1]);
+        row += nestedColumns[1];
+
+        if ( nested == 0 || nested > m_typeDefs.size() || enclosing > m_typeDefs.size() )
+            throwInvalidMetaData();
+
+        m_typeDefs[nested - 1].enclosing = enclosing;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void CliMetaData::buildTypeNames()
+{
+    m_typeNames.resize(m_typeDefs.size());
+
+    for ( size_t i = 0; i < m_typeDefs.size(); ++i )
+    {
+        // the enclosing types are named first, the depth of the chain is limited
+        // by the count of the types, so a broken NestedClass table can not loop
+        std::vector<size_t>  chain;
+
+        for ( size_t rid = i + 1; rid != 0 && m_typeNames[rid - 1].empty(); rid = m_typeDefs[rid - 1].enclosing )
+        {
+            if ( chain.size() > m_typeDefs.size() )
+                throwInvalidMetaData();
+
+            chain.push_back(rid);
+        }
+
+        for ( std::vector<size_t>::reverse_iterator it = chain.rbegin(); it != chain.rend(); ++it )
+        {
+            const TypeDefRow&  typeDef = m_typeDefs[*it - 1];
+
+            std::wstring  typeName = getString(typeDef.name);
+
+            std::wstring  nameSpace = getString(typeDef.nameSpace);
+            if ( !nameSpace.empty() )
+                typeName = nameSpace + L'.' + typeName;
+
+            if ( typeDef.enclosing != 0 )
+                typeName = m_typeNames[typeDef.enclosing - 1] + L'.' + typeName;
+
+            m_typeNames[*it - 1] = typeName;
+        }
+    }
+
+    // a top level type wins over a nested type with the same full name
+    m_typeNameMap.reserve(m_typeDefs.size());
+
+    for ( size_t i = 0; i < m_typeDefs.size(); ++i )
+    {
+        if ( m_typeDefs[i].enclosing == 0 )
+            m_typeNameMap.insert( std::make_pair(m_typeNames[i], typeDefToken | static_cast<Token>(i + 1)) );
+    }
+
+    for ( size_t i = 0; i < m_typeDefs.size(); ++i )
+    {
+        if ( m_typeDefs[i].enclosing != 0 )
+            m_typeNameMap.insert( std::make_pair(m_typeNames[i], typeDefToken | static_cast<Token>(i + 1)) );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+CliMetaData::TokenList CliMetaData::getTypeDefs() const
+{
+    TokenList  typeDefs;
+
+    if ( m_typeDefs.size() > 1 )
+    {
+        typeDefs.reserve(m_typeDefs.size() - 1);
+
+        for ( size_t i = 2; i <= m_typeDefs.size(); ++i )
+            typeDefs.push_back( typeDefToken | static_cast<Token>(i) );
+    }
+
+    return typeDefs;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool CliMetaData::isTypeDef(Token typeDef) const
+{
+    Token  rid = typeDef & 0x00FFFFFF;
+
+    return ( typeDef & 0xFF000000 ) == typeDefToken && rid != 0 && rid <= m_typeDefs.size();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const std::wstring& CliMetaData::getTypeName(Token typeDef) const
+{
+    getTypeDefRow(typeDef);
+
+    return m_typeNames[ ( typeDef & 0x00FFFFFF ) - 1 ];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::uint32_t CliMetaData::getTypeFlags(Token typeDef) const
+{
+    return getTypeDefRow(typeDef).flags;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+CliMetaData::Token CliMetaData::getEnclosingType(Token typeDef) const
+{
+    std::uint32_t  enclosing = getTypeDefRow(typeDef).enclosing;
+
+    return enclosing != 0 ? typeDefToken | enclosing : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool CliMetaData::findTypeDef(const std::wstring& typeName, Token& typeDef) const
+{
+    std::unordered_map<std::wstring, Token>::const_iterator  it = m_typeNameMap.find(typeName);
+    if ( it == m_typeNameMap.end() )
+        return false;
+
+    typeDef = it->second;
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+CliMetaData::TokenList CliMetaData::getFields(Token typeDef) const
+{
+    size_t  rid = typeDef & 0x00FFFFFF;
+
+    getTypeDefRow(typeDef);
+
+    // the field list of a type lasts up to the field list of the next type
+    size_t  fieldCount = m_fieldPtrs.empty() ? m_fields.size() : m_fieldPtrs.size();
+    size_t  fieldBegin = std::max<size_t>(m_typeDefs[rid - 1].fieldList, 1);
+    size_t  fieldEnd = rid < m_typeDefs.size() ? m_typeDefs[rid].fieldList : fieldCount + 1;
+
+    fieldEnd = std::min(fieldEnd, fieldCount + 1);
+
+    TokenList  fields;
+
+    for ( size_t i = fieldBegin; i < fieldEnd; ++i )
+        fields.push_back( fieldToken | ( m_fieldPtrs.empty() ? static_cast<Token>(i) : m_fieldPtrs[i - 1] ) );
+
+    return fields;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::wstring CliMetaData::getFieldName(Token fieldDef) const
+{
+    return getString( getFieldRow(fieldDef).name );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::uint16_t CliMetaData::getFieldFlags(Token fieldDef) const
+{
+    return getFieldRow(fieldDef).flags;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const unsigned char* CliMetaData::getFieldSignature(Token fieldDef, size_t& sigSize) const
+{
+    size_t  offset = getFieldRow(fieldDef).signature;
+
+    if ( offset >= m_blobSize )
+        throwInvalidMetaData();
+
+    offset += m_blobOffset;
+
+    // ECMA-335 II.24.2.4: the compressed length of the blob
+    unsigned char  firstByte = m_metaData[offset];
+
+    if ( ( firstByte & 0x80 ) == 0 )
+    {
+        sigSize = firstByte;
+        offset += 1;
+    }
+    else if ( ( firstByte & 0xC0 ) == 0x80 )
+    {
+        sigSize = ( ( firstByte & 0x3F ) << 8 ) | readValue<unsigned char>(m_metaData, offset + 1);
+        offset += 2;
+    }
+    else
+    {
+        sigSize = ( ( firstByte & 0x1F ) << 24 ) |
+            ( readValue<unsigned char>(m_metaData, offset + 1) << 16 ) |
+            ( readValue<unsigned char>(m_metaData, offset + 2) << 8 ) |
+            readValue<unsigned char>(m_metaData, offset + 3);
+        offset += 4;
+    }
+
+    if ( offset + sigSize > m_blobOffset + m_blobSize )
+        throwInvalidMetaData();
+
+    return &m_metaData[offset];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const CliMetaData::TypeDefRow& CliMetaData::getTypeDefRow(Token typeDef) const
+{
+    if ( !isTypeDef(typeDef) )
+        throw DbgException("invalid TypeDef token");
+
+    return m_typeDefs[ ( typeDef & 0x00FFFFFF ) - 1 ];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const CliMetaData::FieldRow& CliMetaData::getFieldRow(Token fieldDef) const
+{
+    Token  rid = fieldDef & 0x00FFFFFF;
+
+    if ( ( fieldDef & 0xFF000000 ) != fieldToken || rid == 0 || rid > m_fields.size() )
+        throw DbgException("invalid FieldDef token");
+
+    return m_fields[rid - 1];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::wstring CliMetaData::getString(std::uint32_t offset) const
+{
+    if ( offset >= m_stringsSize )
+        throwInvalidMetaData();
+
+    const unsigned char*  str = &m_metaData[m_stringsOffset + offset];
+    const unsigned char*  strEnd = &m_metaData[0] + m_stringsOffset + m_stringsSize;
+
+    const unsigned char*  nullChar = std::find(str, strEnd, 0);
+    if ( nullChar == strEnd )
+        throwInvalidMetaData();
+
+    return utf8ToWStr(str, nullChar - str);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::uint32_t CliMetaData::readIndex(size_t offset, size_t size) const
+{
+    return size == 2 ? readValue<std::uint16_t>(m_metaData, offset) : readValue<std::uint32_t>(m_metaData, offset);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
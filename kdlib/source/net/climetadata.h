@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+class CliMetaData;
+typedef boost::shared_ptr<CliMetaData>  CliMetaDataPtr;
+
+// ECMA-335 metadata read directly from the bytes of a managed PE image. Only
+// the TypeDef, Field and NestedClass tables are decoded, the rest of the
+// metadata is left to IMetaDataImport. The reader does not use the CLR
+// debugging API and throws DbgException if the image is not a valid one
+class CliMetaData : private boost::noncopyable
+{
+public:
+
+    typedef std::uint32_t  Token;
+    typedef std::vector<Token>  TokenList;
+
+    static const Token  typeDefToken = 0x02000000;
+    static const Token  fieldToken = 0x04000000;
+
+    // mappedImage is true for a loaded image: RVA is the offset in the image
+    CliMetaData(const std::vector<unsigned char>& image, bool mappedImage);
+
+    // all type definitions except the <Module> pseudo type
+    TokenList getTypeDefs() const;
+
+    bool isTypeDef(Token typeDef) const;
+
+    // the full name: "Namespace.Name" or "Namespace.Enclosing.Name"
+    const std::wstring& getTypeName(Token typeDef) const;
+
+    std::uint32_t getTypeFlags(Token typeDef) const;
+
+    Token getEnclosingType(Token typeDef) const;
+
+    bool findTypeDef(const std::wstring& typeName, Token& typeDef) const;
+
+    TokenList getFields(Token typeDef) const;
+
+    std::wstring getFieldName(Token fieldDef) const;
+
+    std::uint16_t getFieldFlags(Token fieldDef) const;
+
+    const unsigned char* getFieldSignature(Token fieldDef, size_t& sigSize) const;
+
+private:
+
+    struct TypeDefRow {
+        std::uint32_t  flags;
+        std::uint32_t  name;
+        std::uint32_t  nameSpace;
+        std::uint32_t  fieldList;
+        std::uint32_t  enclosing;
+    };
+
+    struct FieldRow {
+        std::uint16_t  flags;
+        std::uint32_t  name;
+        std::uint32_t  signature;
+    };
+
+    void readMetaDataRoot();
+
+    void readTables();
+
+    void buildTypeNames();
+
+    const TypeDefRow& getTypeDefRow(Token typeDef) const;
+
+    const FieldRow& getFieldRow(Token fieldDef) const;
+
+    std::wstring getString(std::uint32_t offset) const;
+
+    std::uint32_t readIndex(size_t offset, size_t size) const;
+
+    std::vector<unsigned char>  m_metaData;  // the metadata root and the streams
+
+    size_t  m_stringsOffset;
+    size_t  m_stringsSize;
+    size_t  m_blobOffset;
+    size_t  m_blobSize;
+    size_t  m_tablesOffset;
+    size_t  m_tablesSize;
+
+    std::vector<TypeDefRow>  m_typeDefs;
+    std::vector<FieldRow>  m_fields;
+    std::vector<std::uint32_t>  m_fieldPtrs;  // only in the uncompressed ( #- ) tables
+    std::vector<std::wstring>  m_typeNames;
+
+    std::unordered_map<std::wstring, Token>  m_typeNameMap;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
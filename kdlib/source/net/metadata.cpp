@@ -1,39 +1,16 @@
 #include "stdafx.h"
 
 #include <boost/make_shared.hpp>
-#include <boost/regex.hpp>
+#include <boost/thread/lock_guard.hpp>
 
 #include <metahost.h>
 
+#include "kdlib/memaccess.h"
+
 #include "net/metadata.h"
 #include "net/nettype.h"
 
-
-///////////////////////////////////////////////////////////////////////////////
-
-namespace {
-
-///////////////////////////////////////////////////////////////////////////////
-
-const boost::wregex  r1(L"\\?");
-const boost::wregex  r2(L"\\*");
-const boost::wregex  r3(L"\\.");
-
-bool fnmatch( const std::wstring& pattern, const std::wstring& str)
-{
-    std::wstring mask = pattern;
-    mask = boost::regex_replace(mask, r1, L".");
-    mask = boost::regex_replace(mask, r2, L".*");
-    mask = boost::regex_replace(mask, r3, L"\\.");
-
-    boost::wsmatch  matchResult;
-    boost::wregex  regEx(mask);
-    return boost::regex_match(str, matchResult, regEx);
-}
-
-///////////////////////////////////////////////////////////////////////////////
-
-}
+#include "fnmatch.h"
 
 namespace kdlib {
 
@@ -47,6 +24,73 @@ MetaDataProvider::MetaDataProvider(ICorDebugModule* module)
     HRESULT  hres = module->GetMetaDataInterface(IID_IMetaDataImport, (IUnknown**)&m_metaDataImport);
     if (FAILED(hres))
         throw DbgException("Failed ICorDebugModule::GetMetaDataInterface");
+
+    m_metaData = g_netMgr->metaDataCache()->get(module, m_metaDataImport);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+CliMetaDataPtr MetaDataCache::get(ICorDebugModule* module, IMetaDataImport* metaDataImport)
+{
+    BOOL  isDynamic = FALSE;
+    HRESULT  hres = module->IsDynamic(&isDynamic);
+    if ( FAILED(hres) || isDynamic )
+        return CliMetaDataPtr();   // the metadata of a dynamic module grows
+
+    ImageKey  key;
+
+    hres = module->GetBaseAddress(&key.first);
+    if ( FAILED(hres) )
+        return CliMetaDataPtr();
+
+    hres = module->GetSize(&key.second);
+    if ( FAILED(hres) )
+        return CliMetaDataPtr();
+
+    Image  image;
+
+    hres = metaDataImport->GetScopeProps(NULL, 0, NULL, &image.mvid);
+    if ( FAILED(hres) )
+        return CliMetaDataPtr();
+
+    {
+        boost::lock_guard<boost::mutex>  l(m_lock);
+
+        ImageMap::const_iterator  it = m_images.find(key);
+        if ( it != m_images.end() && IsEqualGUID(it->second.mvid, image.mvid) )
+            return it->second.metaData;
+    }
+
+    // the image is read and parsed without the lock
+    CliMetaDataPtr  metaData;
+
+    try
+    {
+        std::vector<unsigned char>  bytes = loadBytes(key.first, key.second);
+
+        // an image loaded from a byte array is not mapped by sections
+        try
+        {
+            metaData = CliMetaDataPtr( new CliMetaData(bytes, true) );
+        }
+        catch (const DbgException&)
+        {
+            metaData = CliMetaDataPtr( new CliMetaData(bytes, false) );
+        }
+    }
+    catch (const DbgException&)
+    {
+        // a dump without the module image, the read is retried next time
+        return CliMetaDataPtr();
+    }
+
+    image.metaData = metaData;
+
+    boost::lock_guard<boost::mutex>  l(m_lock);
+
+    m_images[key] = image;
+
+    return metaData;
 }
 
 //TypeInfoPtr  MetaDataProvider::getTypeByToken(mdTypeDef typeDef)
@@ -54,34 +98,43 @@ MetaDataProvider::MetaDataProvider(ICorDebugModule* module)
 //    return TypeInfoPtr( new NetTypeClass( shared_from_this(), getTypeNameByToken(typeDef), typeDef ) );//}
 
 
-CorElementType MetaDataProvider::getFieldElementType(mdFieldDef fieldDef)
+void MetaDataProvider::getFieldSignature(mdFieldDef fieldDef, PCCOR_SIGNATURE& sigBlob, ULONG& sigBlobSize)
 {
-    std::vector<wchar_t>  fieldNameBuf(0x100);
-    ULONG  fieldNameLen;
-    DWORD  flags;
-    mdTypeDef  classTypeDef;
-    DWORD  valueFlag;
+    if ( m_metaData )
+    {
+        size_t  sigSize;
+        sigBlob = m_metaData->getFieldSignature(fieldDef, sigSize);
+        sigBlobSize = static_cast<ULONG>(sigSize);
+        return;
+    }
 
-    PCCOR_SIGNATURE  sigBlob;
-    ULONG  sigBlobSize;
+    mdTypeDef  classTypeDef;
 
     HRESULT  hres = m_metaDataImport->GetFieldProps(
         fieldDef,
         &classTypeDef,
-        &fieldNameBuf.front(),
-        fieldNameBuf.size(),
-        &fieldNameLen,
-        &flags,
+        NULL,
+        0,
+        NULL,
+        NULL,
         &sigBlob,
         &sigBlobSize,
-        &valueFlag,
+        NULL,
         NULL,
         NULL);
 
     if ( FAILED(hres) )
         throw DbgException("Failed IMetaDataImport::GetFieldProps");
+}
+
+CorElementType MetaDataProvider::getFieldElementType(mdFieldDef fieldDef)
+{
+    PCCOR_SIGNATURE  sigBlob;
+    ULONG  sigBlobSize;
 
-    ULONG callingConv = (CorCallingConvention)CorSigUncompressCallingConv(sigBlob);
+    getFieldSignature(fieldDef, sigBlob, sigBlobSize);
+
+    CorSigUncompressCallingConv(sigBlob);
 
     return CorSigUncompressElementType(sigBlob);
 
@@ -89,32 +142,12 @@ CorElementType MetaDataProvider::getFieldElementType(mdFieldDef fieldDef)
 
 CorElementType MetaDataProvider::getFieldSZArrayElementType(mdFieldDef fieldDef)
 {
-    std::vector<wchar_t>  fieldNameBuf(0x100);
-    ULONG  fieldNameLen;
-    DWORD  flags;
-    mdTypeDef  classTypeDef;
-    DWORD  valueFlag;
-
     PCCOR_SIGNATURE  sigBlob;
     ULONG  sigBlobSize;
 
-    HRESULT  hres = m_metaDataImport->GetFieldProps(
-        fieldDef,
-        &classTypeDef,
-        &fieldNameBuf.front(),
-        fieldNameBuf.size(),
-        &fieldNameLen,
-        &flags,
-        &sigBlob,
-        &sigBlobSize,
-        &valueFlag,
-        NULL,
-        NULL);
+    getFieldSignature(fieldDef, sigBlob, sigBlobSize);
 
-    if ( FAILED(hres) )
-        throw DbgException("Failed IMetaDataImport::GetFieldProps");
-
-    ULONG callingConv = (CorCallingConvention)CorSigUncompressCallingConv(sigBlob);
+    CorSigUncompressCallingConv(sigBlob);
 
     CorSigUncompressElementType(sigBlob);
 
@@ -124,30 +157,10 @@ CorElementType MetaDataProvider::getFieldSZArrayElementType(mdFieldDef fieldDef)
 
 mdTypeDef MetaDataProvider::getFieldClassToken(mdFieldDef fieldDef)
 {
-    std::vector<wchar_t>  fieldNameBuf(0x100);
-    ULONG  fieldNameLen;
-    DWORD  flags;
-    mdTypeDef  classTypeDef;
-    DWORD  valueFlag;
-
     PCCOR_SIGNATURE  sigBlob;
     ULONG  sigBlobSize;
 
-    HRESULT  hres = m_metaDataImport->GetFieldProps(
-        fieldDef,
-        &classTypeDef,
-        &fieldNameBuf.front(),
-        fieldNameBuf.size(),
-        &fieldNameLen,
-        &flags,
-        &sigBlob,
-        &sigBlobSize,
-        &valueFlag,
-        NULL,
-        NULL);
-
-    if ( FAILED(hres) )
-        throw DbgException("Failed IMetaDataImport::GetFieldProps");
+    getFieldSignature(fieldDef, sigBlob, sigBlobSize);
 
     CorSigUncompressCallingConv(sigBlob);
 
@@ -158,6 +171,9 @@ mdTypeDef MetaDataProvider::getFieldClassToken(mdFieldDef fieldDef)
 
 DWORD  MetaDataProvider::getFieldAttr(mdFieldDef fieldDef)
 {
+    if ( m_metaData )
+        return m_metaData->getFieldFlags(fieldDef);
+
     mdTypeDef  classTypeDef;
     DWORD  attr;
 
@@ -182,6 +198,9 @@ DWORD  MetaDataProvider::getFieldAttr(mdFieldDef fieldDef)
 
 std::wstring  MetaDataProvider::getFieldName(mdFieldDef fieldDef)
 {
+    if ( m_metaData )
+        return m_metaData->getFieldName(fieldDef);
+
     std::vector<wchar_t>  fieldNameBuf(0x100);
     ULONG  fieldNameLen;
 
@@ -208,6 +227,9 @@ std::wstring  MetaDataProvider::getFieldName(mdFieldDef fieldDef)
 
 std::wstring MetaDataProvider::getTypeNameByToken(mdTypeDef typeDef)
 {
+    if ( m_metaData )
+        return m_metaData->getTypeName(typeDef);
+
     std::vector<wchar_t>  typeNameBuf(0x100);
     ULONG  typeNameLength;
     DWORD  typeDefFlags;
@@ -248,6 +270,16 @@ std::wstring MetaDataProvider::getTypeNameByToken(mdTypeDef typeDef)
 mdTypeDef MetaDataProvider::getTypeTokenByName(const std::wstring& typeName)
 {
     mdTypeDef  typeDef;
+
+    if ( m_metaData )
+    {
+        CliMetaData::Token  token;
+        if ( !m_metaData->findTypeDef(typeName, token) )
+            throw DbgException("Failed IMetaDataImport::FindTypeDefByName");
+
+        return token;
+    }
+
     HRESULT  hres = m_metaDataImport->FindTypeDefByName(typeName.c_str(), 0, &typeDef);
     if (FAILED(hres) )
         throw DbgException("Failed IMetaDataImport::FindTypeDefByName");
@@ -260,6 +292,22 @@ TypeNameList  MetaDataProvider::getTypeNames(const std::wstring& mask)
 {
     HCORENUM  enumTypeDefs = NULL;
     TypeNameList  typeList;
+    GlobPattern  typeMask(mask);
+
+    if ( m_metaData )
+    {
+        CliMetaData::TokenList  typeDefs = m_metaData->getTypeDefs();
+
+        for ( CliMetaData::TokenList::iterator it = typeDefs.begin(); it != typeDefs.end(); ++it )
+        {
+            const std::wstring&  typeName = m_metaData->getTypeName(*it);
+
+            if ( typeMask.empty() || typeMask.match(typeName) )
+                typeList.push_back(typeName);
+        }
+
+        return typeList;
+    }
 
     auto enumCloseFn = [=](HCORENUM*){ if ( enumTypeDefs ) m_metaDataImport->CloseEnum(enumTypeDefs); };
     std::unique_ptr<HCORENUM, decltype(enumCloseFn)>  enumCloser(&enumTypeDefs, enumCloseFn);
@@ -278,7 +326,7 @@ TypeNameList  MetaDataProvider::getTypeNames(const std::wstring& mask)
 
         std::wstring  typeName = getTypeNameByToken(typeDef);
 
-        if ( mask.empty() || fnmatch(mask, typeName) )
+        if ( typeMask.empty() || typeMask.match(typeName) )
             typeList.push_back(typeName);
     } 
 
@@ -290,6 +338,16 @@ void MetaDataProvider::getFields(mdTypeDef typeDef, NetFieldList& fields)
     HCORENUM  enumFieldDefs = NULL;
 
     fields.clear();
+
+    if ( m_metaData )
+    {
+        CliMetaData::TokenList  fieldDefs = m_metaData->getFields(typeDef);
+
+        for ( CliMetaData::TokenList::iterator it = fieldDefs.begin(); it != fieldDefs.end(); ++it )
+            fields.push_back( std::make_pair( m_metaData->getFieldName(*it), *it) );
+
+        return;
+    }
  
     auto enumCloseFn = [=](HCORENUM*){ if ( enumFieldDefs ) m_metaDataImport->CloseEnum(enumFieldDefs); };
     std::unique_ptr<HCORENUM, decltype(enumCloseFn)>  enumCloser(&enumFieldDefs, enumCloseFn);
@@ -328,6 +386,9 @@ void MetaDataProvider::getFields(mdTypeDef typeDef, NetFieldList& fields)
 
 bool MetaDataProvider::isStaticField(mdFieldDef fieldDef)
 {
+    if ( m_metaData )
+        return (m_metaData->getFieldFlags(fieldDef) & CorFieldAttr::fdStatic) != 0;
+
     std::vector<wchar_t>  fieldNameBuf(0x100);
     ULONG  fieldNameLen;
 
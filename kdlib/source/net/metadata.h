@@ -1,9 +1,14 @@
 #pragma once
 
+#include <map>
+
 #include <boost/shared_ptr.hpp>
 #include <boost/enable_shared_from_this.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include "net/net.h"
+#include "net/climetadata.h"
 #include <cor.h>
 
 #include "kdlib/exceptions.h"
@@ -53,8 +58,37 @@ private:
 
     MetaDataProvider(ICorDebugModule* module);
 
+    void getFieldSignature(mdFieldDef fieldDef, PCCOR_SIGNATURE& sigBlob, ULONG& sigBlobSize);
+
     CComPtr<IMetaDataImport>  m_metaDataImport;
 
+    CliMetaDataPtr  m_metaData;  // NULL if the module image is not readable
+
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Metadata of the managed module images of a process. The images are read once,
+// the modules without a readable image are served by IMetaDataImport. A module
+// loaded at the place of an unloaded one is told apart by its MVID
+class MetaDataCache : private boost::noncopyable
+{
+public:
+
+    CliMetaDataPtr get(ICorDebugModule* module, IMetaDataImport* metaDataImport);
+
+private:
+
+    struct Image {
+        GUID  mvid;
+        CliMetaDataPtr  metaData;
+    };
+
+    typedef std::pair<CORDB_ADDRESS, ULONG32>  ImageKey;
+    typedef std::map<ImageKey, Image>  ImageMap;
+
+    boost::mutex  m_lock;
+    ImageMap  m_images;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -11,6 +11,8 @@
 #include "win/dbgmgr.h"
 
 #include "net.h"
+#include "nettype.h"
+#include "metadata.h"
 
 #pragma comment(lib, "mscoree.lib") 
 #pragma comment(lib, "corguids.lib")
@@ -32,6 +34,10 @@ public:
    
     ICorDebugProcess* targetProcess();
 
+    NetTypeCachePtr typeCache();
+
+    MetaDataCachePtr metaDataCache();
+
     //void initCLRDebugging();
 
     //ICorDebugModule*  getModule(MEMOFFSET_64  offset);
@@ -120,6 +126,8 @@ private:
 
     virtual DebugCallbackResult onProcessExit( PROCESS_DEBUG_ID processid, ProcessExitReason  reason, unsigned long exitCode );
 
+    virtual DebugCallbackResult onModuleUnload( MEMOFFSET_64 offset, const std::wstring &name );
+
 private:
 
     ICorDebugProcess*  getNetProcess();
@@ -128,8 +136,14 @@ private:
 
     typedef  std::map<PROCESS_ID, CComPtr<ICorDebugProcess> >   ProcessMap;
 
+    typedef  std::map<PROCESS_ID, NetTypeCachePtr>   TypeCacheMap;
+
+    typedef  std::map<PROCESS_ID, MetaDataCachePtr>   MetaDataCacheMap;
+
     boost::recursive_mutex  m_processLock;
     ProcessMap  m_processMap;
+    TypeCacheMap  m_typeCacheMap;
+    MetaDataCacheMap  m_metaDataCacheMap;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -183,6 +197,36 @@ ICorDebugProcess* ClrDebugManagerImpl::targetProcess()
 
 ///////////////////////////////////////////////////////////////////////////////
 
+NetTypeCachePtr ClrDebugManagerImpl::typeCache()
+{
+    boost::recursive_mutex::scoped_lock  lock(m_processLock);
+
+    PROCESS_ID  pid = TargetProcess::getCurrent()->getSystemId();
+
+    NetTypeCachePtr&  cache = m_typeCacheMap[pid];
+    if (!cache)
+        cache = NetTypeCachePtr( new NetTypeCache() );
+
+    return cache;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MetaDataCachePtr ClrDebugManagerImpl::metaDataCache()
+{
+    boost::recursive_mutex::scoped_lock  lock(m_processLock);
+
+    PROCESS_ID  pid = TargetProcess::getCurrent()->getSystemId();
+
+    MetaDataCachePtr&  cache = m_metaDataCacheMap[pid];
+    if (!cache)
+        cache = MetaDataCachePtr( new MetaDataCache() );
+
+    return cache;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 DebugCallbackResult ClrDebugManagerImpl::onProcessStart(PROCESS_DEBUG_ID processid)
 {
     boost::recursive_mutex::scoped_lock  lock(m_processLock);
@@ -193,6 +237,8 @@ DebugCallbackResult ClrDebugManagerImpl::onProcessStart(PROCESS_DEBUG_ID process
     {
         PROCESS_ID  pid = TargetProcess::getById(processid)->getSystemId();
         m_processMap[pid] = 0;
+        m_typeCacheMap.erase(pid);
+        m_metaDataCacheMap.erase(pid);
     }
 
     return DebugCallbackNoChange;
@@ -202,13 +248,37 @@ DebugCallbackResult ClrDebugManagerImpl::onProcessStart(PROCESS_DEBUG_ID process
 
 DebugCallbackResult ClrDebugManagerImpl::onProcessExit( PROCESS_DEBUG_ID processid, ProcessExitReason  reason, unsigned long exitCode )
 {
+    boost::recursive_mutex::scoped_lock  lock(m_processLock);
+
     auto process = TargetProcess::getById(processid);
 
     if (!process->isKernelDebugging())
     {
         PROCESS_ID  pid = TargetProcess::getById(processid)->getSystemId();
         m_processMap.erase(pid);
+        m_typeCacheMap.erase(pid);
+        m_metaDataCacheMap.erase(pid);
+    }
+
+    return DebugCallbackNoChange;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+DebugCallbackResult ClrDebugManagerImpl::onModuleUnload( MEMOFFSET_64 offset, const std::wstring &name )
+{
+    boost::recursive_mutex::scoped_lock  lock(m_processLock);
+
+    // a type ID of an unloaded assembly may be given to a type of another one
+    try {
+
+        auto process = TargetProcess::getCurrent();
+
+        if (!process->isKernelDebugging())
+            m_typeCacheMap.erase(process->getSystemId());
     }
+    catch (DbgException&)
+    {}
 
     return DebugCallbackNoChange;
 }
@@ -6,11 +6,18 @@
 #include <ClrData.h>
 #include <atlbase.h>
 
+#include <boost/shared_ptr.hpp>
+
 //#include "kdlib/dbgtypedef.h"
 #include "kdlib/typedvar.h"
 
 namespace kdlib {
 
+class NetTypeCache;
+typedef boost::shared_ptr<NetTypeCache>  NetTypeCachePtr;
+
+class MetaDataCache;
+typedef boost::shared_ptr<MetaDataCache>  MetaDataCachePtr;
 
 class ClrDebugManager
 {
@@ -18,6 +25,10 @@ public:
 
     virtual ICorDebugProcess* targetProcess() = 0;
 
+    virtual NetTypeCachePtr typeCache() = 0;
+
+    virtual MetaDataCachePtr metaDataCache() = 0;
+
     virtual ~ClrDebugManager()
     {}
     
@@ -1,5 +1,8 @@
 #include "stdafx.h"
 
+#include <algorithm>
+#include <map>
+
 #include <metahost.h>
 
 #include "kdlib/heap.h"
@@ -10,125 +13,228 @@
 #include "net/nettype.h"
 #include "net/metadata.h"
 
-#include "fnmatch.h"
-
 namespace kdlib {
 
+namespace {
+
 ///////////////////////////////////////////////////////////////////////////////
 
-TargetHeapPtr getManagedHeap()
+bool isSizeMatched(ULONG64 size, size_t minSize, size_t maxSize)
 {
-    return boost::make_shared<NetHeap>();
+    if ( minSize != 0 && size < minSize )
+        return false;
+
+    if ( maxSize != -1 && size > maxSize )
+        return false;
+
+    return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-size_t  NetHeap::getCount(const std::wstring&  typeName, size_t minSize, size_t maxSize) const
+size_t getObjectCount(const std::wstring&  typeName, size_t minSize, size_t maxSize)
 {
-    return NetHeapEnum(typeName, minSize, maxSize).getCount();
+    NetHeapReader  heapReader;
+    NetHeapTypeFilter  typeFilter(typeName);
+
+    size_t  elemCount = 0;
+
+    while (const COR_HEAPOBJECT* heapObj = heapReader.next())
+    {
+        if ( !isSizeMatched(heapObj->size, minSize, maxSize) )
+            continue;
+
+        if ( !typeFilter.empty() && !typeFilter.getType(heapObj->type).matched )
+            continue;
+
+        elemCount++;
+    }
+
+    return elemCount;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-TargetHeapEnumPtr  NetHeap::getEnum(const std::wstring&  typeName, size_t minSize, size_t maxSize) 
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TargetHeapPtr getManagedHeap()
 {
-    return TargetHeapEnumPtr( new NetHeapEnum(typeName, minSize, maxSize) );
+    return boost::make_shared<NetHeap>();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-NetHeapEnum::NetHeapEnum(const std::wstring&  typeName, size_t minSize, size_t maxSize) :
-    m_typeMask(typeName),
-    m_minSize(minSize),
-    m_maxSize(maxSize)
+size_t  NetHeap::getCount(const std::wstring&  typeName, size_t minSize, size_t maxSize) const
 {
-    HRESULT  hres = g_netMgr->targetProcess5()->EnumerateHeap(&m_heapEnum);
-    if (FAILED(hres))
-        throw DbgException("Failed ICorDebugProcess5::EnumerateHeap");
+    return getObjectCount(typeName, minSize, maxSize);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-bool NetHeapEnum::next(MEMOFFSET_64& addr, std::wstring& typeName, size_t& size)
+TargetHeapEnumPtr  NetHeap::getEnum(const std::wstring&  typeName, size_t minSize, size_t maxSize) 
 {
-    HRESULT  hres;
+    return TargetHeapEnumPtr( new NetHeapEnum(typeName, minSize, maxSize) );
+}
 
-    while(true)
-    {
-        COR_HEAPOBJECT   heapObj;
-        hres = m_heapEnum->Next(1, &heapObj, NULL);
+///////////////////////////////////////////////////////////////////////////////
 
-        if (FAILED(hres))
-            throw DbgException("Failed ICorDebugHeapEnum::Next");
+TargetHeapStat  NetHeap::getStatistics(const std::wstring&  typeName, size_t minSize, size_t maxSize) const
+{
+    struct TypeCounter {
+        size_t  count;
+        unsigned long long  totalSize;
+    };
 
-        if ( S_OK != hres )
-            return false;
+    typedef std::unordered_map<COR_TYPEID, TypeCounter, CorTypeIdHash, CorTypeIdEqual>  CounterMap;
 
-        TypeInfoPtr  typeObj = getNetTypeById(heapObj.type);
+    CounterMap  counters;
 
-        std::wstring  tn = typeObj->getName();
+    NetHeapReader  heapReader;
 
-        if ( !m_typeMask.empty() && !fnmatch(m_typeMask, typeObj->getName() ))
+    while (const COR_HEAPOBJECT* heapObj = heapReader.next())
+    {
+        if ( !isSizeMatched(heapObj->size, minSize, maxSize) )
             continue;
 
-        if ( m_minSize != 0 && heapObj.size < m_minSize )
-            continue;
+        TypeCounter  &counter = counters.insert( std::make_pair(heapObj->type, TypeCounter()) ).first->second;
+        counter.count++;
+        counter.totalSize += heapObj->size;
+    }
 
-        if ( m_maxSize != -1 && heapObj.size > m_maxSize )
-            continue;
+    // types with the same name ( from different domains ) are merged
+    NetHeapTypeFilter  typeFilter(typeName);
+    std::map<std::wstring, TargetHeapTypeStat>  typeStats;
 
-        addr = heapObj.address;
-        typeName = tn;
-        size = heapObj.size;
+    for (CounterMap::const_iterator it = counters.begin(); it != counters.end(); ++it)
+    {
+        const NetHeapTypeFilter::TypeEntry  &typeEntry = typeFilter.getType(it->first);
+        if ( !typeEntry.matched )
+            continue;
 
-        return true;
+        TargetHeapTypeStat  &typeStat = typeStats[typeEntry.name];
+        typeStat.typeName = typeEntry.name;
+        typeStat.count += it->second.count;
+        typeStat.totalSize += it->second.totalSize;
     }
 
-    throw DbgException("NetHeapEnum::Next undefined behaviour");
+    TargetHeapStat  heapStat;
+    heapStat.reserve(typeStats.size());
+
+    for (std::map<std::wstring, TargetHeapTypeStat>::const_iterator it = typeStats.begin(); it != typeStats.end(); ++it)
+        heapStat.push_back(it->second);
+
+    std::stable_sort(heapStat.begin(), heapStat.end(), 
+        [](const TargetHeapTypeStat& stat1, const TargetHeapTypeStat& stat2) { return stat1.totalSize > stat2.totalSize; } );
+
+    return heapStat;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-size_t NetHeapEnum::getCount() const
+NetHeapReader::NetHeapReader() :
+    m_objects(batchSize),
+    m_count(0),
+    m_pos(0),
+    m_completed(false)
 {
-    CComPtr<ICorDebugHeapEnum>   heapEnum;
-    HRESULT  hres = g_netMgr->targetProcess5()->EnumerateHeap(&heapEnum);
+    HRESULT  hres = g_netMgr->targetProcess5()->EnumerateHeap(&m_heapEnum);
     if (FAILED(hres))
         throw DbgException("Failed ICorDebugProcess5::EnumerateHeap");
+}
 
-    size_t  elemCount = 0;
+///////////////////////////////////////////////////////////////////////////////
+
+const COR_HEAPOBJECT* NetHeapReader::next()
+{
+    if ( m_pos < m_count )
+        return &m_objects[m_pos++];
+
+    if ( m_completed )
+        return NULL;
+
+    m_count = 0;
+    m_pos = 0;
 
-    while(true)
+    HRESULT  hres = m_heapEnum->Next(batchSize, &m_objects[0], &m_count);
+
+    if (FAILED(hres))
+        throw DbgException("Failed ICorDebugHeapEnum::Next");
+
+    // S_FALSE: the last objects are fetched
+    if ( S_OK != hres )
+        m_completed = true;
+
+    if ( m_count == 0 )
     {
-        COR_HEAPOBJECT   heapObj;
-        hres = heapEnum->Next(1, &heapObj, NULL);
+        m_completed = true;
+        return NULL;
+    }
 
-        if (FAILED(hres))
-            throw DbgException("Failed ICorDebugHeapEnum::Next");
+    return &m_objects[m_pos++];
+}
 
-        if ( S_OK != hres )
-            break;
+///////////////////////////////////////////////////////////////////////////////
 
-        if ( !m_typeMask.empty() || m_minSize != 0 || m_maxSize != -1 )
-        {
-            TypeInfoPtr  typeObj = getNetTypeById(heapObj.type);
+NetHeapTypeFilter::NetHeapTypeFilter(const std::wstring&  typeMask) :
+    m_typeMask(typeMask),
+    m_typeCache(g_netMgr->typeCache())
+{}
 
-            std::wstring  tn = typeObj->getName();
+///////////////////////////////////////////////////////////////////////////////
 
-            if ( !m_typeMask.empty() && !fnmatch(m_typeMask, typeObj->getName() ))
-                continue;
+const NetHeapTypeFilter::TypeEntry& NetHeapTypeFilter::getType(COR_TYPEID typeId)
+{
+    TypeMap::const_iterator  it = m_types.find(typeId);
+    if ( it != m_types.end() )
+        return it->second;
 
-            if ( m_minSize != 0 && heapObj.size < m_minSize )
-                continue;
+    TypeEntry  typeEntry;
+    typeEntry.name = m_typeCache->get(typeId)->getName();
+    typeEntry.matched = m_typeMask.empty() || m_typeMask.match(typeEntry.name);
 
-            if ( m_maxSize != -1 && heapObj.size > m_maxSize )
-                continue;
-        }
+    return m_types.insert( std::make_pair(typeId, typeEntry) ).first->second;
+}
 
-        elemCount++;
+///////////////////////////////////////////////////////////////////////////////
+
+NetHeapEnum::NetHeapEnum(const std::wstring&  typeName, size_t minSize, size_t maxSize) :
+    m_typeName(typeName),
+    m_minSize(minSize),
+    m_maxSize(maxSize),
+    m_typeFilter(typeName)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool NetHeapEnum::next(MEMOFFSET_64& addr, std::wstring& typeName, size_t& size)
+{
+    while (const COR_HEAPOBJECT* heapObj = m_heapReader.next())
+    {
+        if ( !isSizeMatched(heapObj->size, m_minSize, m_maxSize) )
+            continue;
+
+        const NetHeapTypeFilter::TypeEntry  &typeEntry = m_typeFilter.getType(heapObj->type);
+        if ( !typeEntry.matched )
+            continue;
+
+        addr = heapObj->address;
+        typeName = typeEntry.name;
+        size = static_cast<size_t>(heapObj->size);
+
+        return true;
     }
 
-    return elemCount;
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t NetHeapEnum::getCount() const
+{
+    return getObjectCount(m_typeName, m_minSize, m_maxSize);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1,10 +1,18 @@
 #pragma once
 
+#include <unordered_map>
+#include <vector>
+
 #include <atlbase.h>
 #include <CorDebug.h>
 
+#include <boost/noncopyable.hpp>
+
 #include "kdlib/heap.h"
 
+#include "net/nettype.h"
+#include "fnmatch.h"
+
 namespace kdlib {
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -17,8 +25,63 @@ protected:
 
     virtual TargetHeapEnumPtr  getEnum(const std::wstring&  typeName=L"", size_t minSize = 0, size_t maxSize = -1);
 
+    virtual TargetHeapStat  getStatistics(const std::wstring&  typeName=L"", size_t minSize = 0, size_t maxSize = -1) const;
 };
 
+///////////////////////////////////////////////////////////////////////////////
+
+// Reads the heap objects by batches
+class NetHeapReader : private boost::noncopyable
+{
+public:
+
+    NetHeapReader();
+
+    // returns NULL after the last object
+    const COR_HEAPOBJECT* next();
+
+private:
+
+    static const ULONG  batchSize = 0x400;
+
+    CComPtr<ICorDebugHeapEnum>   m_heapEnum;
+    std::vector<COR_HEAPOBJECT>  m_objects;
+    ULONG  m_count;
+    ULONG  m_pos;
+    bool  m_completed;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Names of the heap object types, the mask is matched once for each type
+class NetHeapTypeFilter : private boost::noncopyable
+{
+public:
+
+    struct TypeEntry {
+        std::wstring  name;
+        bool  matched;
+    };
+
+    explicit NetHeapTypeFilter(const std::wstring&  typeMask);
+
+    bool empty() const {
+        return m_typeMask.empty();
+    }
+
+    const TypeEntry& getType(COR_TYPEID typeId);
+
+private:
+
+    typedef std::unordered_map<COR_TYPEID, TypeEntry, CorTypeIdHash, CorTypeIdEqual>  TypeMap;
+
+    GlobPattern  m_typeMask;
+    NetTypeCachePtr  m_typeCache;
+    TypeMap  m_types;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 class NetHeapEnum : public TargetHeapEnum
 {
 
@@ -34,10 +97,11 @@ public:
 
 private:
 
-    std::wstring  m_typeMask;
+    std::wstring  m_typeName;
     size_t  m_minSize;
     size_t  m_maxSize;
-    CComPtr<ICorDebugHeapEnum>   m_heapEnum;
+    NetHeapTypeFilter  m_typeFilter;
+    NetHeapReader  m_heapReader;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
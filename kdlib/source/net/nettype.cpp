@@ -5,6 +5,8 @@
 
 #include <metahost.h>
 
+#include <boost/thread/lock_guard.hpp>
+
 #include "kdlib/memaccess.h"
 
 #include "net/nettype.h"
@@ -36,6 +38,13 @@ TypeInfoPtr getNetTypeArray(COR_TYPEID typeId)
 ///////////////////////////////////////////////////////////////////////////////
 
 TypeInfoPtr  getNetTypeById(COR_TYPEID typeId)
+{
+    return g_netMgr->typeCache()->get(typeId);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypeInfoPtr  loadNetTypeById(COR_TYPEID typeId)
 {
     CComPtr<ICorDebugType>  objType;
     HRESULT  hres = g_netMgr->targetProcess5()->GetTypeForTypeID(typeId, &objType);
@@ -62,6 +71,25 @@ TypeInfoPtr  getNetTypeById(COR_TYPEID typeId)
     NOT_IMPLEMENTED();
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+TypeInfoPtr NetTypeCache::get(COR_TYPEID typeId)
+{
+    {
+        boost::lock_guard<boost::mutex>  l(m_lock);
+
+        TypeMap::const_iterator  it = m_types.find(typeId);
+        if ( it != m_types.end() )
+            return it->second;
+    }
+
+    // the debugger API is called without the lock
+    TypeInfoPtr  typeInfo = loadNetTypeById(typeId);
+
+    boost::lock_guard<boost::mutex>  l(m_lock);
+
+    return m_types.insert( std::make_pair(typeId, typeInfo) ).first->second;
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <functional>
+#include <unordered_map>
+
 #include <boost/enable_shared_from_this.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include "kdlib/typeinfo.h"
 #include "kdlib/exceptions.h"
@@ -19,6 +24,38 @@ TypeInfoPtr  getNetTypeById(COR_TYPEID typeId);
 
 ///////////////////////////////////////////////////////////////////////////////
 
+struct CorTypeIdHash {
+    size_t operator()(const COR_TYPEID& typeId) const {
+        size_t  hash = std::hash<ULONG64>()(typeId.token1);
+        return hash ^ ( std::hash<ULONG64>()(typeId.token2) + 0x9e3779b9 + (hash << 6) + (hash >> 2) );
+    }
+};
+
+struct CorTypeIdEqual {
+    bool operator()(const COR_TYPEID& typeId1, const COR_TYPEID& typeId2) const {
+        return typeId1.token1 == typeId2.token1 && typeId1.token2 == typeId2.token2;
+    }
+};
+
+// Managed types of a process by the type ID. A type ID may be reused after
+// its assembly is unloaded, so the cache is dropped on a module unload and
+// on the process restart
+class NetTypeCache : private boost::noncopyable
+{
+public:
+
+    TypeInfoPtr get(COR_TYPEID typeId);
+
+private:
+
+    typedef std::unordered_map<COR_TYPEID, TypeInfoPtr, CorTypeIdHash, CorTypeIdEqual>  TypeMap;
+
+    boost::mutex  m_lock;
+    TypeMap  m_types;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 class NetTypeInfoBase : public TypeInfo, public boost::enable_shared_from_this<NetTypeInfoBase>
 {
 protected:
@@ -21,12 +21,31 @@ class ProcessInfo {
 
 public:
 
+    explicit ProcessInfo(size_t maxTypes) :
+        m_moduleMap(new ModuleMap()),
+        m_typeCache(new TypeInfoCache(maxTypes)),
+        m_frameScopes(new FrameScopeCache()),
+        m_symbolIndex(new SymbolNameIndex())
+    {}
+
     ModulePtr getModule(MEMOFFSET_64  offset);
     void insertModule( ModulePtr& module);
     void removeModule(MEMOFFSET_64  offset );
 
-    TypeInfoPtr getTypeInfo(const std::wstring& name);
-    void insertTypeInfo(const TypeInfoPtr& typeInfo);
+    TypeInfoPtr getTypeInfo(MEMOFFSET_64 moduleBase, const std::wstring& name);
+    void insertTypeInfo(MEMOFFSET_64 moduleBase, const std::wstring& name, const TypeInfoPtr& typeInfo);
+
+    TypeInfoCachePtr getTypeCache() {
+        return m_typeCache;
+    }
+
+    FrameScopeCachePtr getFrameScopeCache() {
+        return m_frameScopes;
+    }
+
+    SymbolNameIndexPtr getSymbolIndex() {
+        return m_symbolIndex;
+    }
 
     void insertBreakpoint(const BreakpointPtr& breakpoint);
     void removeBreakpoint(const BreakpointPtr& breakpoint);
@@ -35,19 +54,37 @@ public:
 
     void onChangeSymbolPaths();
 
+    MemoryCachePtr getMemoryCache(size_t maxPages);
+    void resetMemoryCache();
+    void dropMemoryCache();
+
 private:
 
-    typedef std::map<MEMOFFSET_64, ModulePtr> ModuleMap;
-    ModuleMap  m_moduleMap;
+    struct ModuleRange {
+        MEMOFFSET_64  end;
+        ModulePtr  module;
+    };
+
+    // modules sorted by the base address; the map is never changed in place,
+    // writers replace it with an updated copy, so readers take no lock
+    typedef std::map<MEMOFFSET_64, ModuleRange> ModuleMap;
+    typedef boost::shared_ptr<const ModuleMap>  ModuleMapPtr;
+
+    ModuleMapPtr  m_moduleMap;
     boost::recursive_mutex  m_moduleLock;
 
-    typedef std::map<std::wstring, TypeInfoPtr>  TypeInfoMap;
-    TypeInfoMap  m_typeInfoMap;
-    boost::recursive_mutex  m_typeInfoLock;
+    TypeInfoCachePtr  m_typeCache;
+
+    FrameScopeCachePtr  m_frameScopes;
+
+    SymbolNameIndexPtr  m_symbolIndex;
     
     typedef std::map<BREAKPOINT_ID, BreakpointPtr>  BreakpointIdMap;
     BreakpointIdMap  m_breakpointMap;
     boost::recursive_mutex  m_breakpointLock;
+
+    MemoryCachePtr  m_memCache;
+    boost::recursive_mutex  m_memCacheLock;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -56,7 +93,12 @@ class ProcessMonitorImpl {
 
 public:
 
-    ProcessMonitorImpl() : m_bpUnique(0x80000000)
+    ProcessMonitorImpl() : 
+        m_bpUnique(0x80000000),
+        m_memCacheEnabled(false),
+        m_memCacheLimit(0),
+        m_typeCacheLimit(defaultTypeCacheLimit),
+        m_symbolIndexEnabled(false)
     {}
 
     ~ProcessMonitorImpl()
@@ -89,8 +131,13 @@ public:
     ModulePtr getModule( MEMOFFSET_64  offset, PROCESS_DEBUG_ID id );
     void insertModule( ModulePtr& module, PROCESS_DEBUG_ID id );
 
-    TypeInfoPtr getTypeInfo(const std::wstring& name, PROCESS_DEBUG_ID id = -1);
-    void insertTypeInfo(const TypeInfoPtr& typeInfo, PROCESS_DEBUG_ID id = -1);
+    TypeInfoPtr getTypeInfo(MEMOFFSET_64 moduleBase, const std::wstring& name, PROCESS_DEBUG_ID id = -1);
+    void insertTypeInfo(MEMOFFSET_64 moduleBase, const std::wstring& name, const TypeInfoPtr& typeInfo, PROCESS_DEBUG_ID id = -1);
+
+    void setTypeCacheLimit(size_t maxTypes);
+    TypeInfoCachePtr getTypeCache(PROCESS_DEBUG_ID id);
+
+    FrameScopeCachePtr getFrameScopeCache(PROCESS_DEBUG_ID id);
 
     void registerEventsCallback(DebugEventsCallback *callback);
     void removeEventsCallback(DebugEventsCallback *callback);
@@ -98,6 +145,20 @@ public:
     void registerBreakpoint( const BreakpointPtr& breakpoint, PROCESS_DEBUG_ID id = -1 );
     void removeBreakpoint( const BreakpointPtr& breakpoint, PROCESS_DEBUG_ID id = -1 );
 
+    void enableMemoryCache(bool enable, size_t maxPages);
+    bool isMemoryCacheEnabled() const {
+        return m_memCacheEnabled;
+    }
+    MemoryCachePtr getMemoryCache(PROCESS_DEBUG_ID id);
+    MemoryCachePtr getCurrentMemoryCache();
+    void resetMemoryCache();
+
+    void enableSymbolIndex(bool enable);
+    bool isSymbolIndexEnabled() const {
+        return m_symbolIndexEnabled;
+    }
+    SymbolNameIndexPtr getSymbolIndex(PROCESS_DEBUG_ID id);
+
 private:
 
     ProcessInfoPtr  getProcess( PROCESS_DEBUG_ID id );
@@ -109,6 +170,17 @@ private:
 
     boost::atomic<unsigned long long>  m_bpUnique;
 
+    boost::atomic<bool>  m_memCacheEnabled;
+    boost::atomic<size_t>  m_memCacheLimit;
+
+    // the cache of the current process, dropped on any process or context change
+    MemoryCachePtr  m_currentMemCache;
+
+    static const size_t  defaultTypeCacheLimit = 0x4000;
+    boost::atomic<size_t>  m_typeCacheLimit;
+
+    boost::atomic<bool>  m_symbolIndexEnabled;
+
 private:
 
     typedef std::list<DebugEventsCallback*>  EventsCallbackList;
@@ -347,22 +419,149 @@ void ProcessMonitor::insertModule( ModulePtr& module, PROCESS_DEBUG_ID id )
 
 ///////////////////////////////////////////////////////////////////////////////
 
-TypeInfoPtr ProcessMonitor::getTypeInfo(const std::wstring& name, PROCESS_DEBUG_ID id)
+TypeInfoPtr ProcessMonitor::getTypeInfo(MEMOFFSET_64 moduleBase, const std::wstring& name, PROCESS_DEBUG_ID id)
 {
     if (id == -1)
         id = getCurrentProcessId();
 
-    return g_procmon->getTypeInfo(name, id);
+    return g_procmon->getTypeInfo(moduleBase, name, id);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-void ProcessMonitor::insertTypeInfo(const TypeInfoPtr& typeInfo, PROCESS_DEBUG_ID id)
+void ProcessMonitor::insertTypeInfo(MEMOFFSET_64 moduleBase, const std::wstring& name, const TypeInfoPtr& typeInfo, PROCESS_DEBUG_ID id)
 {
     if (id == -1)
         id = getCurrentProcessId();
 
-    return g_procmon->insertTypeInfo(typeInfo, id);
+    return g_procmon->insertTypeInfo(moduleBase, name, typeInfo, id);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ProcessMonitor::setTypeCacheLimit(size_t maxTypes)
+{
+    g_procmon->setTypeCacheLimit(maxTypes);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypeInfoCachePtr ProcessMonitor::getTypeCache(PROCESS_DEBUG_ID id)
+{
+    if (id == -1)
+        id = getCurrentProcessId();
+
+    return g_procmon->getTypeCache(id);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ProcessMonitor::resetTypeCache(MEMOFFSET_64 moduleBase, PROCESS_DEBUG_ID id)
+{
+    if (!g_procmon)
+        return;
+
+    if (id == -1)
+        id = getCurrentProcessId();
+
+    g_procmon->getTypeCache(id)->invalidate(moduleBase);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+FrameScopeCachePtr ProcessMonitor::getFrameScopeCache(PROCESS_DEBUG_ID id)
+{
+    if (id == -1)
+        id = getCurrentProcessId();
+
+    return g_procmon->getFrameScopeCache(id);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ProcessMonitor::resetFrameScopes(MEMOFFSET_64 moduleBase, PROCESS_DEBUG_ID id)
+{
+    if (!g_procmon)
+        return;
+
+    if (id == -1)
+        id = getCurrentProcessId();
+
+    g_procmon->getFrameScopeCache(id)->invalidate(moduleBase);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ProcessMonitor::enableMemoryCache(bool enable, size_t maxPages)
+{
+    g_procmon->enableMemoryCache(enable, maxPages);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ProcessMonitor::isMemoryCacheEnabled()
+{
+    return g_procmon->isMemoryCacheEnabled();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MemoryCachePtr ProcessMonitor::getMemoryCache(PROCESS_DEBUG_ID id)
+{
+    if (!g_procmon->isMemoryCacheEnabled())
+        return MemoryCachePtr();
+
+    if (id == -1)
+        return g_procmon->getCurrentMemoryCache();
+
+    return g_procmon->getMemoryCache(id);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ProcessMonitor::resetMemoryCache()
+{
+    g_procmon->resetMemoryCache();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ProcessMonitor::enableSymbolIndex(bool enable)
+{
+    g_procmon->enableSymbolIndex(enable);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ProcessMonitor::isSymbolIndexEnabled()
+{
+    return g_procmon->isSymbolIndexEnabled();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SymbolNameIndexPtr ProcessMonitor::getSymbolIndex(PROCESS_DEBUG_ID id)
+{
+    if (!g_procmon->isSymbolIndexEnabled())
+        return SymbolNameIndexPtr();
+
+    if (id == -1)
+        id = getCurrentProcessId();
+
+    return g_procmon->getSymbolIndex(id);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ProcessMonitor::resetSymbolIndex(MEMOFFSET_64 moduleBase, PROCESS_DEBUG_ID id)
+{
+    if (!g_procmon)
+        return;
+
+    if (id == -1)
+        id = getCurrentProcessId();
+
+    g_procmon->getSymbolIndex(id)->removeModule(moduleBase);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -370,9 +569,10 @@ void ProcessMonitor::insertTypeInfo(const TypeInfoPtr& typeInfo, PROCESS_DEBUG_I
 DebugCallbackResult ProcessMonitorImpl::processStart(PROCESS_DEBUG_ID id)
 {
     {
-        ProcessInfoPtr  proc = ProcessInfoPtr(new ProcessInfo());
+        ProcessInfoPtr  proc = ProcessInfoPtr(new ProcessInfo(m_typeCacheLimit));
         boost::recursive_mutex::scoped_lock l(m_lock);
         m_processMap[id] = proc;
+        m_currentMemCache.reset();
     }
 
     DebugCallbackResult  result = DebugCallbackNoChange;
@@ -398,6 +598,7 @@ DebugCallbackResult ProcessMonitorImpl::processStop(PROCESS_DEBUG_ID id, Process
     {
         boost::recursive_mutex::scoped_lock l(m_lock);
         m_processMap.erase(id);
+        m_currentMemCache.reset();
     }
 
     DebugCallbackResult  result = DebugCallbackNoChange;
@@ -572,6 +773,8 @@ DebugCallbackResult ProcessMonitorImpl::breakpointHit(PROCESS_DEBUG_ID id, Break
 
 void ProcessMonitorImpl::currentThreadChange(THREAD_DEBUG_ID threadid)
 {
+    resetMemoryCache();
+
     boost::recursive_mutex::scoped_lock l(m_callbacksLock);
 
     EventsCallbackList::iterator  it = m_callbacks.begin();
@@ -586,6 +789,8 @@ void ProcessMonitorImpl::currentThreadChange(THREAD_DEBUG_ID threadid)
 
 void ProcessMonitorImpl::executionStatusChange(ExecutionStatus status)
 {
+    resetMemoryCache();
+
     boost::recursive_mutex::scoped_lock l(m_callbacksLock);
 
     EventsCallbackList::iterator  it = m_callbacks.begin();
@@ -716,22 +921,131 @@ void ProcessMonitorImpl::insertModule( ModulePtr& module, PROCESS_DEBUG_ID id )
 
 ///////////////////////////////////////////////////////////////////////////////
 
-TypeInfoPtr ProcessMonitorImpl::getTypeInfo(const std::wstring& name, PROCESS_DEBUG_ID id)
+TypeInfoPtr ProcessMonitorImpl::getTypeInfo(MEMOFFSET_64 moduleBase, const std::wstring& name, PROCESS_DEBUG_ID id)
 {
     ProcessInfoPtr  processInfo = getProcess(id);
     if ( processInfo )
-        return processInfo->getTypeInfo(name);
+        return processInfo->getTypeInfo(moduleBase, name);
 
     return TypeInfoPtr();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-void ProcessMonitorImpl::insertTypeInfo(const TypeInfoPtr& typeInfo, PROCESS_DEBUG_ID id)
+void ProcessMonitorImpl::insertTypeInfo(MEMOFFSET_64 moduleBase, const std::wstring& name, const TypeInfoPtr& typeInfo, PROCESS_DEBUG_ID id)
 {
     ProcessInfoPtr  processInfo = getProcess(id);
     if (processInfo)
-        return processInfo->insertTypeInfo(typeInfo);
+        return processInfo->insertTypeInfo(moduleBase, name, typeInfo);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ProcessMonitorImpl::setTypeCacheLimit(size_t maxTypes)
+{
+    boost::recursive_mutex::scoped_lock l(m_lock);
+
+    m_typeCacheLimit = maxTypes;
+
+    for (ProcessMap::iterator it = m_processMap.begin(); it != m_processMap.end(); ++it)
+        it->second->getTypeCache()->setLimit(maxTypes);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypeInfoCachePtr ProcessMonitorImpl::getTypeCache(PROCESS_DEBUG_ID id)
+{
+    return getProcess(id)->getTypeCache();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+FrameScopeCachePtr ProcessMonitorImpl::getFrameScopeCache(PROCESS_DEBUG_ID id)
+{
+    return getProcess(id)->getFrameScopeCache();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ProcessMonitorImpl::enableMemoryCache(bool enable, size_t maxPages)
+{
+    boost::recursive_mutex::scoped_lock l(m_lock);
+
+    m_memCacheEnabled = enable && maxPages > 0;
+    m_memCacheLimit = maxPages;
+    m_currentMemCache.reset();
+
+    for (ProcessMap::iterator it = m_processMap.begin(); it != m_processMap.end(); ++it)
+    {
+        if (m_memCacheEnabled)
+        {
+            MemoryCachePtr  cache = it->second->getMemoryCache(maxPages);
+            cache->setLimit(maxPages);
+        }
+        else
+        {
+            it->second->dropMemoryCache();
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ProcessMonitorImpl::enableSymbolIndex(bool enable)
+{
+    boost::recursive_mutex::scoped_lock l(m_lock);
+
+    m_symbolIndexEnabled = enable;
+
+    if (!enable)
+    {
+        for (ProcessMap::iterator it = m_processMap.begin(); it != m_processMap.end(); ++it)
+            it->second->getSymbolIndex()->invalidate();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SymbolNameIndexPtr ProcessMonitorImpl::getSymbolIndex(PROCESS_DEBUG_ID id)
+{
+    return getProcess(id)->getSymbolIndex();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MemoryCachePtr ProcessMonitorImpl::getMemoryCache(PROCESS_DEBUG_ID id)
+{
+    ProcessInfoPtr  processInfo = getProcess(id);
+    if (processInfo)
+        return processInfo->getMemoryCache(m_memCacheLimit);
+
+    return MemoryCachePtr();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MemoryCachePtr ProcessMonitorImpl::getCurrentMemoryCache()
+{
+    boost::recursive_mutex::scoped_lock l(m_lock);
+
+    if (!m_currentMemCache)
+        m_currentMemCache = getMemoryCache(getCurrentProcessId());
+
+    return m_currentMemCache;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ProcessMonitorImpl::resetMemoryCache()
+{
+    nextMemoryGeneration();
+
+    boost::recursive_mutex::scoped_lock l(m_lock);
+
+    m_currentMemCache.reset();
+
+    for (ProcessMap::iterator it = m_processMap.begin(); it != m_processMap.end(); ++it)
+        it->second->resetMemoryCache();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -745,7 +1059,7 @@ ProcessInfoPtr ProcessMonitorImpl::getProcess( PROCESS_DEBUG_ID id )
     if ( it != m_processMap.end() )
         return it->second;
 
-    ProcessInfoPtr  proc = ProcessInfoPtr( new ProcessInfo() );
+    ProcessInfoPtr  proc = ProcessInfoPtr( new ProcessInfo(m_typeCacheLimit) );
     m_processMap[id] = proc;
 
     return proc;
@@ -796,20 +1110,17 @@ void ProcessMonitorImpl::removeBreakpoint( const BreakpointPtr& breakpoint, PROC
 
 ModulePtr ProcessInfo::getModule(MEMOFFSET_64  offset)
 {
-    boost::recursive_mutex::scoped_lock l(m_moduleLock);
+    ModuleMapPtr  moduleMap = boost::atomic_load(&m_moduleMap);
 
-    ModuleMap::iterator it = m_moduleMap.find(offset);
+    ModuleMap::const_iterator  it = moduleMap->upper_bound(offset);
 
-    if ( it != m_moduleMap.end() )
-        return it->second;
+    if ( it == moduleMap->begin() )
+        return ModulePtr();
 
-    for ( ModuleMap::iterator it = m_moduleMap.begin(); it != m_moduleMap.end(); ++it )
-    {
-        if ( it->second->getBase() <= offset && offset < it->second->getEnd() )
-        {
-           return it->second;
-        }
-    }
+    --it;
+
+    if ( offset == it->first || offset < it->second.end )
+        return it->second.module;
 
     return ModulePtr();
 }
@@ -818,39 +1129,49 @@ ModulePtr ProcessInfo::getModule(MEMOFFSET_64  offset)
 
 void ProcessInfo::insertModule( ModulePtr& module)
 {
+    ModuleRange  range = { module->getEnd(), module };
+
     boost::recursive_mutex::scoped_lock l(m_moduleLock);
-    m_moduleMap[ module->getBase() ] = module;
-}
 
-///////////////////////////////////////////////////////////////////////////////
+    boost::shared_ptr<ModuleMap>  moduleMap( new ModuleMap(*m_moduleMap) );
+    (*moduleMap)[ module->getBase() ] = range;
 
-void ProcessInfo::removeModule(MEMOFFSET_64  offset )
-{
-    boost::recursive_mutex::scoped_lock l(m_moduleLock);
-    m_moduleMap.erase(offset);
+    boost::atomic_store(&m_moduleMap, ModuleMapPtr(moduleMap));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-TypeInfoPtr ProcessInfo::getTypeInfo(const std::wstring& name)
+void ProcessInfo::removeModule(MEMOFFSET_64  offset )
 {
-    boost::recursive_mutex::scoped_lock l(m_typeInfoLock);
+    {
+        boost::recursive_mutex::scoped_lock l(m_moduleLock);
 
-    TypeInfoMap::iterator  it = m_typeInfoMap.find(name);
+        if ( m_moduleMap->find(offset) != m_moduleMap->end() )
+        {
+            boost::shared_ptr<ModuleMap>  moduleMap( new ModuleMap(*m_moduleMap) );
+            moduleMap->erase(offset);
 
-    if (it != m_typeInfoMap.end())
-        return it->second;
+            boost::atomic_store(&m_moduleMap, ModuleMapPtr(moduleMap));
+        }
+    }
 
-    return TypeInfoPtr();
+    m_typeCache->invalidate(offset);
+    m_frameScopes->invalidate(offset);
+    m_symbolIndex->removeModule(offset);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-void ProcessInfo::insertTypeInfo(const TypeInfoPtr& typeInfo)
+TypeInfoPtr ProcessInfo::getTypeInfo(MEMOFFSET_64 moduleBase, const std::wstring& name)
 {
-    boost::recursive_mutex::scoped_lock l(m_typeInfoLock);
+    return m_typeCache->find(moduleBase, name);
+}
 
-    m_typeInfoMap.insert(std::make_pair(typeInfo->getName(), typeInfo));
+///////////////////////////////////////////////////////////////////////////////
+
+void ProcessInfo::insertTypeInfo(MEMOFFSET_64 moduleBase, const std::wstring& name, const TypeInfoPtr& typeInfo)
+{
+    m_typeCache->insert(moduleBase, name, typeInfo);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -911,16 +1232,48 @@ DebugCallbackResult ProcessInfo::breakpointHit(BreakpointPtr& breakpoint)
 
 void ProcessInfo::onChangeSymbolPaths()
 {
+    m_symbolIndex->invalidate();
+
     boost::recursive_mutex::scoped_lock l(m_moduleLock);
 
-    for ( ModuleMap::iterator it = m_moduleMap.begin(); it != m_moduleMap.end(); ++it)
+    for ( ModuleMap::const_iterator it = m_moduleMap->begin(); it != m_moduleMap->end(); ++it)
     {
-        if ( !it->second->isSymbolLoaded() )
-            it->second->resetSymbols();
+        if ( !it->second.module->isSymbolLoaded() )
+            it->second.module->resetSymbols();
     }
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
+MemoryCachePtr ProcessInfo::getMemoryCache(size_t maxPages)
+{
+    boost::recursive_mutex::scoped_lock l(m_memCacheLock);
+
+    if (!m_memCache)
+        m_memCache = MemoryCachePtr(new MemoryCache(maxPages));
+
+    return m_memCache;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void ProcessInfo::resetMemoryCache()
+{
+    boost::recursive_mutex::scoped_lock l(m_memCacheLock);
+
+    if (m_memCache)
+        m_memCache->invalidate();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void ProcessInfo::dropMemoryCache()
+{
+    boost::recursive_mutex::scoped_lock l(m_memCacheLock);
+    m_memCache.reset();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
 } //namesapce kdlib
 
@@ -6,6 +6,11 @@
 #include "kdlib/typeinfo.h"
 #include "kdlib/module.h"
 
+#include "memcache.h"
+#include "typecache.h"
+#include "framescope.h"
+#include "symindex.h"
+
 namespace kdlib {
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -59,8 +64,33 @@ public: //callbacks
 
 public: // 
 
-    static TypeInfoPtr getTypeInfo(const std::wstring& name, PROCESS_DEBUG_ID id = -1);
-    static void insertTypeInfo( const TypeInfoPtr& typeInfo, PROCESS_DEBUG_ID id = -1);
+    static TypeInfoPtr getTypeInfo(MEMOFFSET_64 moduleBase, const std::wstring& name, PROCESS_DEBUG_ID id = -1);
+    static void insertTypeInfo(MEMOFFSET_64 moduleBase, const std::wstring& name, const TypeInfoPtr& typeInfo, PROCESS_DEBUG_ID id = -1);
+
+public: // type cache
+
+    static void setTypeCacheLimit(size_t maxTypes);
+    static TypeInfoCachePtr getTypeCache(PROCESS_DEBUG_ID id = -1);
+    static void resetTypeCache(MEMOFFSET_64 moduleBase, PROCESS_DEBUG_ID id = -1);
+
+public: // stack frame scopes
+
+    static FrameScopeCachePtr getFrameScopeCache(PROCESS_DEBUG_ID id = -1);
+    static void resetFrameScopes(MEMOFFSET_64 moduleBase, PROCESS_DEBUG_ID id = -1);
+
+public: // memory cache
+
+    static void enableMemoryCache(bool enable, size_t maxPages);
+    static bool isMemoryCacheEnabled();
+    static MemoryCachePtr getMemoryCache(PROCESS_DEBUG_ID id = -1);
+    static void resetMemoryCache();
+
+public: // symbol name index
+
+    static void enableSymbolIndex(bool enable);
+    static bool isSymbolIndexEnabled();
+    static SymbolNameIndexPtr getSymbolIndex(PROCESS_DEBUG_ID id = -1);
+    static void resetSymbolIndex(MEMOFFSET_64 moduleBase, PROCESS_DEBUG_ID id = -1);
 };
 
 ///////////////////////////////////////////////////////////////////////////////
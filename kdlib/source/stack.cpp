@@ -4,56 +4,10 @@
 #include "kdlib\dbgengine.h"
 
 #include "stackimpl.h"
+#include "processmon.h"
 
 namespace kdlib {
 
-typedef std::pair<MEMOFFSET_64, MEMOFFSET_64>   DebugRange;
-
-namespace {
-
-///////////////////////////////////////////////////////////////////////////////
-
-DebugRange getFuncDebugRange(SymbolPtr& sym)
-{
-    SymbolPtrList lstFuncDebugStart;
-    SymbolPtrList lstFuncDebugEnd;
-
-    try
-    {
-        lstFuncDebugStart = sym->findChildren(SymTagFuncDebugStart);
-        if ( lstFuncDebugStart.empty() )
-            return std::make_pair(0, 0);
-
-        lstFuncDebugEnd = sym->findChildren(SymTagFuncDebugEnd);
-        if ( lstFuncDebugEnd.empty() )
-            return std::make_pair(0, 0);
-
-        return std::make_pair( (*lstFuncDebugStart.begin())->getVa(), (*lstFuncDebugEnd.begin())->getVa());
-    }
-    catch (const SymbolException&)
-    {
-    }
-
-    return std::make_pair(0, 0);
-}
-
-DebugRange getBlockRange(SymbolPtr& sym)
-{
-    MEMOFFSET_64   blockBegin = sym->getVa();
-    MEMOFFSET_64   blockEnd = blockBegin + sym->getSize();
-
-    return std::make_pair(blockBegin, blockEnd);
-}
-
-bool inDebugRange( const DebugRange& range, MEMOFFSET_64 offset)
-{
-    return range.first <= offset && range.second >= offset;
-}
-
-///////////////////////////////////////////////////////////////////////////////
-
-}
-
 /////////////////////////////////////////////////////////////////////////////////
 //
 //StackFramePtr getStackFrame( MEMOFFSET_64 &ip, MEMOFFSET_64 &ret, MEMOFFSET_64 &fp, MEMOFFSET_64 &sp )
@@ -76,7 +30,7 @@ unsigned long StackFrameImpl::getTypedParamCount()
 {
     try {
 
-        return static_cast<unsigned long>(getParams().size());
+        return static_cast<unsigned long>(getScope()->getParams().size());
 
     }
     catch (DbgException&)
@@ -90,15 +44,12 @@ unsigned long StackFrameImpl::getTypedParamCount()
 
 TypedVarPtr StackFrameImpl::getTypedParam(unsigned long index)
 {
-    SymbolPtrList  vars = getParams();
+    const FrameScope::SymbolVector&  vars = getScope()->getParams();
 
-    SymbolPtrList::iterator it = vars.begin();
     if (index >= vars.size())
         throw IndexException(index);
 
-    std::advance(it, index);
-
-    SymbolPtr  sym = *it;
+    SymbolPtr  sym = vars[index];
 
     unsigned long  location = sym->getLocType();
 
@@ -131,77 +82,58 @@ TypedVarPtr StackFrameImpl::getTypedParam(unsigned long index)
 
 std::wstring  StackFrameImpl::getTypedParamName(unsigned long index)
 {
-    SymbolPtrList  vars = getParams();
+    const FrameScope::SymbolVector&  vars = getScope()->getParams();
 
-    SymbolPtrList::iterator it = vars.begin();
-    std::advance(it, index);
-
-    if (it == vars.end())
+    if (index >= vars.size())
         throw IndexException(index);
 
-    return (*it)->getName();
+    return vars[index]->getName();
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
 TypedVarPtr StackFrameImpl::getTypedParam(const std::wstring& paramName)
 {
-    SymbolPtrList  vars = getParams();
+    SymbolPtr  sym = getScope()->findParam(paramName);
 
-    SymbolPtrList::iterator it = vars.begin();
-    for (; it != vars.end(); ++it)
+    if (!sym)
     {
-        if ((*it)->getName() == paramName)
-        {
-            SymbolPtr  sym = *it;
-
-            unsigned long  location = sym->getLocType();
+        std::wstringstream  sstr;
+        sstr << L'\'' << paramName << L'\'' << L" - function's parameter not found";
+        throw SymbolException(sstr.str());
+    }
 
-            if (location == LocIsEnregistered)
-            {
-                unsigned long  regId = sym->getRegisterId();
+    unsigned long  location = sym->getLocType();
 
-                return loadTypedVar(loadType(sym), getCacheAccessor(m_cpuContext->getRegisterByIndex(regId), L"@" + m_cpuContext->getRegisterName(regId)));
-            }
-            else if (location == LocIsRegRel)
-            {
-                MEMOFFSET_REL relOffset = sym->getOffset();
+    if (location == LocIsEnregistered)
+    {
+        unsigned long  regId = sym->getRegisterId();
 
-                RELREG_ID regRel = sym->getRegRelativeId();
+        return loadTypedVar(loadType(sym), getCacheAccessor(m_cpuContext->getRegisterByIndex(regId), L"@" + m_cpuContext->getRegisterName(regId)));
+    }
+    else if (location == LocIsRegRel)
+    {
+        MEMOFFSET_REL relOffset = sym->getOffset();
 
-                MEMOFFSET_64  offset = getOffset(regRel, relOffset);
+        RELREG_ID regRel = sym->getRegRelativeId();
 
-                return loadTypedVar(loadType(sym), offset);
-            }
-            else if (location == LocIsNull)
-            {
-                return loadTypedVar(loadType(sym), 0);
-            }
+        MEMOFFSET_64  offset = getOffset(regRel, relOffset);
 
-            throw DbgException("unknown variable storage");
-        }
+        return loadTypedVar(loadType(sym), offset);
+    }
+    else if (location == LocIsNull)
+    {
+        return loadTypedVar(loadType(sym), 0);
     }
 
-    std::wstringstream  sstr;
-    sstr << L'\'' << paramName << L'\'' << L" - function's parameter not found";
-    throw SymbolException(sstr.str());
-
+    throw DbgException("unknown variable storage");
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
 bool  StackFrameImpl::findParam(const std::wstring& paramName)
 {
-    SymbolPtrList  vars = getParams();
-
-    SymbolPtrList::iterator it = vars.begin();
-    for (; it != vars.end(); ++it)
-    {
-        if ((*it)->getName() == paramName)
-            return true;
-    }
-    
-    return false;
+    return static_cast<bool>(getScope()->findParam(paramName));
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -210,7 +142,7 @@ unsigned long StackFrameImpl::getLocalVarCount()
 {
     try
     {
-        return static_cast<unsigned long>(getLocalVars().size());
+        return static_cast<unsigned long>(getScope()->getLocalVars().size());
     }
     catch (DbgException&)
     {
@@ -223,15 +155,12 @@ unsigned long StackFrameImpl::getLocalVarCount()
 
 TypedVarPtr StackFrameImpl::getLocalVar(unsigned long index)
 {
-    SymbolPtrList  vars = getLocalVars();
+    const FrameScope::SymbolVector&  vars = getScope()->getLocalVars();
 
-    SymbolPtrList::iterator it = vars.begin();
     if (index >= vars.size())
         throw IndexException(index);
 
-    std::advance( it, index );
-
-    SymbolPtr  sym = *it;
+    SymbolPtr  sym = vars[index];
 
     unsigned long  location = sym->getLocType();
 
@@ -264,76 +193,58 @@ TypedVarPtr StackFrameImpl::getLocalVar(unsigned long index)
 
 std::wstring  StackFrameImpl::getLocalVarName(unsigned long index)
 {
-    SymbolPtrList  vars = getLocalVars();
-
-    SymbolPtrList::iterator it = vars.begin();
-    std::advance( it, index );
+    const FrameScope::SymbolVector&  vars = getScope()->getLocalVars();
 
-    if ( it == vars.end() )
+    if ( index >= vars.size() )
         throw IndexException(index);
 
-    return (*it)->getName();
+    return vars[index]->getName();
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
 TypedVarPtr StackFrameImpl::getLocalVar(const std::wstring& paramName)
 {
-    SymbolPtrList  vars = getLocalVars();
+    SymbolPtr  sym = getScope()->findLocalVar(paramName);
 
-    SymbolPtrList::iterator it = vars.begin();
-    for ( ; it != vars.end(); ++it )
+    if (!sym)
     {
-        if ( (*it)->getName() == paramName )
-        {
-            SymbolPtr  sym = *it;
-
-            unsigned long  location = sym->getLocType();
+        std::wstringstream  sstr;
+        sstr << L'\'' << paramName << L'\'' << L" - local variable not found";
+        throw SymbolException(sstr.str());
+    }
 
-            if (location == LocIsEnregistered)
-            {
-                unsigned long  regId = sym->getRegisterId();
+    unsigned long  location = sym->getLocType();
 
-                return loadTypedVar(loadType(sym), getCacheAccessor(m_cpuContext->getRegisterByIndex(regId), L"@" + m_cpuContext->getRegisterName(regId)));
-            }
-            else if (location == LocIsRegRel)
-            {
-                MEMOFFSET_REL relOffset = sym->getOffset();
+    if (location == LocIsEnregistered)
+    {
+        unsigned long  regId = sym->getRegisterId();
 
-                RELREG_ID regRel = sym->getRegRelativeId();
+        return loadTypedVar(loadType(sym), getCacheAccessor(m_cpuContext->getRegisterByIndex(regId), L"@" + m_cpuContext->getRegisterName(regId)));
+    }
+    else if (location == LocIsRegRel)
+    {
+        MEMOFFSET_REL relOffset = sym->getOffset();
 
-                MEMOFFSET_64  offset = getOffset(regRel, relOffset);
+        RELREG_ID regRel = sym->getRegRelativeId();
 
-                return loadTypedVar(loadType(sym), offset);
-            }
-            else if (location == LocIsNull)
-            {
-                return loadTypedVar(loadType(sym), 0);
-            }
+        MEMOFFSET_64  offset = getOffset(regRel, relOffset);
 
-            throw DbgException("unknown variable storage");
-        }
+        return loadTypedVar(loadType(sym), offset);
+    }
+    else if (location == LocIsNull)
+    {
+        return loadTypedVar(loadType(sym), 0);
     }
 
-    std::wstringstream  sstr;
-    sstr << L'\'' << paramName << L'\'' << L" - local variable not found";
-    throw SymbolException(sstr.str());
+    throw DbgException("unknown variable storage");
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
 bool StackFrameImpl::findLocalVar(const std::wstring& varName)
 {
-    SymbolPtrList  vars = getLocalVars();
-
-    SymbolPtrList::iterator it = vars.begin();
-    for (; it != vars.end(); ++it)
-    {
-        if ((*it)->getName() == varName)
-            return true;
-    }
-
-    return false;
+    return static_cast<bool>(getScope()->findLocalVar(varName));
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -342,7 +253,7 @@ unsigned long StackFrameImpl::getStaticVarCount()
 {
     try 
     {
-        return static_cast<unsigned long>(getStaticVars().size());
+        return static_cast<unsigned long>(getScope()->getStaticVars().size());
     }
     catch (DbgException&)
     {
@@ -355,15 +266,12 @@ unsigned long StackFrameImpl::getStaticVarCount()
 
 TypedVarPtr StackFrameImpl::getStaticVar(unsigned long index)
 {
-    SymbolPtrList  vars = getStaticVars();
+    const FrameScope::SymbolVector&  vars = getScope()->getStaticVars();
 
-    SymbolPtrList::iterator it = vars.begin();
     if (index >= vars.size())
         throw IndexException(index);
 
-    std::advance(it, index);
-
-    SymbolPtr  sym = *it;
+    SymbolPtr  sym = vars[index];
 
     unsigned long  location = sym->getLocType();
 
@@ -380,61 +288,43 @@ TypedVarPtr StackFrameImpl::getStaticVar(unsigned long index)
 
 TypedVarPtr StackFrameImpl::getStaticVar(const std::wstring& paramName)
 {
-    SymbolPtrList  vars = getStaticVars();
+    SymbolPtr  sym = getScope()->findStaticVar(paramName);
 
-    SymbolPtrList::iterator it = vars.begin();
-    for (; it != vars.end(); ++it)
+    if (!sym)
     {
-        if ((*it)->getName() == paramName)
-        {
-            SymbolPtr  sym = *it;
-
-            unsigned long  location = sym->getLocType();
+        std::wstringstream  sstr;
+        sstr << L'\'' << paramName << L'\'' << L" - static local variable not found";
+        throw SymbolException(sstr.str());
+    }
 
-            if (location == LocIsStatic)
-            {
-                MEMOFFSET_64  offset = sym->getVa();
-                return loadTypedVar(loadType(sym), offset);
-            }
+    unsigned long  location = sym->getLocType();
 
-            throw DbgException("unknown variable storage");
-        }
+    if (location == LocIsStatic)
+    {
+        MEMOFFSET_64  offset = sym->getVa();
+        return loadTypedVar(loadType(sym), offset);
     }
 
-    std::wstringstream  sstr;
-    sstr << L'\'' << paramName << L'\'' << L" - static local variable not found";
-    throw SymbolException(sstr.str());
+    throw DbgException("unknown variable storage");
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
 std::wstring  StackFrameImpl::getStaticVarName(unsigned long index)
 {
-    SymbolPtrList  vars = getStaticVars();
-
-    SymbolPtrList::iterator it = vars.begin();
-    std::advance(it, index);
+    const FrameScope::SymbolVector&  vars = getScope()->getStaticVars();
 
-    if (it == vars.end())
+    if (index >= vars.size())
         throw IndexException(index);
 
-    return (*it)->getName();
+    return vars[index]->getName();
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
 bool StackFrameImpl::findStaticVar(const std::wstring& varName)
 {
-    SymbolPtrList  vars = getStaticVars();
-
-    SymbolPtrList::iterator it = vars.begin();
-    for (; it != vars.end(); ++it)
-    {
-        if ((*it)->getName() == varName)
-            return true;
-    }
-
-    return false;
+    return static_cast<bool>(getScope()->findStaticVar(varName));
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -506,204 +396,23 @@ void StackFrameImpl::getSourceLine(std::wstring& fileName, unsigned long& lineNo
 
 /////////////////////////////////////////////////////////////////////////////
 
-SymbolPtrList  StackFrameImpl::getLocalVars()
+FrameScopePtr StackFrameImpl::getScope()
 {
+    if ( m_scope )
+        return m_scope;
 
-    SymbolPtrList  lst;
-
-    try {
-
-        ModulePtr mod  = loadModule(m_ip);
-
-        MEMDISPLACEMENT displacemnt;
-        SymbolPtr symFunc = mod->getSymbolByVa( m_ip, SymTagFunction, &displacemnt );
-
-        DebugRange  debugRange = getFuncDebugRange(symFunc);
-
-        if ( !inDebugRange(debugRange, m_ip) )
-            return lst;
-
-        //find var in current scope
-        SymbolPtrList symList = symFunc->findChildrenByRVA(SymTagData, static_cast<MEMOFFSET_32>(m_ip - mod->getBase()));
-
-        SymbolPtrList::iterator it;
-        for ( it = symList.begin(); it != symList.end(); it++ )
-        {
-            if ( (*it)->getDataKind() == DataIsLocal  )
-                lst.push_back( *it );
-        }
-
-        //find inners scopes
-        SymbolPtrList scopeList = symFunc->findChildren(SymTagBlock);
-        SymbolPtrList::iterator itScope = scopeList.begin();
-
-        for (; itScope != scopeList.end(); ++itScope)
-        {
-            SymbolPtrList  innerVars = getBlockLocalVars(*itScope);
- 
-            lst.insert( lst.end(), innerVars.begin(), innerVars.end() );
-        }
-
-    }
-    catch(SymbolException&)
-    {
-    }
-
-
-    return lst;
-}
-
-/////////////////////////////////////////////////////////////////////////////
-
-SymbolPtrList StackFrameImpl::getParams()
-{
-    SymbolPtrList  lst;
-
-    try 
-    {
-
-        ModulePtr mod = loadModule(m_ip);
-
-        MEMDISPLACEMENT displacemnt;
-        SymbolPtr symFunc = mod->getSymbolByVa(m_ip, SymTagFunction, &displacemnt);
-
-
-        // find var in current scope
-        SymbolPtrList symList = symFunc->findChildrenByRVA(SymTagData, static_cast<MEMOFFSET_32>(m_ip - mod->getBase()));
-
-        SymbolPtrList::iterator it;
-        for (it = symList.begin(); it != symList.end(); it++)
-        {
-            unsigned long dataKind = (*it)->getDataKind();
-
-            if ( dataKind == DataIsParam || dataKind == DataIsObjectPtr )
-                lst.push_back(*it);
-        }
-
-    }
-    catch(SymbolException&)
-    {
-    }
-
-    return lst;
-}
-
-/////////////////////////////////////////////////////////////////////////////
-
-SymbolPtrList StackFrameImpl::getStaticVars()
-{
     ModulePtr mod = loadModule(m_ip);
 
-    MEMDISPLACEMENT displacemnt;
-    SymbolPtr symFunc = mod->getSymbolByVa(m_ip, SymTagFunction, &displacemnt);
-
-    SymbolPtrList  lst;
-
-    DebugRange  debugRange = getFuncDebugRange(symFunc);
-
-    if (!inDebugRange(debugRange, m_ip))
-        return lst;
-
-    //find var in current scope
-    SymbolPtrList symList = symFunc->findChildrenByRVA(SymTagData, static_cast<MEMOFFSET_32>(m_ip - mod->getBase()));
-
-    SymbolPtrList::iterator it;
-    for (it = symList.begin(); it != symList.end(); it++)
-    {
-        if ((*it)->getDataKind() == DataIsStaticLocal)
-        {
-            std::wstring  name = (*it)->getName();
-            if (!name.empty())
-                lst.push_back(*it);
-        }
-    }
-
-    //find inners scopes
-    SymbolPtrList scopeList = symFunc->findChildren(SymTagBlock);
-    SymbolPtrList::iterator itScope = scopeList.begin();
-
-    for (; itScope != scopeList.end(); ++itScope)
-    {
-        SymbolPtrList  innerVars = getBlockStaticVars(*itScope);
-
-        lst.insert(lst.end(), innerVars.begin(), innerVars.end());
-    }
+    m_scope = ProcessMonitor::getFrameScopeCache()->get(mod, m_ip);
 
-    return lst;
+    return m_scope;
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
-SymbolPtrList  StackFrameImpl::getBlockLocalVars(SymbolPtr& sym)
+FrameScopeStatistics getFrameScopeStatistics()
 {
-    SymbolPtrList  lst;
-
-    DebugRange  debugRange = getBlockRange(sym);
-
-    if ( !inDebugRange(debugRange, m_ip) )
-        return lst;
-
-    // find var in current scope
-    SymbolPtrList symList = sym->findChildren(SymTagData);
-
-    SymbolPtrList::iterator it;
-    for ( it = symList.begin(); it != symList.end(); it++ )
-    {
-        if ( (*it)->getDataKind() == DataIsLocal  )
-            lst.push_back( *it );
-    }
-
-    // find inners scopes
-    SymbolPtrList scopeList = sym->findChildren(SymTagBlock);
-    SymbolPtrList::iterator itScope = scopeList.begin();
-
-    for (; itScope != scopeList.end(); ++itScope)
-    {
-        SymbolPtrList  innerVars = getBlockLocalVars(*itScope);
-
-        lst.insert( lst.end(), innerVars.begin(), innerVars.end() );
-    }
-
-    return lst;
-}
-
-/////////////////////////////////////////////////////////////////////////////
-
-SymbolPtrList  StackFrameImpl::getBlockStaticVars(SymbolPtr& sym)
-{
-    SymbolPtrList  lst;
-
-    DebugRange  debugRange = getBlockRange(sym);
-
-    if (!inDebugRange(debugRange, m_ip))
-        return lst;
-
-    // find var in current scope
-    SymbolPtrList symList = sym->findChildren(SymTagData);
-
-    SymbolPtrList::iterator it;
-    for (it = symList.begin(); it != symList.end(); it++)
-    {
-        if ((*it)->getDataKind() == DataIsStaticLocal)
-        {
-            std::wstring  name = (*it)->getName();
-            if (!name.empty())
-                lst.push_back(*it);
-        }
-    }
-
-    // find inners scopes
-    SymbolPtrList scopeList = sym->findChildren(SymTagBlock);
-    SymbolPtrList::iterator itScope = scopeList.begin();
-
-    for (; itScope != scopeList.end(); ++itScope)
-    {
-        SymbolPtrList  innerVars = getBlockStaticVars(*itScope);
-
-        lst.insert(lst.end(), innerVars.begin(), innerVars.end());
-    }
-
-    return lst;
+    return ProcessMonitor::getFrameScopeCache()->getStatistics();
 }
 
 /////////////////////////////////////////////////////////////////////////////
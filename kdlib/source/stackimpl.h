@@ -4,6 +4,8 @@
 
 #include <boost/enable_shared_from_this.hpp>
 
+#include "framescope.h"
+
 namespace kdlib {
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -112,12 +114,7 @@ public:
 
 private:
 
-    SymbolPtrList getLocalVars();
-    SymbolPtrList getParams();
-    SymbolPtrList getStaticVars();
-
-    SymbolPtrList getBlockLocalVars(SymbolPtr& sym);
-    SymbolPtrList getBlockStaticVars(SymbolPtr& sym);
+    FrameScopePtr getScope();
 
     MEMOFFSET_64 getOffset(unsigned long regRel, MEMOFFSET_REL relOffset);
 
@@ -128,6 +125,7 @@ private:
     CPUContextPtr  m_cpuContext;
     unsigned long  m_number;
     unsigned long  m_inlineIndex;
+    FrameScopePtr  m_scope;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,115 @@
+#include "stdafx.h"
+
+#include <vector>
+
+#include "kdlib/exceptions.h"
+
+#include "symindex.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool SymbolNameIndex::isModuleIndexed(MEMOFFSET_64 moduleBase)
+{
+    boost::shared_lock<boost::shared_mutex>  l(m_lock);
+
+    return m_modules.find(moduleBase) != m_modules.end();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool SymbolNameIndex::isModuleComplete(MEMOFFSET_64 moduleBase)
+{
+    boost::shared_lock<boost::shared_mutex>  l(m_lock);
+
+    std::map<MEMOFFSET_64, bool>::const_iterator  it = m_modules.find(moduleBase);
+
+    return it != m_modules.end() && it->second;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SymbolNameIndex::insertModule(MEMOFFSET_64 moduleBase, const SymbolPtr& symbolScope, bool complete)
+{
+    std::vector<std::wstring>  names;
+
+    try
+    {
+        SymbolPtrList  symbols = symbolScope->findChildren(SymTagNull);
+
+        names.reserve(symbols.size());
+
+        for (SymbolPtrList::iterator it = symbols.begin(); it != symbols.end(); ++it)
+        {
+            std::wstring  name = (*it)->getName();
+            if (!name.empty())
+                names.push_back(name);
+        }
+    }
+    catch (const SymbolException&)
+    {
+        // the module stays out of the index, its names are searched by the caller
+        return;
+    }
+
+    boost::unique_lock<boost::shared_mutex>  l(m_lock);
+
+    if (!m_modules.insert(std::make_pair(moduleBase, complete)).second)
+        return;
+
+    for (std::vector<std::wstring>::iterator it = names.begin(); it != names.end(); ++it)
+    {
+        std::pair<NameMap::iterator, bool>  res = m_names.insert(std::make_pair(*it, moduleBase));
+
+        if (!res.second && res.first->second != moduleBase)
+            res.first->second = ambiguousName;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SymbolNameIndex::removeModule(MEMOFFSET_64 moduleBase)
+{
+    boost::unique_lock<boost::shared_mutex>  l(m_lock);
+
+    if (m_modules.erase(moduleBase) == 0)
+        return;
+
+    // the ambiguous names stay ambiguous
+    for (NameMap::iterator it = m_names.begin(); it != m_names.end(); )
+    {
+        if (it->second == moduleBase)
+            it = m_names.erase(it);
+        else
+            ++it;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SymbolNameIndex::invalidate()
+{
+    boost::unique_lock<boost::shared_mutex>  l(m_lock);
+
+    m_names.clear();
+    m_modules.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool SymbolNameIndex::find(const std::wstring& name, MEMOFFSET_64& moduleBase)
+{
+    boost::shared_lock<boost::shared_mutex>  l(m_lock);
+
+    NameMap::const_iterator  it = m_names.find(name);
+    if (it == m_names.end() || it->second == ambiguousName)
+        return false;
+
+    moduleBase = it->second;
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
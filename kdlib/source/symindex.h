@@ -0,0 +1,58 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <unordered_map>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include "kdlib/dbgtypedef.h"
+#include "kdlib/symengine.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+class SymbolNameIndex;
+typedef boost::shared_ptr<SymbolNameIndex>  SymbolNameIndexPtr;
+
+// Global names of the indexed modules of a process: name -> module base.
+// Names defined in several modules are marked as ambiguous, such names and
+// the names missing in the index are left to the caller to resolve. A module
+// with export symbols only is indexed partially: its types are not known
+class SymbolNameIndex : private boost::noncopyable
+{
+public:
+
+    bool isModuleIndexed(MEMOFFSET_64 moduleBase);
+
+    // all names of the module are in the index
+    bool isModuleComplete(MEMOFFSET_64 moduleBase);
+
+    // the names are collected without the lock, lookups are not blocked.
+    // A module is not indexed if its names can not be enumerated
+    void insertModule(MEMOFFSET_64 moduleBase, const SymbolPtr& symbolScope, bool complete);
+
+    void removeModule(MEMOFFSET_64 moduleBase);
+
+    void invalidate();
+
+    // returns true if only one indexed module defines the name
+    bool find(const std::wstring& name, MEMOFFSET_64& moduleBase);
+
+private:
+
+    static const MEMOFFSET_64  ambiguousName = 0;
+
+    typedef std::unordered_map<std::wstring, MEMOFFSET_64>  NameMap;
+
+    boost::shared_mutex  m_lock;
+    NameMap  m_names;
+    std::map<MEMOFFSET_64, bool>  m_modules;  // module base -> complete
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
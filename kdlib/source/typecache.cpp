@@ -0,0 +1,198 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <functional>
+#include <tuple>
+
+#include "typecache.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t TypeInfoCache::KeyHash::operator()(const Key& key) const
+{
+    size_t  hash = std::hash<std::wstring>()(key.name);
+    return hash ^ ( std::hash<MEMOFFSET_64>()(key.moduleBase) + 0x9e3779b9 + (hash << 6) + (hash >> 2) );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypeInfoCache::TypeInfoCache(size_t maxTypes) :
+    m_maxTypes(maxTypes)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypeInfoCache::Shard& TypeInfoCache::getShard(const Key& key)
+{
+    return m_shards[ ( KeyHash()(key) >> 8 ) % shardCount ];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t TypeInfoCache::getShardLimit() const
+{
+    size_t  maxTypes = m_maxTypes;
+
+    if ( maxTypes == 0 )
+        return 0;
+
+    return (std::max)( maxTypes / shardCount, static_cast<size_t>(1) );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypeInfoPtr TypeInfoCache::find(MEMOFFSET_64 moduleBase, const std::wstring& name)
+{
+    TypeInfoPtr  typeInfo;
+    lookup(moduleBase, name, typeInfo);
+    return typeInfo;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool TypeInfoCache::lookup(MEMOFFSET_64 moduleBase, const std::wstring& name, TypeInfoPtr& typeInfo)
+{
+    Key  key = { moduleBase, name };
+    Shard&  shard = getShard(key);
+
+    boost::shared_lock<boost::shared_mutex>  l(shard.lock);
+
+    EntryMap::iterator  it = shard.entries.find(key);
+    if ( it == shard.entries.end() )
+    {
+        ++shard.misses;
+        return false;
+    }
+
+    ++shard.hits;
+    it->second.referenced.store(true, boost::memory_order_relaxed);
+    typeInfo = it->second.typeInfo;
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TypeInfoCache::insert(MEMOFFSET_64 moduleBase, const std::wstring& name, const TypeInfoPtr& typeInfo)
+{
+    size_t  limit = getShardLimit();
+    if ( limit == 0 )
+        return;
+
+    Key  key = { moduleBase, name };
+    Shard&  shard = getShard(key);
+
+    boost::unique_lock<boost::shared_mutex>  l(shard.lock);
+
+    if ( shard.entries.find(key) != shard.entries.end() )
+        return;
+
+    shrink(shard, limit - 1);
+
+    shard.entries.emplace( std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(typeInfo) );
+    shard.clock.push_back(key);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TypeInfoCache::shrink(Shard& shard, size_t maxTypes)
+{
+    while ( shard.entries.size() > maxTypes && !shard.clock.empty() )
+    {
+        Key  key = shard.clock.front();
+        shard.clock.pop_front();
+
+        EntryMap::iterator  it = shard.entries.find(key);
+        if ( it == shard.entries.end() )
+            continue;
+
+        if ( it->second.referenced.exchange(false, boost::memory_order_relaxed) )
+        {
+            shard.clock.push_back(key);
+            continue;
+        }
+
+        shard.entries.erase(it);
+        ++shard.evictions;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TypeInfoCache::invalidate()
+{
+    for ( size_t i = 0; i < shardCount; ++i )
+    {
+        boost::unique_lock<boost::shared_mutex>  l(m_shards[i].lock);
+        m_shards[i].entries.clear();
+        m_shards[i].clock.clear();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TypeInfoCache::invalidate(MEMOFFSET_64 moduleBase)
+{
+    for ( size_t i = 0; i < shardCount; ++i )
+    {
+        Shard&  shard = m_shards[i];
+
+        boost::unique_lock<boost::shared_mutex>  l(shard.lock);
+
+        for ( EntryMap::iterator it = shard.entries.begin(); it != shard.entries.end(); )
+        {
+            if ( it->first.moduleBase == moduleBase || it->first.moduleBase == 0 )
+                it = shard.entries.erase(it);
+            else
+                ++it;
+        }
+
+        shard.clock.erase(
+            std::remove_if( shard.clock.begin(), shard.clock.end(),
+                [moduleBase](const Key& key) { return key.moduleBase == moduleBase || key.moduleBase == 0; } ),
+            shard.clock.end() );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TypeInfoCache::setLimit(size_t maxTypes)
+{
+    m_maxTypes = maxTypes;
+
+    size_t  limit = getShardLimit();
+
+    for ( size_t i = 0; i < shardCount; ++i )
+    {
+        boost::unique_lock<boost::shared_mutex>  l(m_shards[i].lock);
+        shrink(m_shards[i], limit);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypeCacheStatistics TypeInfoCache::getStatistics()
+{
+    TypeCacheStatistics  stat = {};
+
+    for ( size_t i = 0; i < shardCount; ++i )
+    {
+        Shard&  shard = m_shards[i];
+
+        boost::shared_lock<boost::shared_mutex>  l(shard.lock);
+
+        stat.hits += shard.hits;
+        stat.misses += shard.misses;
+        stat.evictions += shard.evictions;
+        stat.cachedTypes += shard.entries.size();
+    }
+
+    stat.maxTypes = getShardLimit() * shardCount;
+
+    return stat;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include "kdlib/dbgtypedef.h"
+#include "kdlib/typeinfo.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+class TypeInfoCache;
+typedef boost::shared_ptr<TypeInfoCache>  TypeInfoCachePtr;
+
+// Bounded cache of types loaded by name, keyed by ( module base, type name ).
+// A zero module base is used for names resolved over all modules. A null
+// type marks a name which is known to be missing in the module.
+// The cache is split into shards with reader-writer locks, so lookups from
+// different threads do not serialize; each shard evicts with the CLOCK
+// ( second chance ) policy
+class TypeInfoCache : private boost::noncopyable
+{
+public:
+
+    static const size_t  shardCount = 16;
+
+    explicit TypeInfoCache(size_t maxTypes);
+
+    TypeInfoPtr find(MEMOFFSET_64 moduleBase, const std::wstring& name);
+
+    // returns false if the name is not cached, a cached missing name gives a null type
+    bool lookup(MEMOFFSET_64 moduleBase, const std::wstring& name, TypeInfoPtr& typeInfo);
+
+    void insert(MEMOFFSET_64 moduleBase, const std::wstring& name, const TypeInfoPtr& typeInfo);
+
+    void invalidate();
+
+    // drops the module's types and all types resolved over all modules
+    void invalidate(MEMOFFSET_64 moduleBase);
+
+    void setLimit(size_t maxTypes);
+
+    TypeCacheStatistics getStatistics();
+
+private:
+
+    struct Key {
+        MEMOFFSET_64  moduleBase;
+        std::wstring  name;
+
+        bool operator==(const Key& key) const {
+            return moduleBase == key.moduleBase && name == key.name;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Entry {
+        TypeInfoPtr  typeInfo;
+        boost::atomic<bool>  referenced;
+
+        explicit Entry(const TypeInfoPtr& type) :
+            typeInfo(type),
+            referenced(false)
+            {}
+    };
+
+    typedef std::unordered_map<Key, Entry, KeyHash>  EntryMap;
+
+    struct Shard {
+        boost::shared_mutex  lock;
+        EntryMap  entries;
+        std::deque<Key>  clock;
+        boost::atomic<unsigned long long>  hits;
+        boost::atomic<unsigned long long>  misses;
+        boost::atomic<unsigned long long>  evictions;
+
+        Shard() :
+            hits(0),
+            misses(0),
+            evictions(0)
+            {}
+    };
+
+    Shard& getShard(const Key& key);
+
+    void shrink(Shard& shard, size_t maxTypes);
+
+    size_t getShardLimit() const;
+
+    Shard  m_shards[shardCount];
+    boost::atomic<size_t>  m_maxTypes;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
@@ -177,6 +177,66 @@ TypedValue castUdt(TypeInfoPtr& destType, const TypedValue& arg)
     NOT_IMPLEMENTED();
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+BaseTypeKind getScalarKind( const NumVariant& var )
+{
+    if ( var.isChar() )
+        return BaseTypeInt1B;
+
+    if ( var.isUChar() )
+        return BaseTypeUInt1B;
+
+    if ( var.isShort() )
+        return BaseTypeInt2B;
+
+    if ( var.isUShort() )
+        return BaseTypeUInt2B;
+
+    if ( var.isLong() )
+        return BaseTypeInt4B;
+
+    if ( var.isULong() || var.isUInt() )
+        return BaseTypeUInt4B;
+
+    if ( var.isLongLong() )
+        return BaseTypeInt8B;
+
+    if ( var.isULongLong() )
+        return BaseTypeUInt8B;
+
+    if ( var.isFloat() )
+        return BaseTypeFloat;
+
+    if ( var.isDouble() )
+        return BaseTypeDouble;
+
+    return BaseTypeBool;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypeInfoPtr getTypeByName( const std::wstring &typeName )
+{
+    std::wstring     moduleName;
+    std::wstring     symName;
+
+    splitSymName( typeName, moduleName, symName );
+
+    ModulePtr  module;
+
+    if ( moduleName.empty() )
+    {
+        MEMOFFSET_64 moduleOffset = findModuleBySymbol( symName );
+        module = loadModule( moduleOffset );
+    }
+    else
+    {
+        module = loadModule( moduleName );
+    }
+
+    return module->getTypeByName( symName );
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -400,26 +460,130 @@ TypedVarPtr containingRecord( MEMOFFSET_64 offset, TypeInfoPtr &typeInfo, const
 
 ///////////////////////////////////////////////////////////////////////////////
 
-TypedVarList loadTypedVarList( MEMOFFSET_64 offset, const std::wstring &typeName, const std::wstring &fieldName )
+class TypedVarListWalkerImpl : public TypedVarListWalker
 {
-    std::wstring     moduleName;
-    std::wstring     symName;
+public:
 
-    splitSymName( typeName, moduleName, symName );
+    TypedVarListWalkerImpl( MEMOFFSET_64 head, const TypeInfoPtr &typeInfo, const std::wstring &fieldName, size_t maxLength ) :
+        m_typeInfo( typeInfo ),
+        m_head( addr64(head) ),
+        m_maxLength( maxLength ),
+        m_count( 0 ),
+        m_cycleMark( 0 ),
+        m_cyclePower( 1 ),
+        m_cycleSteps( 0 )
+    {
+        TypeInfoPtr  fieldTypeInfo = typeInfo->getElement( fieldName );
 
-     ModulePtr  module;
+        m_ptrSize = fieldTypeInfo->getPtrSize();
+        m_linkOffset = typeInfo->getElementOffset( fieldName );
+        m_entrySize = typeInfo->getSize();
 
-    if ( moduleName.empty() )
+        // the link points to the next entry or to the link field of the next entry
+        m_linkShift = fieldTypeInfo->getName() == ( typeInfo->getName() + L"*" ) ? 0 : m_linkOffset;
+
+        m_link = ptrPtr( m_head, m_ptrSize );
+    }
+
+    TypedVarPtr next() override
     {
-        MEMOFFSET_64 moduleOffset = findModuleBySymbol( symName );
-        module = loadModule( moduleOffset );
+        if ( m_link == m_head || m_link == 0 )
+            return TypedVarPtr();
+
+        if ( m_count >= m_maxLength )
+            throw DbgException( "list is longer than the length limit" );
+
+        checkCycle();
+
+        // the whole entry is read with one request, the link is taken from it
+        DataAccessorPtr  entry = getMemoryAccessor( m_link - m_linkShift, m_entrySize, true );
+
+        m_link = readLink( entry );
+        ++m_count;
+
+        return m_typeInfo->getVar( entry );
     }
-    else
+
+    size_t getCount() const override
     {
-        module = loadModule( moduleName );
+        return m_count;
     }
 
-    TypeInfoPtr typeInfo = module->getTypeByName( symName );
+private:
+
+    // Brent's algorithm: the link is compared with a mark moved to the
+    // current link after 1, 2, 4 ... steps, so no extra reads are needed
+    void checkCycle()
+    {
+        if ( m_link == m_cycleMark )
+            throw DbgException( "list has a cycle" );
+
+        if ( ++m_cycleSteps == m_cyclePower )
+        {
+            m_cycleMark = m_link;
+            m_cyclePower *= 2;
+            m_cycleSteps = 0;
+        }
+    }
+
+    MEMOFFSET_64 readLink( const DataAccessorPtr &entry ) const
+    {
+        if ( m_ptrSize == 4 )
+        {
+            unsigned long  link;
+            entry->readRaw( &link, sizeof(link), m_linkOffset );
+            return addr64( link );
+        }
+
+        if ( m_ptrSize == 8 )
+        {
+            unsigned long long  link;
+            entry->readRaw( &link, sizeof(link), m_linkOffset );
+            return addr64( link );
+        }
+
+        throw DbgException( "unknown pointer size" );
+    }
+
+    TypeInfoPtr  m_typeInfo;
+    MEMOFFSET_64  m_head;
+    MEMOFFSET_64  m_link;
+    MEMOFFSET_REL  m_linkOffset;
+    MEMOFFSET_REL  m_linkShift;
+    size_t  m_entrySize;
+    size_t  m_ptrSize;
+    size_t  m_maxLength;
+    size_t  m_count;
+
+    MEMOFFSET_64  m_cycleMark;
+    size_t  m_cyclePower;
+    size_t  m_cycleSteps;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypedVarListWalkerPtr walkTypedVarList( MEMOFFSET_64 offset, const std::wstring &typeName, const std::wstring &fieldName, size_t maxLength )
+{
+    TypeInfoPtr typeInfo = getTypeByName( typeName );
+
+    return walkTypedVarList( offset, typeInfo, fieldName, maxLength );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypedVarListWalkerPtr walkTypedVarList( MEMOFFSET_64 offset, TypeInfoPtr &typeInfo, const std::wstring &fieldName, size_t maxLength )
+{
+    if ( !typeInfo )
+        throw DbgException( "type info is null" );
+
+    return TypedVarListWalkerPtr( new TypedVarListWalkerImpl( offset, typeInfo, fieldName, maxLength ) );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypedVarList loadTypedVarList( MEMOFFSET_64 offset, const std::wstring &typeName, const std::wstring &fieldName )
+{
+    TypeInfoPtr typeInfo = getTypeByName( typeName );
 
     return loadTypedVarList( offset, typeInfo, fieldName );
 }
@@ -431,25 +595,13 @@ TypedVarList loadTypedVarList( MEMOFFSET_64 offset, TypeInfoPtr &typeInfo, const
     if ( !typeInfo )
         throw DbgException( "type info is null" );
 
-    offset = addr64(offset);
+    TypedVarListWalkerPtr  walker = walkTypedVarList( offset, typeInfo, fieldName );
 
     TypedVarList  lst;
     lst.reserve(100);
 
-    MEMOFFSET_64  entryAddress = 0;
-    TypeInfoPtr  fieldTypeInfo = typeInfo->getElement( fieldName );
-    size_t  psize = fieldTypeInfo->getPtrSize();
-
-    if ( fieldTypeInfo->getName() == ( typeInfo->getName() + L"*" ) )
-    {
-        for( entryAddress = ptrPtr(offset, psize); addr64(entryAddress) != offset && entryAddress != NULL; entryAddress = ptrPtr( entryAddress + typeInfo->getElementOffset(fieldName), psize ) )
-            lst.push_back( loadTypedVar( typeInfo, entryAddress ) );
-    }
-    else
-    {
-        for( entryAddress = ptrPtr( offset, psize ); addr64(entryAddress) != offset && entryAddress != NULL; entryAddress = ptrPtr( entryAddress, psize ) )
-            lst.push_back( containingRecord( entryAddress, typeInfo, fieldName ) );
-    }
+    for ( TypedVarPtr entry = walker->next(); entry; entry = walker->next() )
+        lst.push_back( entry );
 
     return lst;
 }
@@ -492,10 +644,27 @@ TypedVarList loadTypedVarArray( MEMOFFSET_64 offset, TypeInfoPtr &typeInfo, size
     offset = addr64(offset); 
 
     TypedVarList  lst;
-    lst.reserve(100);
+    lst.reserve(number);
+
+    size_t  elementSize = typeInfo->getSize();
+
+    if ( elementSize == 0 )
+    {
+        for( size_t i = 0; i < number; ++i )
+            lst.push_back( loadTypedVar( typeInfo, offset ) );
+
+        return lst;
+    }
+
+    if ( number > static_cast<size_t>(-1) / elementSize )
+        throw DbgException( "array is too large" );
+
+    // the whole array is read with one request on the first access,
+    // the elements are the slices of this buffer
+    DataAccessorPtr  arrayData = getMemoryAccessor( offset, elementSize * number, true );
 
     for( size_t i = 0; i < number; ++i )
-        lst.push_back( loadTypedVar( typeInfo, offset + i * typeInfo->getSize() ) );
+        lst.push_back( typeInfo->getVar( arrayData->copy( i * elementSize, elementSize ) ) );
    
     return lst;
 }
@@ -506,7 +675,7 @@ TypedVarPtr loadCharVar( char var )
 {
     DataAccessorPtr  accessor = getCacheAccessor( sizeof(char) );
     accessor->writeSignByte(var);
-    return loadType(L"Int1B")->getVar(accessor);
+    return loadBaseType(BaseTypeInt1B)->getVar(accessor);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -515,7 +684,7 @@ TypedVarPtr loadShortVar( short var )
 {
     DataAccessorPtr  accessor = getCacheAccessor( sizeof(short) );
     accessor->writeSignWord(var);
-    return loadType(L"Int2B")->getVar(accessor);
+    return loadBaseType(BaseTypeInt2B)->getVar(accessor);
    // return getTypedVar( loadType(L"Int2B"), accessor );
 }
 
@@ -525,7 +694,7 @@ TypedVarPtr loadLongVar( long var )
 {
     DataAccessorPtr  accessor = getCacheAccessor( sizeof(long) );
     accessor->writeSignDWord(var);
-    return loadType(L"Int4B")->getVar(accessor);
+    return loadBaseType(BaseTypeInt4B)->getVar(accessor);
     //return getTypedVar( loadType(L"Int4B"), accessor );
 }
 
@@ -535,7 +704,7 @@ TypedVarPtr loadLongLongVar( long long var )
 {
     DataAccessorPtr  accessor = getCacheAccessor( sizeof(long long) );
     accessor->writeSignQWord(var);
-    return loadType(L"Int8B")->getVar(accessor);
+    return loadBaseType(BaseTypeInt8B)->getVar(accessor);
     //return getTypedVar( loadType(L"Int8B"), accessor );
 }
 
@@ -545,7 +714,7 @@ TypedVarPtr loadUCharVar( unsigned char var )
 {
     DataAccessorPtr  accessor = getCacheAccessor( sizeof(unsigned char) );
     accessor->writeByte(var);
-    return loadType(L"UInt1B")->getVar(accessor);
+    return loadBaseType(BaseTypeUInt1B)->getVar(accessor);
     //return getTypedVar( loadType(L"UInt1B"), accessor );
 }
 
@@ -555,7 +724,7 @@ TypedVarPtr loadUShortVar( unsigned short var )
 {
     DataAccessorPtr  accessor = getCacheAccessor( sizeof(unsigned short) );
     accessor->writeWord(var);
-    return loadType(L"UInt2B")->getVar(accessor);
+    return loadBaseType(BaseTypeUInt2B)->getVar(accessor);
     //return getTypedVar( loadType(L"UInt2B"), accessor );
 }
 
@@ -565,7 +734,7 @@ TypedVarPtr loadULongVar( unsigned long var )
 {
     DataAccessorPtr  accessor = getCacheAccessor( sizeof(unsigned long) );
     accessor->writeDWord(var);
-    return loadType(L"UInt4B")->getVar(accessor);
+    return loadBaseType(BaseTypeUInt4B)->getVar(accessor);
     //return getTypedVar( loadType(L"UInt4B"), accessor );
 }
 
@@ -575,7 +744,7 @@ TypedVarPtr loadULongLongVar( unsigned long long var )
 {
     DataAccessorPtr  accessor = getCacheAccessor( sizeof(unsigned long long) );
     accessor->writeQWord(var);
-    return loadType(L"UInt8B")->getVar(accessor);
+    return loadBaseType(BaseTypeUInt8B)->getVar(accessor);
     //return getTypedVar( loadType(L"UInt8B"), accessor );
 }
 
@@ -585,7 +754,7 @@ TypedVarPtr loadIntVar( int var )
 {
     DataAccessorPtr  accessor = getCacheAccessor( sizeof(int) );
     accessor->writeSignDWord(var);
-    return loadType(L"Int4B")->getVar(accessor);
+    return loadBaseType(BaseTypeInt4B)->getVar(accessor);
     //return getTypedVar( loadType(L"Int4B"), accessor );
 }
 
@@ -595,7 +764,7 @@ TypedVarPtr loadUIntVar( unsigned int var )
 {
     DataAccessorPtr  accessor = getCacheAccessor( sizeof(unsigned int) );
     accessor->writeDWord(var);
-    return loadType(L"UInt4B")->getVar(accessor);
+    return loadBaseType(BaseTypeUInt4B)->getVar(accessor);
     //return getTypedVar( loadType(L"UInt4B"), accessor );
 }
 
@@ -605,7 +774,7 @@ TypedVarPtr loadWCharVar(wchar_t var)
 {
     DataAccessorPtr  accessor = getCacheAccessor( sizeof(wchar_t) );
     accessor->writeWord(var);
-    return loadType(L"WChar")->getVar(accessor);
+    return loadBaseType(BaseTypeWChar)->getVar(accessor);
     //return getTypedVar( loadType(L"WChar"), accessor );
 }
 
@@ -615,7 +784,7 @@ TypedVarPtr loadBoolVar(bool var)
 {
     DataAccessorPtr  accessor = getCacheAccessor( sizeof(char) );
     accessor->writeByte(var);
-    return loadType(L"Bool")->getVar(accessor);
+    return loadBaseType(BaseTypeBool)->getVar(accessor);
     //return getTypedVar( loadType(L"Bool"), accessor );
 }
 
@@ -633,7 +802,7 @@ TypedVarPtr loadFloatVar( float var )
 {
     DataAccessorPtr  accessor = getCacheAccessor( sizeof(float) );
     accessor->writeFloat(var);
-    return loadType(L"Float")->getVar(accessor);
+    return loadBaseType(BaseTypeFloat)->getVar(accessor);
     //return getTypedVar( loadType(L"Float"), accessor );
 }
 
@@ -643,7 +812,7 @@ TypedVarPtr loadDoubleVar( double var )
 {
     DataAccessorPtr  accessor = getCacheAccessor( sizeof(double) );
     accessor->writeDouble(var);
-    return loadType(L"Double")->getVar(accessor);
+    return loadBaseType(BaseTypeDouble)->getVar(accessor);
     //return getTypedVar( loadType(L"Double"), accessor );
 }
 
@@ -677,53 +846,46 @@ TypedVarPtr TypedVarImp::castTo(const TypeInfoPtr &typeInfo) const
 
 NumVariant TypedVarBase::getValue() const
 {
-    if ( m_typeInfo->getName() == L"Char" )
-        return NumVariant( m_varData->readSignByte() );
-
-    if ( m_typeInfo->getName() == L"WChar" )
-        return NumVariant( m_varData->readSignWord() );
-
-    if ( m_typeInfo->getName() == L"Long" )
-        return NumVariant( m_varData->readSignDWord() );
-
-    if ( m_typeInfo->getName() == L"ULong" )
-        return NumVariant( m_varData->readDWord() );
-
-    if ( m_typeInfo->getName() == L"Int1B" )
+    switch ( m_baseKind )
+    {
+    case BaseTypeChar:
+    case BaseTypeInt1B:
         return NumVariant( m_varData->readSignByte() );
 
-    if ( m_typeInfo->getName() == L"UInt1B" )
+    case BaseTypeUInt1B:
         return NumVariant( m_varData->readByte() );
 
-    if ( m_typeInfo->getName() == L"Int2B" )
+    case BaseTypeWChar:
+    case BaseTypeInt2B:
         return NumVariant( m_varData->readSignWord() );
 
-    if ( m_typeInfo->getName() == L"UInt2B" )
+    case BaseTypeUInt2B:
         return NumVariant( m_varData->readWord() );
 
-    if ( m_typeInfo->getName() == L"Int4B" )
+    case BaseTypeLong:
+    case BaseTypeInt4B:
         return NumVariant( m_varData->readSignDWord() );
 
-    if ( m_typeInfo->getName() == L"UInt4B" )
+    case BaseTypeULong:
+    case BaseTypeUInt4B:
+    case BaseTypeHresult:
         return NumVariant( m_varData->readDWord() );
 
-    if ( m_typeInfo->getName() == L"Int8B" )
+    case BaseTypeInt8B:
         return NumVariant( m_varData->readSignQWord() );
 
-    if ( m_typeInfo->getName() == L"UInt8B" )
+    case BaseTypeUInt8B:
         return NumVariant( m_varData->readQWord() );
 
-    if ( m_typeInfo->getName() == L"Float" )
+    case BaseTypeFloat:
         return NumVariant( m_varData->readFloat() );
 
-    if ( m_typeInfo->getName() == L"Double" )
+    case BaseTypeDouble:
         return NumVariant( m_varData->readDouble() );
 
-    if ( m_typeInfo->getName() == L"Bool" )
+    case BaseTypeBool:
         return NumVariant( 0 != m_varData->readByte() );
-
-    if ( m_typeInfo->getName() == L"Hresult" )
-        return NumVariant( m_varData->readDWord() );
+    }
 
     throw TypeException(  m_typeInfo->getName(), L" unsupported based type");
 }
@@ -732,53 +894,44 @@ NumVariant TypedVarBase::getValue() const
 
 void TypedVarBase::setValue(const NumVariant& value)
 {
-    if ( m_typeInfo->getName() == L"Char" )
-        return m_varData->writeSignByte( value.asChar() );
-
-    if ( m_typeInfo->getName() == L"WChar" )
-        return m_varData->writeSignWord(value.asShort() );
-
-    if ( m_typeInfo->getName() == L"Long" )
-        return m_varData->writeSignDWord(value.asLong());
-
-    if ( m_typeInfo->getName() == L"ULong" )
-        return m_varData->writeDWord(value.asULong());
-
-    if ( m_typeInfo->getName() == L"Int1B" )
+    switch ( m_baseKind )
+    {
+    case BaseTypeChar:
+    case BaseTypeInt1B:
         return m_varData->writeSignByte(value.asChar());
-        
-    if ( m_typeInfo->getName() == L"UInt1B" )
+
+    case BaseTypeUInt1B:
+    case BaseTypeBool:
         return m_varData->writeByte(value.asUChar());
 
-    if ( m_typeInfo->getName() == L"Int2B" )
+    case BaseTypeWChar:
+    case BaseTypeInt2B:
         return m_varData->writeSignWord(value.asShort());
 
-    if ( m_typeInfo->getName() == L"UInt2B" )
+    case BaseTypeUInt2B:
         return m_varData->writeWord(value.asUShort());
 
-    if ( m_typeInfo->getName() == L"Int4B" )
+    case BaseTypeLong:
+    case BaseTypeInt4B:
         return m_varData->writeSignDWord(value.asLong());
 
-    if ( m_typeInfo->getName() == L"UInt4B" )
+    case BaseTypeULong:
+    case BaseTypeUInt4B:
+    case BaseTypeHresult:
         return m_varData->writeDWord(value.asULong());
-        
-    if ( m_typeInfo->getName() == L"Int8B" )
+
+    case BaseTypeInt8B:
         return m_varData->writeSignQWord(value.asLongLong());
 
-    if ( m_typeInfo->getName() == L"UInt8B" )
+    case BaseTypeUInt8B:
         return m_varData->writeQWord(value.asULongLong());
 
-    if ( m_typeInfo->getName() == L"Float" )
+    case BaseTypeFloat:
         return m_varData->writeFloat(value.asFloat());
 
-    if ( m_typeInfo->getName() == L"Double" )
+    case BaseTypeDouble:
         return m_varData->writeDouble(value.asDouble());
-
-    if ( m_typeInfo->getName() == L"Bool" )
-        return m_varData->writeByte(value.asUChar());
-
-    if ( m_typeInfo->getName() == L"Hresult" )
-        return m_varData->writeDWord(value.asULong());
+    }
 
     throw TypeException(  m_typeInfo->getName(), L" unsupported based type");
 }
@@ -1177,11 +1330,14 @@ TypedVarPtr TypedVarArray::getElement( size_t index )
 {
     TypeInfoPtr     elementType = m_typeInfo->getElement(0);
 
-    if ( m_varData->getStorageType() == MemoryVar )
-        return loadTypedVar( elementType, getMemoryAccessor(m_varData->getAddress() + elementType->getSize()*index, elementType->getSize()) );
-
     if ( index >= m_typeInfo->getElementCount() )
+    {
+        // memory arrays are not bounds checked
+        if ( m_varData->getStorageType() == MemoryVar )
+            return loadTypedVar( elementType, getMemoryAccessor(m_varData->getAddress() + elementType->getSize()*index, elementType->getSize()) );
+
         throw IndexException( index );
+    }
 
     return loadTypedVar( elementType,  m_varData->copy(elementType->getSize()*index, elementType->getSize()) );
 }
@@ -2100,58 +2256,65 @@ TypedValue::TypedValue()
 
 TypedValue::TypedValue(const NumVariant& var)
 {
-    if ( var.isChar() )
-    {
-        m_value = loadCharVar(var.asChar());
-    }
-    else if ( var.isShort() )
-    {
-        m_value = loadShortVar(var.asShort());
-    }
-    else if ( var.isLong() )
+    if ( var.isInt() )
     {
-        m_value = loadLongVar(var.asLong());
-    }
-    else if ( var.isLongLong() )
-    {
-        m_value = loadLongLongVar(var.asLongLong());
-    }
-    else if ( var.isUChar() )
-    {
-        m_value = loadUCharVar(var.asUChar() );
-    }
-    else if ( var.isUShort() )
-    {
-        m_value = loadUShortVar(var.asUShort());
-    }
-    else if ( var.isULong() )
-    {
-        m_value = loadULongVar(var.asULong() );
-    }
-    else if ( var.isULongLong() )
-    {
-        m_value = loadULongLongVar(var.asULongLong() );
-    }
-    else if ( var.isInt() )
-    {
-        m_value = loadIntVar(var.asInt() );
+        m_scalar = NumVariant( static_cast<long>(var.asInt()) );
     }
     else if ( var.isUInt() )
     {
-        m_value = loadUIntVar(var.asUInt() );
-    }
-    else if ( var.isFloat() )
-    {
-        m_value = loadFloatVar(var.asFloat() );
+        m_scalar = NumVariant( var.asULong() );
     }
-    else if ( var.isDouble() )
+    else
     {
-        m_value = loadDoubleVar(var.asDouble() );
+        m_scalar = var;
     }
-    else
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypeInfoPtr TypedValue::getScalarType() const
+{
+    return loadBaseType( getScalarKind(m_scalar) );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypedVarPtr TypedValue::loadScalarVar() const
+{
+    switch ( getScalarKind(m_scalar) )
     {
-        throw TypeException(L"Failed to convet NumVariant to TypedVar");
+    case BaseTypeInt1B:
+        return loadCharVar( m_scalar.asChar() );
+
+    case BaseTypeUInt1B:
+        return loadUCharVar( m_scalar.asUChar() );
+
+    case BaseTypeInt2B:
+        return loadShortVar( m_scalar.asShort() );
+
+    case BaseTypeUInt2B:
+        return loadUShortVar( m_scalar.asUShort() );
+
+    case BaseTypeInt4B:
+        return loadLongVar( m_scalar.asLong() );
+
+    case BaseTypeUInt4B:
+        return loadULongVar( m_scalar.asULong() );
+
+    case BaseTypeInt8B:
+        return loadLongLongVar( m_scalar.asLongLong() );
+
+    case BaseTypeUInt8B:
+        return loadULongLongVar( m_scalar.asULongLong() );
+
+    case BaseTypeFloat:
+        return loadFloatVar( m_scalar.asFloat() );
+
+    case BaseTypeDouble:
+        return loadDoubleVar( m_scalar.asDouble() );
     }
+
+    return loadBoolVar( m_scalar.asInt() != 0 );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -4,6 +4,8 @@
 #include <kdlib/exceptions.h>
 #include <kdlib/memaccess.h>
 
+#include "typeinfoimp.h"
+
 namespace kdlib {
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -225,7 +227,8 @@ class TypedVarBase : public TypedVarImp
 public:
 
     TypedVarBase( const TypeInfoPtr& typeInfo, const DataAccessorPtr &dataSource, const std::wstring& name = L"" ) :
-        TypedVarImp( typeInfo, dataSource, name )
+        TypedVarImp( typeInfo, dataSource, name ),
+        m_baseKind( getBaseTypeKind(typeInfo) )
         {}
 
     std::wstring printValue() const;
@@ -238,6 +241,8 @@ protected:
 
 
     virtual std::wstring str();
+
+    BaseTypeKind  m_baseKind;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1,7 +1,14 @@
 #include "stdafx.h"
+#include <algorithm>
 #include <sstream>
 #include <iomanip>
 #include <regex>
+#include <unordered_map>
+
+#include <boost/noncopyable.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
 
 #include "kdlib/exceptions.h"
 #include "kdlib/dbgengine.h"
@@ -18,100 +25,268 @@ namespace {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static const std::wregex complexSymMatch(L"^([\\*]*)([^\\(\\)\\*\\[\\]]*)([\\(\\)\\*\\[\\]\\d]*)$");
+// complex type name: [*...]name[suffix], the suffix consists of "*", "[N]"
+// and brackets only
+
+inline bool isComplexSuffixChar( wchar_t c )
+{
+    return c == L'*' || c == L'(' || c == L')' || c == L'[' || c == L']' || ( c >= L'0' && c <= L'9' );
+}
+
+bool splitComplexType( const std::wstring &fullTypeName, std::wstring &name, std::wstring &suffix )
+{
+    size_t  nameBegin = fullTypeName.find_first_not_of( L'*' );
+    if ( nameBegin == std::wstring::npos )
+        nameBegin = fullTypeName.size();
+
+    size_t  nameEnd = fullTypeName.find_first_of( L"()*[]", nameBegin );
+    if ( nameEnd == std::wstring::npos )
+        nameEnd = fullTypeName.size();
+
+    for ( size_t i = nameEnd; i < fullTypeName.size(); ++i )
+    {
+        if ( !isComplexSuffixChar( fullTypeName[i] ) )
+            return false;
+    }
+
+    name = fullTypeName.substr( nameBegin, nameEnd - nameBegin );
+    suffix = fullTypeName.substr( nameEnd );
+
+    return true;
+}
 
 std::wstring getTypeNameFromComplex( const std::wstring &fullTypeName )
 {
-    std::wsmatch    matchResult;
+    std::wstring  name, suffix;
 
-    if ( !std::regex_match( fullTypeName, matchResult, complexSymMatch ) )
+    if ( !splitComplexType( fullTypeName, name, suffix ) )
         return L"";
 
-    return std::wstring( matchResult[2].first, matchResult[2].second );
+    return name;
 }
 
 std::wstring getTypeSuffixFromComplex( const std::wstring &fullTypeName )
 {
-    std::wsmatch    matchResult;
+    std::wstring  name, suffix;
 
-    if ( !std::regex_match( fullTypeName, matchResult, complexSymMatch ) )
+    if ( !splitComplexType( fullTypeName, name, suffix ) )
         return L"";
 
-    return std::wstring( matchResult[3].first, matchResult[3].second );
+    return suffix;
 }
 
-
 ///////////////////////////////////////////////////////////////////////////////
 
-static const std::wregex bracketMatch(L"^([^\\(]*)\\((.*)\\)([^\\)]*)$"); 
-
+// "a(b)c" -> suffix "ac", bracket expression "b"; the brackets are the first
+// opening and the last closing ones
 void getBracketExpression( std::wstring &suffix, std::wstring &bracketExpression )
 {
-    std::wsmatch    matchResult;
+    size_t  open = suffix.find( L'(' );
+    size_t  close = suffix.rfind( L')' );
 
-    if ( std::regex_match( suffix, matchResult, bracketMatch  ) )
-    {
-        bracketExpression = std::wstring( matchResult[2].first, matchResult[2].second );
-        
-        std::wstring  newSuffix;
+    if ( open == std::wstring::npos || close == std::wstring::npos || close < open )
+        return;
 
-        if ( matchResult[1].matched )
-            newSuffix += std::wstring( matchResult[1].first, matchResult[1].second );
+    bracketExpression = suffix.substr( open + 1, close - open - 1 );
 
-        if ( matchResult[3].matched )
-            newSuffix += std::wstring( matchResult[3].first, matchResult[3].second );
-
-        suffix = newSuffix;
-    }
+    suffix = suffix.substr( 0, open ) + suffix.substr( close + 1 );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static const std::wregex ptrMatch(L"^\\*(.*)$");
-
 bool getPtrExpression( std::wstring &suffix )
 {
-    std::wsmatch    matchResult;
+    if ( suffix.empty() || suffix[0] != L'*' )
+        return false;
+
+    suffix.erase( 0, 1 );
 
-    if ( std::regex_match( suffix, matchResult, ptrMatch  ) )
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// the last "[N]" of the suffix
+bool getArrayExpression( std::wstring &suffix, size_t &arraySize )
+{
+    if ( suffix.size() < 3 || suffix[suffix.size() - 1] != L']' )
+        return false;
+
+    size_t  open = suffix.rfind( L'[' );
+    if ( open == std::wstring::npos || open + 2 >= suffix.size() )
+        return false;
+
+    size_t  size = 0;
+
+    for ( size_t i = open + 1; i < suffix.size() - 1; ++i )
     {
-        suffix = std::wstring(matchResult[1].first, matchResult[1].second );
+        if ( suffix[i] < L'0' || suffix[i] > L'9' )
+            return false;
 
-        return true;
+        size = size * 10 + ( suffix[i] - L'0' );
     }
 
-    return false;
+    arraySize = size;
+    suffix.erase( open );
+
+    return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static const std::wregex arrayMatch(L"^(.*)\\[(\\d+)\\]$");
+} // end nameless namespace
 
-bool getArrayExpression( std::wstring &suffix, size_t &arraySize )
+namespace kdlib {
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Pointer and array types made from the same type are shared. The table keeps
+// weak references only: a derived type holds its base type, so a live entry
+// never refers to a destroyed base type
+class DerivedTypeTable : private boost::noncopyable
 {
-    std::wsmatch    matchResult;
+public:
+
+    DerivedTypeTable() :
+        m_purgeLimit(minPurgeLimit)
+        {}
 
-    if ( std::regex_match( suffix, matchResult, arrayMatch  ) )
+    TypeInfoPtr getPointer( const TypeInfoPtr &baseType, size_t ptrSize )
     {
-        std::wstringstream  sstr;
-        sstr << std::wstring(matchResult[2].first, matchResult[2].second );
-        sstr >> arraySize;
+        return get( baseType, PointerType, ptrSize );
+    }
 
-        suffix = std::wstring(matchResult[1].first, matchResult[1].second );
+    TypeInfoPtr getArray( const TypeInfoPtr &baseType, size_t count )
+    {
+        return get( baseType, ArrayType, count );
+    }
 
-        return true;
+private:
+
+    static const size_t  minPurgeLimit = 0x400;
+
+    enum DerivedKind {
+        PointerType,
+        ArrayType
+    };
+
+    struct Key {
+        const TypeInfo*  baseType;
+        DerivedKind  kind;
+        size_t  size;
+
+        bool operator==( const Key &key ) const {
+            return baseType == key.baseType && kind == key.kind && size == key.size;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()( const Key &key ) const {
+            size_t  hash = std::hash<const TypeInfo*>()( key.baseType );
+            return hash ^ ( key.size * 2 + key.kind + 0x9e3779b9 + (hash << 6) + (hash >> 2) );
+        }
+    };
+
+    typedef std::unordered_map<Key, boost::weak_ptr<TypeInfo>, KeyHash>  TypeMap;
+
+    TypeInfoPtr get( const TypeInfoPtr &baseType, DerivedKind kind, size_t size )
+    {
+        Key  key = { baseType.get(), kind, size };
+
+        boost::lock_guard<boost::mutex>  l(m_lock);
+
+        TypeMap::iterator  it = m_types.find(key);
+        if ( it != m_types.end() )
+        {
+            TypeInfoPtr  derivedType = it->second.lock();
+            if ( derivedType )
+                return derivedType;
+        }
+
+        TypeInfoPtr  derivedType = kind == PointerType ? 
+            TypeInfoPtr( new TypeInfoPointer( baseType, size ) ) :
+            TypeInfoPtr( new TypeInfoArray( baseType, size ) );
+
+        if ( it != m_types.end() )
+        {
+            it->second = derivedType;
+            return derivedType;
+        }
+
+        if ( m_types.size() >= m_purgeLimit )
+            purge();
+
+        m_types.insert( std::make_pair( key, boost::weak_ptr<TypeInfo>(derivedType) ) );
+
+        return derivedType;
     }
 
-    return false;
-}
+    // drops the entries of the destroyed types
+    void purge()
+    {
+        for ( TypeMap::iterator it = m_types.begin(); it != m_types.end(); )
+        {
+            if ( it->second.expired() )
+                it = m_types.erase(it);
+            else
+                ++it;
+        }
 
-///////////////////////////////////////////////////////////////////////////////
+        m_purgeLimit = (std::max)( static_cast<size_t>(minPurgeLimit), m_types.size() * 2 );
+    }
+
+    boost::mutex  m_lock;
+    TypeMap  m_types;
+    size_t  m_purgeLimit;
+};
+
+DerivedTypeTable  g_derivedTypes;
 
 ///////////////////////////////////////////////////////////////////////////////
 
-} // end nameless namespace
+// Base types are immutable, one object is shared for each ( kind, pointer size )
+class BaseTypeTable : private boost::noncopyable
+{
+public:
 
-namespace kdlib {
+    TypeInfoPtr get( BaseTypeKind kind, size_t ptrSize )
+    {
+        size_t  column;
+
+        switch ( ptrSize )
+        {
+        case 0: column = 0; break;
+        case 4: column = 1; break;
+        case 8: column = 2; break;
+        default: return makeBaseTypeInfo( kind, ptrSize );
+        }
+
+        // the void type takes the current pointer size when it is created
+        if ( kind == BaseTypeVoid && ptrSize == 0 )
+            return makeBaseTypeInfo( kind, ptrSize );
+
+        boost::lock_guard<boost::mutex>  l(m_lock);
+
+        TypeInfoPtr  &baseType = m_types[kind][column];
+        if ( !baseType )
+            baseType = makeBaseTypeInfo( kind, ptrSize );
+
+        return baseType;
+    }
+
+private:
+
+    boost::mutex  m_lock;
+    TypeInfoPtr  m_types[BaseTypeNone][3];
+};
+
+BaseTypeTable  g_baseTypes;
+
+///////////////////////////////////////////////////////////////////////////////
+
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -273,6 +448,73 @@ std::wstring findSymbol( MEMOFFSET_64 offset)
 
 ///////////////////////////////////////////////////////////////////////////////
 
+std::vector<std::wstring> findSymbols( const std::vector<MEMOFFSET_64>& offsets )
+{
+    std::vector<MEMDISPLACEMENT>  displacements;
+    return findSymbols( offsets, displacements );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::vector<std::wstring> findSymbols( const std::vector<MEMOFFSET_64>& offsets, std::vector<MEMDISPLACEMENT>& displacements )
+{
+    std::vector<std::wstring>  names( offsets.size() );
+    displacements.assign( offsets.size(), 0 );
+
+    // the offsets are normalized once, not on every comparison of the sort
+    std::vector<MEMOFFSET_64>  normalized( offsets.size() );
+    std::vector<size_t>  order( offsets.size() );
+    for ( size_t i = 0; i < order.size(); ++i )
+    {
+        normalized[i] = addr64( offsets[i] );
+        order[i] = i;
+    }
+
+    std::sort( order.begin(), order.end(),
+        [&normalized]( size_t i1, size_t i2 ) { return normalized[i1] < normalized[i2]; } );
+
+    ModulePtr  module;
+    const size_t  none = static_cast<size_t>(-1);
+    size_t  prev = none;
+
+    for ( size_t i : order )
+    {
+        const MEMOFFSET_64  offset = normalized[i];
+
+        // the same offset is resolved once
+        if ( prev != none && normalized[prev] == offset )
+        {
+            names[i] = names[prev];
+            displacements[i] = displacements[prev];
+            continue;
+        }
+
+        prev = i;
+
+        if ( !module || offset < module->getBase() || offset >= module->getEnd() )
+        {
+            try {
+                module = loadModule( offset );
+            }
+            catch ( DbgException& )
+            {
+                module.reset();
+                continue;
+            }
+        }
+
+        try {
+            names[i] = module->findSymbol( offset, displacements[i] );
+        }
+        catch ( DbgException& )
+        {}
+    }
+
+    return names;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 TypeInfoPtr loadType( const std::wstring &typeName )
 {
     std::wstring     moduleName;
@@ -293,9 +535,7 @@ TypeInfoPtr loadType( const std::wstring &typeName )
 
     ModulePtr  module = loadModule(moduleName);
 
-    SymbolPtr  symbolScope = module->getSymbolScope();
-
-    return loadType(symbolScope, symName );
+    return module->getTypeByName(symName);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -347,6 +587,10 @@ TypeInfoPtr loadType( const SymbolPtr &symbol )
             
             ptr = loadType( symbol->getType() );
 
+            // the base types are shared, the constant gets its own copy
+            if ( ptr->isBase() )
+                ptr = makeBaseTypeInfo( getBaseTypeKind(ptr), getPtrSizeBySymbol( symbol->getType() ) );
+
             dynamic_cast<TypeInfoImp*>( ptr.get() )->setConstant( constVal );
 
             break;
@@ -699,99 +943,151 @@ std::vector<TypeFieldPtr> enumFields(
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static const std::wregex baseMatch(L"^(Char)|(WChar)|(Int1B)|(UInt1B)|(Int2B)|(UInt2B)|(Int4B)|(UInt4B)|(Int8B)|(UInt8B)|(Long)|(ULong)|(Float)|(Bool)|(Double)|(Void)|(Hresult)|(NoType)$" );
-
-bool TypeInfo::isBaseType( const std::wstring &typeName )
+BaseTypeKind getBaseTypeKind( const std::wstring &typeName )
 {
-    std::wstring  name = typeName;
+    static const std::unordered_map<std::wstring, BaseTypeKind>  baseTypes = {
+        { L"Char", BaseTypeChar },
+        { L"WChar", BaseTypeWChar },
+        { L"Int1B", BaseTypeInt1B },
+        { L"UInt1B", BaseTypeUInt1B },
+        { L"Int2B", BaseTypeInt2B },
+        { L"UInt2B", BaseTypeUInt2B },
+        { L"Int4B", BaseTypeInt4B },
+        { L"UInt4B", BaseTypeUInt4B },
+        { L"Int8B", BaseTypeInt8B },
+        { L"UInt8B", BaseTypeUInt8B },
+        { L"Long", BaseTypeLong },
+        { L"ULong", BaseTypeULong },
+        { L"Float", BaseTypeFloat },
+        { L"Bool", BaseTypeBool },
+        { L"Double", BaseTypeDouble },
+        { L"Void", BaseTypeVoid },
+        { L"Hresult", BaseTypeHresult },
+        { L"NoType", BaseTypeNoType }
+    };
 
-    if ( isComplexType(name) )
-    {
-        name = getTypeNameFromComplex(name);
-        if (name.empty())
-            return false;
-    }
+    std::unordered_map<std::wstring, BaseTypeKind>::const_iterator  it = baseTypes.find( typeName );
 
-    std::wsmatch    baseMatchResult;
-    return std::regex_match( name, baseMatchResult, baseMatch );
+    return it != baseTypes.end() ? it->second : BaseTypeNone;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-bool TypeInfo::isComplexType( const std::wstring &typeName )
+BaseTypeKind getBaseTypeKind( const TypeInfoPtr &typeInfo )
 {
-    return typeName.find_first_of( L"*[" ) !=  std::string::npos;
+    TypeInfoImp  *typeImp = dynamic_cast<TypeInfoImp*>( typeInfo.get() );
+    if ( typeImp )
+        return typeImp->getBaseKind();
+
+    return getBaseTypeKind( typeInfo->getName() );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-TypeInfoPtr TypeInfo::getBaseTypeInfo( const std::wstring &typeName, size_t ptrSize )
+TypeInfoPtr makeBaseTypeInfo( BaseTypeKind kind, size_t ptrSize )
 {
-    if ( isComplexType( typeName ) )
-        return getComplexTypeInfo( typeName, SymbolPtr() );
-
-    std::wsmatch    baseMatchResult;
-
-    if ( std::regex_match( typeName, baseMatchResult, baseMatch ) )
+    switch ( kind )
     {
-        if ( baseMatchResult[1].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<char>(L"Char", ptrSize) );
+    case BaseTypeChar:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<char>(L"Char", kind, ptrSize) );
 
-        if ( baseMatchResult[2].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<wchar_t>(L"WChar", ptrSize) );
+    case BaseTypeWChar:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<wchar_t>(L"WChar", kind, ptrSize) );
 
-        if ( baseMatchResult[3].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<char>(L"Int1B", ptrSize ) );
+    case BaseTypeInt1B:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<char>(L"Int1B", kind, ptrSize) );
 
-        if ( baseMatchResult[4].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned char>(L"UInt1B", ptrSize ) );
+    case BaseTypeUInt1B:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned char>(L"UInt1B", kind, ptrSize) );
 
-        if ( baseMatchResult[5].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<short>(L"Int2B", ptrSize) );
+    case BaseTypeInt2B:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<short>(L"Int2B", kind, ptrSize) );
 
-        if ( baseMatchResult[6].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned short>(L"UInt2B", ptrSize) );
+    case BaseTypeUInt2B:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned short>(L"UInt2B", kind, ptrSize) );
 
-        if ( baseMatchResult[7].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<long>(L"Int4B", ptrSize) );
+    case BaseTypeInt4B:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<long>(L"Int4B", kind, ptrSize) );
 
-        if ( baseMatchResult[8].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned long>(L"UInt4B", ptrSize) );
+    case BaseTypeUInt4B:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned long>(L"UInt4B", kind, ptrSize) );
 
-        if ( baseMatchResult[9].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<__int64>(L"Int8B", ptrSize) );
+    case BaseTypeInt8B:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<__int64>(L"Int8B", kind, ptrSize) );
 
-        if ( baseMatchResult[10].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned __int64>(L"UInt8B", ptrSize) );
+    case BaseTypeUInt8B:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned __int64>(L"UInt8B", kind, ptrSize) );
 
-        if ( baseMatchResult[11].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<long>(L"Long", ptrSize) );
+    case BaseTypeLong:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<long>(L"Long", kind, ptrSize) );
 
-        if ( baseMatchResult[12].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned long>(L"ULong", ptrSize) );
+    case BaseTypeULong:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned long>(L"ULong", kind, ptrSize) );
 
-        if ( baseMatchResult[13].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<float>(L"Float", ptrSize) );
+    case BaseTypeFloat:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<float>(L"Float", kind, ptrSize) );
 
-        if ( baseMatchResult[14].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<bool>(L"Bool", ptrSize) );
+    case BaseTypeBool:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<bool>(L"Bool", kind, ptrSize) );
 
-        if ( baseMatchResult[15].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<double>(L"Double", ptrSize) );
+    case BaseTypeDouble:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<double>(L"Double", kind, ptrSize) );
 
-        if ( baseMatchResult[16].matched )
-            return TypeInfoPtr( new TypeInfoVoid( ptrSize ) );
+    case BaseTypeVoid:
+        return TypeInfoPtr( new TypeInfoVoid( ptrSize ) );
 
-        if ( baseMatchResult[17].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned long>(L"Hresult", ptrSize) );
+    case BaseTypeHresult:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned long>(L"Hresult", kind, ptrSize) );
 
-        if ( baseMatchResult[18].matched )
-            return TypeInfoPtr( new TypeInfoNoType() );
+    case BaseTypeNoType:
+        return TypeInfoPtr( new TypeInfoNoType() );
     }
 
     NOT_IMPLEMENTED();
+}
 
-    //return TypeInfoPtr();
+///////////////////////////////////////////////////////////////////////////////
+
+TypeInfoPtr loadBaseType( BaseTypeKind kind, size_t ptrSize )
+{
+    return g_baseTypes.get( kind, ptrSize );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool TypeInfo::isBaseType( const std::wstring &typeName )
+{
+    std::wstring  name = typeName;
+
+    if ( isComplexType(name) )
+    {
+        name = getTypeNameFromComplex(name);
+        if (name.empty())
+            return false;
+    }
+
+    return getBaseTypeKind( name ) != BaseTypeNone;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool TypeInfo::isComplexType( const std::wstring &typeName )
+{
+    return typeName.find_first_of( L"*[" ) !=  std::string::npos;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypeInfoPtr TypeInfo::getBaseTypeInfo( const std::wstring &typeName, size_t ptrSize )
+{
+    if ( isComplexType( typeName ) )
+        return getComplexTypeInfo( typeName, SymbolPtr() );
+
+    BaseTypeKind  kind = getBaseTypeKind( typeName );
+    if ( kind == BaseTypeNone )
+        NOT_IMPLEMENTED();
+
+    return g_baseTypes.get( kind, ptrSize );
 }
 
 /////////////////////////////////////////////////////////////////////////////////////
@@ -878,14 +1174,14 @@ TypeInfoPtr TypeInfo::getRecursiveComplexType( const std::wstring &typeName, Typ
     {
         if ( getPtrExpression( suffix ) )
         {
-            lowestType = TypeInfoPtr( new TypeInfoPointer( lowestType, ptrSize ) );
+            lowestType = g_derivedTypes.getPointer( lowestType, ptrSize );
             continue;
         }
 
         size_t arraySize;
         if ( getArrayExpression( suffix, arraySize ) )
         {
-            lowestType = TypeInfoPtr( new TypeInfoArray( lowestType, arraySize ) );
+            lowestType = g_derivedTypes.getArray( lowestType, arraySize );
             continue;
         }
 
@@ -902,24 +1198,46 @@ TypeInfoPtr TypeInfo::getRecursiveComplexType( const std::wstring &typeName, Typ
 
 TypeInfoPtr TypeInfo::getTypeInfoFromCache(const std::wstring &typeName)
 {
-    TypeInfoPtr  cachedType = ProcessMonitor::getTypeInfo(typeName);
+    // the zero module base keeps the names resolved over all modules
+    TypeInfoPtr  cachedType = ProcessMonitor::getTypeInfo(0, typeName);
     if (cachedType)
         return cachedType;
 
     MEMOFFSET_64 moduleOffset = findModuleBySymbol(typeName);
 
-    TypeInfoPtr  typeInfo = loadModule(moduleOffset)->getTypeByName(typeName);;
+    TypeInfoPtr  typeInfo = loadModule(moduleOffset)->getTypeByName(typeName);
 
-    ProcessMonitor::insertTypeInfo(typeInfo);
+    ProcessMonitor::insertTypeInfo(0, typeName, typeInfo);
 
     return typeInfo;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
+void setTypeCacheLimit( size_t maxTypes )
+{
+    ProcessMonitor::setTypeCacheLimit(maxTypes);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void resetTypeCache()
+{
+    ProcessMonitor::getTypeCache()->invalidate();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypeCacheStatistics getTypeCacheStatistics()
+{
+    return ProcessMonitor::getTypeCache()->getStatistics();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 TypeInfoPtr TypeInfoImp::ptrTo( size_t ptrSize )
 {
-    return TypeInfoPtr( new TypeInfoPointer( shared_from_this(), ptrSize ? ptrSize : getPtrSize() ) );
+    return g_derivedTypes.getPointer( shared_from_this(), ptrSize ? ptrSize : getPtrSize() );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -928,7 +1246,7 @@ TypeInfoPtr TypeInfoImp::arrayOf( size_t size )
 {
     if (isIncomplete())
         throw TypeException(getName(), L"can not make array of incomplete type");
-    return TypeInfoPtr( new TypeInfoArray( shared_from_this(), size ) );
+    return g_derivedTypes.getArray( shared_from_this(), size );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -2184,6 +2502,7 @@ bool isTypeTag(SymTags tag)
 TypeInfoSymbolEnum::TypeInfoSymbolEnum(SymbolSessionPtr& symSession, const std::wstring& mask)
 {
     m_index = 0;
+    GlobPattern  symMask(mask);
     SymbolPtr  symScope = symSession->getSymbolScope();
     size_t  symCount = symScope->getChildCount();
     
@@ -2196,7 +2515,7 @@ TypeInfoSymbolEnum::TypeInfoSymbolEnum(SymbolSessionPtr& symSession, const std::
 
         std::wstring  symName = sym->getName();
 
-        if (mask.empty() || fnmatch(mask, symName))
+        if (symMask.empty() || symMask.match(symName))
         {
             m_typeList.push_back(loadType(sym));
         }
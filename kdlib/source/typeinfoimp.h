@@ -30,6 +30,40 @@ std::wstring printEnumType(TypeInfoPtr& enumType);
 
 ///////////////////////////////////////////////////////////////////////////////
 
+enum BaseTypeKind {
+    BaseTypeChar,
+    BaseTypeWChar,
+    BaseTypeInt1B,
+    BaseTypeUInt1B,
+    BaseTypeInt2B,
+    BaseTypeUInt2B,
+    BaseTypeInt4B,
+    BaseTypeUInt4B,
+    BaseTypeInt8B,
+    BaseTypeUInt8B,
+    BaseTypeLong,
+    BaseTypeULong,
+    BaseTypeFloat,
+    BaseTypeBool,
+    BaseTypeDouble,
+    BaseTypeVoid,
+    BaseTypeHresult,
+    BaseTypeNoType,
+    BaseTypeNone    // not a base type
+};
+
+BaseTypeKind getBaseTypeKind( const std::wstring &typeName );
+
+BaseTypeKind getBaseTypeKind( const TypeInfoPtr &typeInfo );
+
+// a new ( not shared ) base type object
+TypeInfoPtr makeBaseTypeInfo( BaseTypeKind kind, size_t ptrSize );
+
+// the shared base type object
+TypeInfoPtr loadBaseType( BaseTypeKind kind, size_t ptrSize = 0 );
+
+///////////////////////////////////////////////////////////////////////////////
+
 class TypeInfoImp : public TypeInfo, public boost::enable_shared_from_this<TypeInfoImp>
 {
 protected:
@@ -376,6 +410,11 @@ public:
         m_constantValue = constVal;
     }
 
+    virtual BaseTypeKind getBaseKind()
+    {
+        return BaseTypeNone;
+    }
+
 protected:
 
     TypeInfoImp() :
@@ -723,11 +762,16 @@ class TypeInfoBaseWrapper : public TypeInfoImp
 {
 public:
 
-    TypeInfoBaseWrapper( const std::wstring & name, size_t ptrSize ) :
+    TypeInfoBaseWrapper( const std::wstring & name, BaseTypeKind kind, size_t ptrSize ) :
         m_name( name ),
+        m_kind( kind ),
         m_ptrSize( ptrSize )
         {}
 
+    virtual BaseTypeKind getBaseKind() {
+        return m_kind;
+    }
+
 protected:
 
     virtual std::wstring str() {
@@ -757,6 +801,7 @@ protected:
 protected:
 
     std::wstring  m_name;
+    BaseTypeKind  m_kind;
     size_t  m_ptrSize;
 };
 
@@ -768,6 +813,10 @@ public:
 
     TypeInfoVoid( size_t ptrSize=0 );
 
+    virtual BaseTypeKind getBaseKind() {
+        return BaseTypeVoid;
+    }
+
 protected:
 
     virtual std::wstring str() {
@@ -800,6 +849,12 @@ private:
 
 class TypeInfoNoType : public TypeInfoImp 
 {
+public:
+
+    virtual BaseTypeKind getBaseKind() {
+        return BaseTypeNoType;
+    }
+
 protected:
     virtual std::wstring str() {
         return getName();
@@ -947,8 +1002,8 @@ public:
         return m_derefType;
     }
 
-    const std::wstring getDerefName() const {
-        return m_derefType->getName();
+    const std::wstring getDerefName() {
+        return deref()->getName();
     }
 
     //virtual TypeInfoPtr getClassParent();
@@ -960,7 +1015,7 @@ public:
 protected:
 
     virtual std::wstring str() {
-        return L"ptr to " + m_derefType->getName();
+        return L"ptr to " + deref()->getName();
     }
 
     virtual bool isPointer() {
@@ -988,11 +1043,35 @@ class TypeInfoSymbolPointer : public TypeInfoPointer
 public:
 
     TypeInfoSymbolPointer( const SymbolPtr& symbol ) : 
-        TypeInfoPointer( loadType( symbol->getType() ), symbol->getSize() )
+        TypeInfoPointer( TypeInfoPtr(), symbol->getSize() )
     {
         m_symbol = symbol;
     }
 
+    // the pointed type is loaded on the first deref; a user defined type is
+    // shared and only weakly referenced by the pointer, so a type pointing
+    // to itself makes no reference cycle
+    virtual TypeInfoPtr deref() {
+
+        boost::mutex::scoped_lock  l(m_derefLock);
+
+        if ( m_derefType )
+            return m_derefType;
+
+        TypeInfoPtr  derefType = m_weakDerefType.lock();
+        if ( derefType )
+            return derefType;
+
+        derefType = loadSharedType( m_symbol->getType() );
+
+        if ( derefType->isUserDefined() || derefType->isArray() )
+            m_weakDerefType = derefType;
+        else
+            m_derefType = derefType;
+
+        return derefType;
+    }
+
     std::wstring getScopeName() {
         return m_symbol->getScopeName();
     }
@@ -1000,6 +1079,9 @@ public:
 protected:
 
     SymbolPtr  m_symbol;
+
+    boost::mutex  m_derefLock;
+    boost::weak_ptr<TypeInfo>  m_weakDerefType;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -2,8 +2,12 @@
 
 #include <string>
 #include <vector>
+#include <unordered_map>
 
 #include <boost/smart_ptr.hpp>
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include "kdlib/dbgengine.h"
 #include "kdlib/typeinfo.h"
@@ -34,6 +38,34 @@ public:
 
 };
 
+// drops the types cached by symbol fields; called when module symbols are reset
+void invalidateFieldTypes();
+
+// user defined type of a symbol shared by all pointers to it, keyed by
+// ( symbol scope, symbol index ) until the symbols are reset: a self-referential
+// type reached through its pointer fields is loaded only once
+TypeInfoPtr loadSharedType(const SymbolPtr &sym);
+
+// type of a symbol field resolved once per symbols generation
+class FieldTypeCache : private boost::noncopyable
+{
+public:
+
+    FieldTypeCache() :
+        m_generation(0)
+        {}
+
+    TypeInfoPtr get(const SymbolPtr &sym);
+
+private:
+
+    boost::mutex  m_lock;
+    TypeInfoPtr  m_typeInfo;
+    unsigned long long  m_generation;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 class TypeField
 {
 
@@ -247,9 +279,12 @@ private:
         m_symbol( sym )
         {}
 
-    virtual TypeInfoPtr getTypeInfo();
+    virtual TypeInfoPtr getTypeInfo() {
+        return m_typeCache.get(m_symbol);
+    }
 
     SymbolPtr  m_symbol;
+    FieldTypeCache  m_typeCache;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -265,22 +300,24 @@ public:
 private:
 
     virtual TypeInfoPtr getTypeInfo() {
-        return loadType(m_symbol);
+        return m_typeCache.get(m_symbol);
     }
 
     NumVariant getValue() const;
 
     SymbolPtr  m_symbol;
+    FieldTypeCache  m_typeCache;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
-class FieldCollection 
+class FieldCollection : private boost::noncopyable
 {
 public:
 
     FieldCollection( const std::wstring &name ) :
-      m_name( name )
+      m_name( name ),
+      m_indexed( false )
       {}
 
     const TypeFieldPtr &lookup(size_t index) const;
@@ -291,9 +328,7 @@ public:
 
     size_t getIndex(const std::wstring &name) const; 
 
-    void push_back( const TypeFieldPtr& field ) {
-        m_fields.push_back( field );
-    }
+    void push_back( const TypeFieldPtr& field );
 
     size_t count() const {
         return m_fields.size();
@@ -304,6 +339,22 @@ private:
     typedef std::vector<TypeFieldPtr>  FieldList;
     FieldList  m_fields;
     std::wstring  m_name;
+
+    // name -> index of the first field with the name and index of the field
+    // returned by lookup ( the first not inherited one, if any )
+    struct NameIndexEntry {
+        size_t  first;
+        size_t  preferred;
+    };
+
+    typedef std::unordered_map<std::wstring, NameIndexEntry>  NameIndex;
+
+    const NameIndexEntry& findName(const std::wstring &name) const;
+    void indexField(size_t index) const;
+
+    mutable NameIndex  m_nameIndex;
+    mutable boost::atomic<bool>  m_indexed;
+    mutable boost::mutex  m_indexLock;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
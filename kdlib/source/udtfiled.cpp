@@ -2,6 +2,8 @@
 
 #include <sstream>
 
+#include <boost/functional/hash.hpp>
+
 #include "kdlib/exceptions.h"
 
 #include "udtfield.h"
@@ -12,23 +14,7 @@ namespace kdlib {
 
 const TypeFieldPtr& FieldCollection::lookup(const std::wstring &name) const
 {
-    FieldList::const_iterator it;
-    for (it = m_fields.begin(); it != m_fields.end(); ++it)
-    {
-        if ( !(*it)->isInheritedMember() && (*it)->getName() == name)
-            return *it;
-    }
-
-    for (it = m_fields.begin(); it != m_fields.end(); ++it)
-    {
-        if ( (*it)->isInheritedMember() && (*it)->getName() == name )
-            return *it;
-    }
-
-    std::wstringstream   sstr;
-    sstr << L"field \"" << name << L" not found";
-
-    throw TypeException( m_name, sstr.str() );
+    return m_fields[ findName(name).preferred ];
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -62,15 +48,44 @@ TypeFieldPtr& FieldCollection::lookup(size_t index)
 
 size_t FieldCollection::getIndex(const std::wstring &name) const
 {
-    size_t  index = 0;
+    return findName(name).first;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void FieldCollection::push_back( const TypeFieldPtr& field )
+{
+    boost::mutex::scoped_lock  l(m_indexLock);
+
+    m_fields.push_back( field );
 
-    FieldList::const_iterator it;
-    for ( it = m_fields.begin(); it != m_fields.end(); ++it, ++index )
+    if ( m_indexed )
+        indexField( m_fields.size() - 1 );
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+const FieldCollection::NameIndexEntry& FieldCollection::findName(const std::wstring &name) const
+{
+    if ( !m_indexed.load(boost::memory_order_acquire) )
     {
-        if ( (*it)->getName() == name )
-            return index;
+        boost::mutex::scoped_lock  l(m_indexLock);
+
+        if ( !m_indexed.load(boost::memory_order_relaxed) )
+        {
+            m_nameIndex.reserve( m_fields.size() );
+
+            for ( size_t i = 0; i < m_fields.size(); ++i )
+                indexField(i);
+
+            m_indexed.store(true, boost::memory_order_release);
+        }
     }
 
+    NameIndex::const_iterator  it = m_nameIndex.find(name);
+    if ( it != m_nameIndex.end() )
+        return it->second;
+
     std::wstringstream   sstr;
     sstr << L"field \"" << name << L" not found";
 
@@ -79,9 +94,91 @@ size_t FieldCollection::getIndex(const std::wstring &name) const
 
 //////////////////////////////////////////////////////////////////////////////
 
-TypeInfoPtr SymbolUdtField::getTypeInfo()
+void FieldCollection::indexField(size_t index) const
 {
-    return loadType(m_symbol);
+    const TypeFieldPtr&  field = m_fields[index];
+
+    NameIndexEntry  entry = { index, index };
+
+    std::pair<NameIndex::iterator, bool>  res = m_nameIndex.insert( std::make_pair(field->getName(), entry) );
+
+    // a member of the class itself hides the inherited one with the same name
+    if ( !res.second && m_fields[res.first->second.preferred]->isInheritedMember() && !field->isInheritedMember() )
+        res.first->second.preferred = index;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+boost::atomic<unsigned long long>  g_fieldTypesGeneration(1);
+
+typedef std::pair<std::wstring, unsigned long>  SharedTypeKey;
+typedef std::unordered_map<SharedTypeKey, TypeInfoPtr, boost::hash<SharedTypeKey> >  SharedTypeMap;
+
+boost::mutex  g_sharedTypesLock;
+SharedTypeMap  g_sharedTypes;
+unsigned long long  g_sharedTypesGeneration = 0;
+
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void invalidateFieldTypes()
+{
+    ++g_fieldTypesGeneration;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+TypeInfoPtr FieldTypeCache::get(const SymbolPtr &sym)
+{
+    boost::mutex::scoped_lock  l(m_lock);
+
+    unsigned long long  generation = g_fieldTypesGeneration;
+
+    if ( !m_typeInfo || m_generation != generation )
+    {
+        m_typeInfo = loadType(sym);
+        m_generation = generation;
+    }
+
+    return m_typeInfo;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+TypeInfoPtr loadSharedType(const SymbolPtr &sym)
+{
+    if ( sym->getSymTag() != SymTagUDT )
+        return loadType(sym);
+
+    SharedTypeKey  key( sym->getScopeName(), sym->getIndexId() );
+
+    {
+        boost::mutex::scoped_lock  l(g_sharedTypesLock);
+
+        if ( g_sharedTypesGeneration != g_fieldTypesGeneration )
+        {
+            g_sharedTypes.clear();
+            g_sharedTypesGeneration = g_fieldTypesGeneration;
+        }
+
+        SharedTypeMap::const_iterator  it = g_sharedTypes.find(key);
+        if ( it != g_sharedTypes.end() )
+            return it->second;
+    }
+
+    // the type is loaded out of the lock, a concurrent load of the same type
+    // gives way to the first one inserted
+    TypeInfoPtr  typeInfo = loadType(sym);
+
+    boost::mutex::scoped_lock  l(g_sharedTypesLock);
+
+    if ( g_sharedTypesGeneration != g_fieldTypesGeneration )
+        return typeInfo;
+
+    return g_sharedTypes.insert( std::make_pair(key, typeInfo) ).first->second;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
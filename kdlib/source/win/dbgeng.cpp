@@ -1061,6 +1061,8 @@ void setCurrentSystemById(SYSTEM_DEBUG_ID id)
     hres = g_dbgMgr->system->SetCurrentSystemId(id);
     if (FAILED(hres))
         throw DbgEngException(L"IDebugSystemObject2::SetCurrentSystemId", hres);
+
+    ProcessMonitor::resetMemoryCache();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1248,6 +1250,8 @@ void setCurrentProcessById(PROCESS_DEBUG_ID id)
     hres = g_dbgMgr->system->SetCurrentProcessId(id);
     if ( FAILED(hres) )
         throw DbgEngException( L"IDebugSystemObjects::SetCurrentProcessId", hres );
+
+    ProcessMonitor::resetMemoryCache();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1271,6 +1275,8 @@ void setImplicitProcess(MEMOFFSET_64 offset)
     hres = g_dbgMgr->system->SetImplicitProcessDataOffset(offset);
     if ( FAILED(hres) )
         throw DbgEngException( L"IDebugSystemObjects::SetImplicitProcessDataOffset", hres );
+
+    ProcessMonitor::resetMemoryCache();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1431,6 +1437,8 @@ void setCurrentThreadById(THREAD_DEBUG_ID id)
     hres = g_dbgMgr->system->SetCurrentThreadId( id );
     if ( FAILED( hres ) )
         throw DbgEngException( L"IDebugSystemObjects::SetCurrentThreadId", hres );
+
+    ProcessMonitor::resetMemoryCache();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1451,6 +1459,8 @@ void setImplicitThread(MEMOFFSET_64 offset)
     hres = g_dbgMgr->system->SetImplicitThreadDataOffset(offset);
     if ( FAILED( hres ) )
         throw DbgEngException( L"IDebugSystemObjects::SetImplicitThreadDataOffset", hres );
+
+    ProcessMonitor::resetMemoryCache();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -214,6 +214,24 @@ HRESULT STDMETHODCALLTYPE DebugManager::ChangeEngineState(
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+
+HRESULT STDMETHODCALLTYPE DebugManager::ChangeDebuggeeState(
+    __in ULONG Flags,
+    __in ULONG64 Argument )
+{
+    try {
+
+        if ((Flags & DEBUG_CDS_DATA) != 0)
+            ProcessMonitor::resetMemoryCache();
+    }
+    catch (kdlib::DbgException&)
+    {
+    }
+
+    return S_OK;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 HRESULT STDMETHODCALLTYPE DebugManager::Exception(
@@ -108,6 +108,7 @@ public:
         *Mask = 0;
         *Mask |= DEBUG_EVENT_BREAKPOINT;
         *Mask |= DEBUG_EVENT_CHANGE_ENGINE_STATE;
+        *Mask |= DEBUG_EVENT_CHANGE_DEBUGGEE_STATE;
         *Mask |= DEBUG_EVENT_CHANGE_SYMBOL_STATE;
         *Mask |= DEBUG_EVENT_EXCEPTION;
         *Mask |= DEBUG_EVENT_LOAD_MODULE;
@@ -128,6 +129,10 @@ public:
         __in ULONG Flags,
         __in ULONG64 Argument );
 
+    STDMETHOD(ChangeDebuggeeState)(
+        __in ULONG Flags,
+        __in ULONG64 Argument );
+
 
     STDMETHOD(Exception)(
         __in PEXCEPTION_RECORD64 Exception,
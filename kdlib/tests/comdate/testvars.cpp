@@ -115,6 +115,8 @@ enumType g_constEnumThree = THREE;
 
 structWithEnum g_structWithEnum = {ONE};
 
+structWithSignEnum g_structWithSignEnum = { MINUS_ONE, 5 };
+
 structWithBits g_structWithBits = { 4, 1, 5 };
 structWithSignBits g_structWithSignBits = { 4, 1, 5 }; // high bit is sign extender, so, m_bit5 = -1
 
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+// Micro-benchmark helpers: the results are printed and recorded as test
+// properties, timings are never asserted
+
+class Stopwatch
+{
+public:
+
+    Stopwatch() :
+        m_start( std::chrono::steady_clock::now() )
+        {}
+
+    double elapsed() const {
+        return std::chrono::duration<double>( std::chrono::steady_clock::now() - m_start ).count();
+    }
+
+    void restart() {
+        m_start = std::chrono::steady_clock::now();
+    }
+
+private:
+
+    std::chrono::steady_clock::time_point  m_start;
+};
+
+inline void reportBenchmark( const std::string& name, double seconds, size_t iterations )
+{
+    double  nsPerOp = iterations ? seconds * 1e9 / iterations : 0;
+    double  opsPerSec = seconds > 0 ? iterations / seconds : 0;
+
+    std::cout << "[ BENCH    ] " << name << ": " << iterations << " ops, "
+        << seconds * 1000 << " ms, " << nsPerOp << " ns/op, " << opsPerSec << " ops/s" << std::endl;
+
+    ::testing::Test::RecordProperty( name, static_cast<int>(nsPerOp) );
+}
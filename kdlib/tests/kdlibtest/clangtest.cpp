@@ -1,6 +1,10 @@
 #include <stdafx.h>
 
+#include <windows.h>
+#include <psapi.h>
+
 #include "procfixture.h"
+#include "benchmark.h"
 
 #include "kdlib/typeinfo.h"
 
@@ -335,6 +339,51 @@ TEST_F(ClangTest, NtddkH)
     }
 }
 
+static long long getWorkingSetSize()
+{
+    PROCESS_MEMORY_COUNTERS  counters = { sizeof(counters) };
+    if ( !GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) )
+        return 0;
+    return counters.WorkingSetSize;
+}
+
+TEST_F(ClangTest, NtddkHBenchmark)
+{
+    std::wstring  src = L"#include <ntddk.h>\r\n";
+    std::wstring  opt = L"-I\"C:/Program Files (x86)/Windows Kits/10/Include/10.0.16299.0/km\" \
+        -I\"C:/Program Files (x86)/Windows Kits/8.1/Include/shared\" \
+        -D_AMD64_ --target=x86_64-pc-windows-msvc -w";
+
+    long long  workingSet = getWorkingSetSize();
+
+    Stopwatch  timer;
+
+    TypeInfoProviderPtr  typeProvider;
+    ASSERT_NO_THROW( typeProvider = getTypeInfoProviderFromSource(src, opt) );
+
+    reportBenchmark("ntddk.h type provider construction", timer.elapsed(), 1);
+
+    long long  workingSetMb = ( getWorkingSetSize() - workingSet ) / 0x100000;
+
+    std::cout << "[ BENCH    ] ntddk.h type provider working set: " << workingSetMb << " MB" << std::endl;
+    RecordProperty("ntddk.h type provider working set MB", static_cast<int>(workingSetMb));
+
+    const wchar_t*  typeNames[] = { L"_UNICODE_STRING", L"_IRP", L"_MDL", L"_FILE_OBJECT", L"_DEVICE_OBJECT", L"ZwCreateFile" };
+
+    timer.restart();
+    for ( auto typeName : typeNames )
+        ASSERT_NO_THROW( typeProvider->getTypeByName(typeName) );
+    reportBenchmark("ntddk.h first type lookup", timer.elapsed(), _countof(typeNames));
+
+    TypeInfoEnumeratorPtr  typeEnum;
+    size_t  count;
+
+    timer.restart();
+    ASSERT_NO_THROW( typeEnum = typeProvider->getTypeEnumerator() );
+    for ( count = 0; 0 != typeEnum->Next(); ++count);
+    reportBenchmark("ntddk.h type enumeration", timer.elapsed(), count);
+}
+
 static const wchar_t test_typedef_src[] = L"\
                                             \
     typedef  int   int_def;                 \
@@ -389,6 +438,14 @@ TEST_F(ClangTest, TypeProviderEnum)
     ASSERT_NO_THROW( typeEnum = typeProvider->getTypeEnumerator(L"struct*") );
     for ( count = 0; 0 != typeEnum->Next(); ++count);
     EXPECT_EQ(14, count);
+
+    ASSERT_NO_THROW( typeEnum = typeProvider->getTypeEnumerator(L"structWith*Bits") );
+    for ( count = 0; 0 != typeEnum->Next(); ++count);
+    EXPECT_EQ(2, count);
+
+    ASSERT_NO_THROW( typeEnum = typeProvider->getTypeEnumerator(L"struct?est") );
+    for ( count = 0; 0 != typeEnum->Next(); ++count);
+    EXPECT_EQ(1, count);
 }
 
 
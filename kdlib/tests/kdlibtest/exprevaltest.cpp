@@ -6,6 +6,8 @@
 #include "test/testvars.h"
 
 #include "procfixture.h"
+#include "benchmark.h"
+#include "stateguard.h"
 
 using namespace kdlib;
 
@@ -316,6 +318,38 @@ TEST(ExprEval, NullPtr)
     EXPECT_EQ(0, evalExpr("(int**)nullptr"));
 }
 
+TEST(ExprEval, ScalarValue)
+{
+    TypedValue  val = evalExpr(L"2 + 2 * 2");
+    EXPECT_EQ(6, val);
+    EXPECT_EQ(L"Int4B", val.getType()->getName());
+    EXPECT_EQ(4, val.getSize());
+
+    EXPECT_EQ(L"Bool", evalExpr(L"true").getType()->getName());
+    EXPECT_EQ(sizeof(bool), evalExpr(L"true").getSize());
+    EXPECT_EQ(L"UInt8B", evalExpr(L"0x8000000000000000ULL").getType()->getName());
+    EXPECT_EQ(L"Double", evalExpr(L"0.5").getType()->getName());
+    EXPECT_EQ(L"Int4B", TypedValue(5U).getType()->getName());
+
+    TypedValue  var = TypedValue(5UL);
+    ASSERT_NO_THROW(var.get()->setValue(7));
+    EXPECT_EQ(7, var);
+    EXPECT_EQ(L"UInt4B", var.getType()->getName());
+}
+
+TEST(ExprEval, ScalarValueBenchmark)
+{
+    const size_t  count = 100000;
+
+    Stopwatch  timer;
+    TypedValue  sum = 0;
+    for (size_t i = 0; i < count; ++i)
+        sum = sum + TypedValue(i) * 4;
+    reportBenchmark("TypedValue scalar arithmetic", timer.elapsed(), count);
+
+    EXPECT_EQ(2ULL * count * (count - 1), sum);
+}
+
 class ExprEvalTarget : public ProcessFixture
 {
 public:
@@ -450,3 +484,126 @@ TEST_F(ExprEvalTarget, MultiArray)
     EXPECT_EQ(intMatrix[1][2], evalExpr(L"intMatrix[1][2]", m_targetModule->getScope()));
     EXPECT_EQ(intMatrix[0][1], evalExpr(L"intMatrix[0][1]", m_targetModule->getScope()));
 }
+
+TEST(ExprEval, CompiledExpr)
+{
+    CompiledExpressionPtr  expr;
+    ASSERT_NO_THROW(expr = compileExpr(L"a * 2 + b"));
+
+    EXPECT_EQ(7, expr->eval(makeScope({ {L"a", 2}, {L"b", 3} })));
+    EXPECT_EQ(23, expr->eval(makeScope({ {L"a", 10}, {L"b", 3} })));
+    EXPECT_THROW(expr->eval(makeScope({ {L"a", 10} })), DbgException);
+
+    EXPECT_EQ(expr, compileExpr(L"a * 2 + b"));
+    EXPECT_EQ(0x1234, compileExpr(L"0x1234")->eval());
+    EXPECT_EQ(L'a', compileExpr(L"'a'")->eval());
+}
+
+TEST(ExprEval, CompiledExprLexerSwitch)
+{
+    ExprLexerGuard  lexerGuard;
+
+    enableClangExprLexer(false);
+
+    CompiledExpressionPtr  builtinExpr;
+    ASSERT_NO_THROW(builtinExpr = compileExpr(L"(1 + 2) * 3"));
+    EXPECT_EQ(builtinExpr, compileExpr(L"(1 + 2) * 3"));
+
+    // the expression cached by the built-in lexer is not reused by the clang one
+    enableClangExprLexer(true);
+
+    CompiledExpressionPtr  clangExpr;
+    ASSERT_NO_THROW(clangExpr = compileExpr(L"(1 + 2) * 3"));
+    EXPECT_NE(builtinExpr, clangExpr);
+    EXPECT_EQ(9, clangExpr->eval());
+
+    enableClangExprLexer(true);
+    EXPECT_EQ(clangExpr, compileExpr(L"(1 + 2) * 3"));
+
+    enableClangExprLexer(false);
+    EXPECT_NE(clangExpr, compileExpr(L"(1 + 2) * 3"));
+}
+
+TEST(ExprEval, CompiledExprBenchmark)
+{
+    const size_t  count = 2000;
+
+    Stopwatch  timer;
+    for (size_t i = 0; i < count; ++i)
+        evalExpr(L"10 * 2 + " + std::to_wstring(i));
+    reportBenchmark("evalExpr new expression", timer.elapsed(), count);
+
+    timer.restart();
+    for (size_t i = 0; i < count; ++i)
+        evalExpr(L"10 * 2 + 1");
+    reportBenchmark("evalExpr cached expression", timer.elapsed(), count);
+}
+
+namespace {
+
+const wchar_t*  exprCorpus[] = {
+    L"1", L"0x1234", L"077", L"2147483648L", L"0x8000000000000000ULL", L"0.5", L"1e+3", L"'a'", L"L'a'", L"'\\n'",
+    L"2 + 2 * 2", L"-(2 * (2 + 2))", L"((( 2 + 2 ) / 2 ) * 4)", L"0xFA01894B & 0xC58F6ACD", L"~0xFA01894B",
+    L"5 + 6 << 2", L"7 >> 3 - 1", L"3 + 8 <= 3 + 8", L"5 != -1 * 5", L"2 == 3 && 5 > 2", L"2 < 3 || 3 < 2",
+    L"!!true", L"false || false", L"0 ? 1 : 5", L"sizeof(int)", L"sizeof(int*)", L"sizeof(const int)",
+    L"sizeof(int[4])", L"sizeof 1", L"(int)2.5", L"(unsigned char)0x1234", L"5 */ 5", L"**5", L"st..", L"?:"
+};
+
+TypedValue evalCorpusExpr(const std::wstring& expr, bool clangLexer)
+{
+    enableClangExprLexer(clangLexer);
+    return evalExpr(expr);
+}
+
+}
+
+TEST(ExprEval, BuiltinLexer)
+{
+    ExprLexerGuard  lexerGuard;
+
+    for (auto expr : exprCorpus)
+    {
+        std::wstring  builtinRes, clangRes;
+
+        try {
+            builtinRes = evalCorpusExpr(expr, false).getValue().asStr();
+        }
+        catch (DbgException&)
+        {}
+
+        try {
+            clangRes = evalCorpusExpr(expr, true).getValue().asStr();
+        }
+        catch (DbgException&)
+        {}
+
+        EXPECT_EQ(clangRes, builtinRes) << expr;
+    }
+}
+
+TEST(ExprEval, LexerBenchmark)
+{
+    const size_t  rounds = 20;
+    const size_t  corpusSize = sizeof(exprCorpus) / sizeof(exprCorpus[0]);
+
+    ExprLexerGuard  lexerGuard;
+
+    for (int clangLexer = 0; clangLexer < 2; ++clangLexer)
+    {
+        enableClangExprLexer(clangLexer != 0);
+
+        double  elapsed = 0;
+
+        for (size_t i = 0; i < rounds; ++i)
+        {
+            resetExprCache();
+
+            Stopwatch  timer;
+            for (auto expr : exprCorpus)
+                compileExpr(expr);
+            elapsed += timer.elapsed();
+        }
+
+        reportBenchmark(clangLexer ? "clang lexer" : "built-in lexer", elapsed, rounds * corpusSize);
+    }
+}
@@ -1,7 +1,9 @@
 #include <stdafx.h>
 
 #include "procfixture.h"
+#include "stateguard.h"
 #include "kdlib/memaccess.h"
+#include "kdlib/memprovider.h"
 #include "kdlib/exceptions.h"
 #include "test/testvars.h"
 
@@ -271,4 +273,139 @@ TEST_F(MemoryTest, testPartial)
     unsigned long readed = 0;
     EXPECT_NO_THROW( readMemory(offset, &tmp, sizeof(tmp), false, &readed) );
     EXPECT_EQ( delta, readed );
+
+    readed = 0;
+    EXPECT_FALSE( readMemoryUnsafe(offset, &tmp, sizeof(tmp), false, &readed) );
+    EXPECT_EQ( delta, readed );
+}
+
+TEST_F(MemoryTest, MemoryCache)
+{
+    MemoryCacheGuard  cacheGuard;
+
+    ASSERT_NO_THROW( enableMemoryCache() );
+    EXPECT_TRUE( isMemoryCacheEnabled() );
+
+    const MEMOFFSET_64  offset = m_targetModule->getSymbolVa(L"ullValuePlace");
+
+    EXPECT_NO_THROW( setQWord(offset, 0x1111111111111111) );
+    EXPECT_EQ( 0x1111111111111111, ptrQWord(offset) );
+
+    const MemoryCacheStatistics  stat1 = getMemoryCacheStatistics();
+    EXPECT_LT( 0, stat1.misses );
+
+    EXPECT_EQ( 0x1111111111111111, ptrQWord(offset) );
+    EXPECT_EQ( 0x11111111, ptrDWord(offset) );
+
+    const MemoryCacheStatistics  stat2 = getMemoryCacheStatistics();
+    EXPECT_EQ( stat1.hits + 2, stat2.hits );
+    EXPECT_EQ( stat1.misses, stat2.misses );
+
+    EXPECT_NO_THROW( setQWord(offset, 0x2222222222222222) );
+    EXPECT_EQ( 0x2222222222222222, ptrQWord(offset) );
+
+    const MEMOFFSET_64  partialOffset = m_targetModule->getEnd() - sizeof(unsigned long long) / 2;
+    EXPECT_THROW( ptrQWord(partialOffset), MemoryException );
+
+    unsigned long long tmp;
+    unsigned long readed = 0;
+    EXPECT_NO_THROW( readMemory(partialOffset, &tmp, sizeof(tmp), false, &readed) );
+    EXPECT_EQ( sizeof(unsigned long long) / 2, readed );
+
+    EXPECT_NO_THROW( enableMemoryCache(false) );
+    EXPECT_FALSE( isMemoryCacheEnabled() );
+    EXPECT_EQ( 0, getMemoryCacheStatistics().cachedPages );
+}
+
+TEST_F(MemoryTest, SnapshotProvider)
+{
+    const MEMOFFSET_64  offset = m_targetModule->getSymbolVa(L"helloStr");
+    const size_t  length = strlen(helloStr) + 1;
+
+    std::vector< std::pair<MEMOFFSET_64, size_t> >  ranges;
+    ranges.push_back( std::make_pair(offset, length) );
+
+    MemoryProviderPtr  snapshot;
+    ASSERT_NO_THROW( snapshot = getSnapshotMemoryProvider(ranges) );
+
+    MemoryProviderGuard  providerGuard;
+
+    ASSERT_NO_THROW( setMemoryProvider(snapshot) );
+    EXPECT_EQ( snapshot, getMemoryProvider() );
+
+    EXPECT_EQ( std::string(helloStr), loadCStr(offset) );
+    EXPECT_TRUE( isVaRegionValid(offset, length) );
+    EXPECT_FALSE( isVaRegionValid(offset, length + 1) );
+    EXPECT_THROW( ptrByte(offset + length), MemoryException );
+
+    EXPECT_NO_THROW( setByte(offset, 'X') );
+    EXPECT_EQ( 'X', ptrByte(offset) );
+
+    ASSERT_NO_THROW( setMemoryProvider(MemoryProviderPtr()) );
+    EXPECT_EQ( getDebugEngineMemoryProvider(), getMemoryProvider() );
+    EXPECT_EQ( std::string(helloStr), loadCStr(offset) );
+}
+
+TEST_F(MemoryTest, BufferProvider)
+{
+    const char  data[] = "Hello, world!";
+
+    MemoryProviderGuard  providerGuard;
+
+    ASSERT_NO_THROW( setMemoryProvider( getBufferMemoryProvider(0x10000, data, sizeof(data)) ) );
+
+    EXPECT_EQ( std::string(data), loadCStr(0x10000) );
+    EXPECT_EQ( 0x10007, searchMemory(0x10000, sizeof(data), std::vector<char>(data + 7, data + 12)) );
+    EXPECT_EQ( MemCommit, getVaState(0x10000) );
+
+    MEMOFFSET_64  regionOffset = 0;
+    unsigned long long  regionLength = 0;
+    EXPECT_EQ( 0x10000, findMemoryRegion(0, regionOffset, regionLength) );
+    EXPECT_EQ( sizeof(data), regionLength );
+
+    EXPECT_FALSE( isVaValid(0x10000 + sizeof(data)) );
+
+    ASSERT_NO_THROW( setMemoryProvider(MemoryProviderPtr()) );
+}
+
+TEST_F(MemoryTest, LoadStrLimit)
+{
+    MemoryProviderGuard  providerGuard;
+
+    // the longest string takes 0x10000 bytes with the terminator
+    std::vector<char>  cstr(0x10000, 'a');
+    cstr.back() = 0;
+
+    ASSERT_NO_THROW( setMemoryProvider( getBufferMemoryProvider(0x10000, cstr) ) );
+    EXPECT_EQ( cstr.size() - 1, loadCStr(0x10000).size() );
+
+    cstr.back() = 'a';
+    cstr.push_back(0);
+
+    ASSERT_NO_THROW( setMemoryProvider( getBufferMemoryProvider(0x10000, cstr) ) );
+    EXPECT_THROW( loadCStr(0x10000), MemoryException );
+
+    std::vector<wchar_t>  wstr(0x10000 / sizeof(wchar_t), L'a');
+    wstr.back() = 0;
+
+    ASSERT_NO_THROW( setMemoryProvider( getBufferMemoryProvider(0x10000, &wstr[0], wstr.size() * sizeof(wchar_t)) ) );
+    EXPECT_EQ( wstr.size() - 1, loadWStr(0x10000).size() );
+
+    wstr.back() = L'a';
+    wstr.push_back(0);
+
+    ASSERT_NO_THROW( setMemoryProvider( getBufferMemoryProvider(0x10000, &wstr[0], wstr.size() * sizeof(wchar_t)) ) );
+    EXPECT_THROW( loadWStr(0x10000), MemoryException );
+
+    // no terminator up to the end of the readable memory
+    const char  unterminated[] = { 'a', 'b', 'c' };
+
+    ASSERT_NO_THROW( setMemoryProvider( getBufferMemoryProvider(0x10000, unterminated, sizeof(unterminated)) ) );
+    EXPECT_THROW( loadCStr(0x10000), MemoryException );
+
+    // a terminator before the end of the readable memory
+    const char  terminated[] = { 'a', 'b', 0 };
+
+    ASSERT_NO_THROW( setMemoryProvider( getBufferMemoryProvider(0x10000, terminated, sizeof(terminated)) ) );
+    EXPECT_EQ( std::string("ab"), loadCStr(0x10000) );
 }
@@ -0,0 +1,79 @@
+#include <stdafx.h>
+
+#include <algorithm>
+
+#include "procfixture.h"
+#include "stateguard.h"
+#include "kdlib/memaccess.h"
+#include "kdlib/minidump.h"
+#include "test/testvars.h"
+
+using namespace kdlib;
+
+class MinidumpTest : public ProcessFixture 
+{
+public:
+
+    MinidumpTest() : ProcessFixture( L"memtest" ) {}
+};
+
+TEST_F( MinidumpTest, FullDump )
+{
+    ASSERT_NO_THROW( writeDump(L"minidumptest.dmp", false) );
+
+    MinidumpPtr  dump;
+    ASSERT_NO_THROW( dump = openMinidump(L"minidumptest.dmp") );
+
+    std::vector<MEMOFFSET_64>  dumpModules = dump->getModuleBasesList();
+    std::vector<MEMOFFSET_64>  modules = getModuleBasesList();
+    std::sort( modules.begin(), modules.end() );
+    std::sort( dumpModules.begin(), dumpModules.end() );
+    EXPECT_EQ( modules, dumpModules );
+
+    const MEMOFFSET_64  base = m_targetModule->getBase();
+    EXPECT_EQ( getModuleName(base), dump->getModuleName(base) );
+    EXPECT_EQ( getModuleSize(base), dump->getModuleSize(base) );
+    EXPECT_EQ( getModuleTimeStamp(base), dump->getModuleTimeStamp(base) );
+    EXPECT_EQ( getModuleCheckSum(base), dump->getModuleCheckSum(base) );
+    EXPECT_EQ( base, dump->findModuleBase(base + 0x10) );
+
+    EXPECT_EQ( getNumberThreads(), dump->getNumberThreads() );
+
+    for ( unsigned long i = 0; i < dump->getNumberThreads(); ++i )
+    {
+        if ( dump->getThreadSystemId(i) == getThreadSystemId() )
+        {
+            EXPECT_EQ( getThreadOffset(), dump->getThreadOffset(i) );
+            EXPECT_EQ( getStackOffset(), dump->getThreadSP(i) );
+        }
+    }
+
+    const MEMOFFSET_64  helloStrOffset = m_targetModule->getSymbolVa(L"helloStr");
+
+    MemoryProviderGuard  providerGuard;
+
+    ASSERT_NO_THROW( setMemoryProvider(dump) );
+    EXPECT_EQ( std::string(helloStr), loadCStr(helloStrOffset) );
+    EXPECT_EQ( std::wstring(helloWStr), loadWStr(m_targetModule->getSymbolVa(L"helloWStr")) );
+    ASSERT_NO_THROW( setMemoryProvider(MemoryProviderPtr()) );
+}
+
+TEST_F( MinidumpTest, SmallDump )
+{
+    ASSERT_NO_THROW( writeDump(L"minidumptest_small.dmp", true) );
+
+    MinidumpPtr  dump;
+    ASSERT_NO_THROW( dump = openMinidump(L"minidumptest_small.dmp") );
+
+    const MEMOFFSET_64  base = m_targetModule->getBase();
+    EXPECT_EQ( L"targetapp", dump->getModuleName(base) );
+    EXPECT_EQ( m_targetModule->getSize(), dump->getModuleSize(base) );
+    EXPECT_EQ( getNumberThreads(), dump->getNumberThreads() );
+    EXPECT_LT( 0, dump->getThreadContext(0).size() );
+}
+
+TEST_F( MinidumpTest, NotDump )
+{
+    EXPECT_THROW( openMinidump(L"targetapp.exe"), DbgException );
+    EXPECT_THROW( openMinidump(L"not_existing_file.dmp"), DbgException );
+}
@@ -10,6 +10,7 @@
 
 #include "procfixture.h"
 #include "eventhandlermock.h"
+#include "stateguard.h"
 
 using namespace kdlib;
 using namespace testing;
@@ -109,6 +110,51 @@ TEST_F( ModuleTest, findSymbol )
     EXPECT_THROW( m_targetModule->findSymbol( m_targetModule->getSymbolVa(L"g_structTestAAAA"), displacement ), SymbolException );
 }
 
+TEST_F( ModuleTest, findSymbols )
+{
+    const MEMOFFSET_64  structTest = m_targetModule->getSymbolVa(L"g_structTest");
+    const MEMOFFSET_64  classChild = m_targetModule->getSymbolVa(L"g_classChild");
+
+    std::vector<MEMOFFSET_64>  offsets = { classChild, structTest + 1, 0, structTest, classChild };
+    std::vector<MEMDISPLACEMENT>  displacements;
+
+    std::vector<std::wstring>  names;
+    ASSERT_NO_THROW( names = findSymbols( offsets, displacements ) );
+    ASSERT_EQ( offsets.size(), names.size() );
+    ASSERT_EQ( offsets.size(), displacements.size() );
+
+    EXPECT_EQ( L"g_classChild", names[0] );
+    EXPECT_EQ( L"g_structTest", names[1] );
+    EXPECT_EQ( 1, displacements[1] );
+    EXPECT_TRUE( names[2].empty() );
+    EXPECT_EQ( L"g_structTest", names[3] );
+    EXPECT_EQ( 0, displacements[3] );
+    EXPECT_EQ( names[0], names[4] );
+
+    EXPECT_EQ( m_targetModule, loadModule(structTest + 1) );
+}
+
+TEST_F( ModuleTest, symbolIndex )
+{
+    SymbolIndexGuard  indexGuard;
+
+    enableSymbolIndex();
+    EXPECT_TRUE( isSymbolIndexEnabled() );
+
+    EXPECT_EQ( m_targetModule->getBase(), findModuleBySymbol(L"g_structTest") );
+    EXPECT_EQ( m_targetModule->getBase(), findModuleBySymbol(L"structTest") );
+    EXPECT_EQ( m_targetModule->getSymbolVa(L"g_structTest"), getSymbolOffset(L"g_structTest") );
+    EXPECT_EQ( m_targetModule->getBase(), findModuleBySymbol(L"structTest*") );
+    EXPECT_THROW( findModuleBySymbol(L"notExistSymbol"), SymbolException );
+
+    m_targetModule->resetSymbols();
+    EXPECT_EQ( m_targetModule->getBase(), findModuleBySymbol(L"g_structTest") );
+
+    enableSymbolIndex(false);
+    EXPECT_FALSE( isSymbolIndexEnabled() );
+    EXPECT_EQ( m_targetModule->getBase(), findModuleBySymbol(L"g_structTest") );
+}
+
 TEST_F( ModuleTest, getTypedVar )
 {
     MEMOFFSET_64 offset;
@@ -125,6 +171,38 @@ TEST_F( ModuleTest, getTypedVar )
     EXPECT_THROW( m_targetModule->getTypedVarByTypeName( L"structTest", m_targetModule->getEnd() )->getElement(L"m_field0")->getValue(), MemoryException );
 }
 
+TEST_F( ModuleTest, exportSymbols )
+{
+    const HMODULE  kernel32 = GetModuleHandleW(L"kernel32.dll");
+    ASSERT_TRUE( kernel32 != NULL );
+
+    const MEMOFFSET_64  kernel32Base = reinterpret_cast<MEMOFFSET_64>(kernel32);
+    const MEMOFFSET_64  procAddress = reinterpret_cast<MEMOFFSET_64>( GetProcAddress(kernel32, "GetProcAddress") );
+
+    SymbolSessionPtr  session;
+    ASSERT_NO_THROW( session = loadSymbolFromExports(kernel32Base) );
+    EXPECT_EQ( std::wstring(L"export symbols"), session->getSymbolFileName() );
+
+    SymbolPtr  symbol;
+    ASSERT_NO_THROW( symbol = session->getSymbolScope()->getChildByName(L"GetProcAddress") );
+    EXPECT_EQ( procAddress, kernel32Base + symbol->getRva() );
+
+    long  displacement = 0;
+    ASSERT_NO_THROW( symbol = session->findByRva( static_cast<MEMOFFSET_32>(procAddress - kernel32Base + 1), SymTagNull, &displacement ) );
+    EXPECT_EQ( procAddress + 1, kernel32Base + symbol->getRva() + displacement );
+
+    // the second session reuses the export map of the image
+    SymbolSessionPtr  session2;
+    ASSERT_NO_THROW( session2 = loadSymbolFromExports(kernel32Base) );
+    EXPECT_EQ( session->getSymbolScope()->findChildren(SymTagPublicSymbol).size(),
+        session2->getSymbolScope()->findChildren(SymTagPublicSymbol).size() );
+    EXPECT_FALSE( session2->getSymbolScope()->findChildren(SymTagPublicSymbol, L"GetProc*").empty() );
+
+    EXPECT_EQ( 1, session->getSymbolScope()->findChildren(SymTagPublicSymbol, L"GetProcAddress").size() );
+    EXPECT_FALSE( session->getSymbolScope()->findChildren(SymTagPublicSymbol, L"*ProcAddr?ss").empty() );
+    EXPECT_TRUE( session->getSymbolScope()->findChildren(SymTagPublicSymbol, L"GetProcAddress?*").empty() );
+}
+
 TEST_F( ModuleTest, getSymbolSize )
 {
     EXPECT_EQ( sizeof(structTest), m_targetModule->getSymbolSize(L"structTest") );
@@ -1,8 +1,14 @@
 #include <stdafx.h>
 
+#include <fstream>
+#include <iterator>
+#include <map>
+
 #include "procfixture.h"
 #include "kdlib/kdlib.h"
 
+#include "../../source/net/climetadata.h"
+
 using namespace kdlib;
 
 typedef ::testing::Types<NetProcessFixture, NetDumpFixture>  NetTargetTypes;
@@ -41,6 +47,27 @@ TYPED_TEST(NetTest, NetHeap)
     EXPECT_TRUE( heapEnum->next(address, typeName, size) );
 }
 
+TYPED_TEST(NetTest, NetHeapStatistics)
+{
+    kdlib::TargetHeapPtr  targetHeap;
+    ASSERT_NO_THROW(targetHeap = TargetProcess::getCurrent()->getManagedHeap());
+
+    kdlib::TargetHeapStat  heapStat;
+    ASSERT_NO_THROW(heapStat = targetHeap->getStatistics(L"managedapp*"));
+    ASSERT_FALSE(heapStat.empty());
+
+    size_t  count = 0;
+    for (const auto& typeStat : heapStat)
+    {
+        EXPECT_EQ(0, typeStat.typeName.find(L"managedapp"));
+        EXPECT_LT(0, typeStat.count);
+        count += typeStat.count;
+    }
+
+    EXPECT_EQ(targetHeap->getCount(L"managedapp*"), count);
+    EXPECT_LE(heapStat.back().totalSize, heapStat.front().totalSize);
+}
+
 TYPED_TEST(NetTest, NetModuleEnumTypes)
 {
     auto types = m_targetModule->enumTypes();
@@ -48,6 +75,13 @@ TYPED_TEST(NetTest, NetModuleEnumTypes)
     EXPECT_EQ(types.end(), std::find(types.begin(), types.end(), L"managedapp.Notexist"));
 }
 
+TYPED_TEST(NetTest, NetModuleEnumTypesMask)
+{
+    auto types = m_targetModule->enumTypes(L"managedapp.TestClass*");
+    EXPECT_EQ(2, types.size());
+    EXPECT_NE(types.end(), std::find(types.begin(), types.end(), L"managedapp.TestClassBase"));
+}
+
 TYPED_TEST(NetTest, DISABLED_GetType)
 {
     EXPECT_EQ(L"managedapp.Class1", m_targetModule->getTypeByName(L"managedapp.Class1")->getName());
@@ -149,3 +183,72 @@ TYPED_TEST(NetTestObj, StaticField)
 {
     EXPECT_EQ(L"staticField",  m_testClassVar->getElement(L"staticStrField")->getStrValue() );
 }
+
+class CliMetaDataTest : public ::testing::Test
+{
+protected:
+
+    virtual void SetUp() override
+    {
+        // the image file on disk is not mapped by sections
+        std::ifstream  file("managedapp.exe", std::ios::binary);
+        std::vector<unsigned char>  image( (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>() );
+
+        ASSERT_FALSE( image.empty() );
+        ASSERT_NO_THROW( m_metaData = CliMetaDataPtr( new CliMetaData(image, false) ) );
+    }
+
+    CliMetaDataPtr  m_metaData;
+};
+
+TEST_F(CliMetaDataTest, TypeName)
+{
+    CliMetaData::Token  nested;
+    ASSERT_TRUE( m_metaData->findTypeDef(L"managedapp.Class1.Nested", nested) );
+    EXPECT_TRUE( m_metaData->isTypeDef(nested) );
+    EXPECT_EQ( L"managedapp.Class1.Nested", m_metaData->getTypeName(nested) );
+
+    CliMetaData::Token  enclosing;
+    ASSERT_TRUE( m_metaData->findTypeDef(L"managedapp.Class1", enclosing) );
+    EXPECT_EQ( enclosing, m_metaData->getEnclosingType(nested) );
+    EXPECT_EQ( 0, m_metaData->getEnclosingType(enclosing) );
+
+    CliMetaData::Token  typeDef;
+    EXPECT_FALSE( m_metaData->findTypeDef(L"managedapp.Nested", typeDef) );
+    EXPECT_FALSE( m_metaData->findTypeDef(L"managedapp.NotExistType", typeDef) );
+}
+
+TEST_F(CliMetaDataTest, ModuleTypeExcluded)
+{
+    CliMetaData::TokenList  typeDefs = m_metaData->getTypeDefs();
+
+    EXPECT_FALSE( typeDefs.empty() );
+    EXPECT_EQ( typeDefs.end(), std::find(typeDefs.begin(), typeDefs.end(), CliMetaData::typeDefToken | 1) );
+
+    for ( CliMetaData::Token typeDef : typeDefs )
+        EXPECT_NE( L"<Module>", m_metaData->getTypeName(typeDef) );
+}
+
+TEST_F(CliMetaDataTest, Fields)
+{
+    CliMetaData::Token  typeDef;
+    ASSERT_TRUE( m_metaData->findTypeDef(L"managedapp.TestClass", typeDef) );
+
+    std::map<std::wstring, std::uint16_t>  fields;
+
+    for ( CliMetaData::Token fieldDef : m_metaData->getFields(typeDef) )
+        fields[m_metaData->getFieldName(fieldDef)] = m_metaData->getFieldFlags(fieldDef);
+
+    // the fields of the base class are not listed
+    EXPECT_EQ( 8, fields.size() );
+    EXPECT_EQ( 0, fields.count(L"longField") );
+
+    ASSERT_EQ( 1, fields.count(L"staticStrField") );
+    EXPECT_NE( 0, fields[L"staticStrField"] & 0x10 );
+
+    ASSERT_EQ( 1, fields.count(L"charField") );
+    EXPECT_EQ( 0, fields[L"charField"] & 0x10 );
+
+    ASSERT_EQ( 1, fields.count(L"class1Field") );
+    EXPECT_EQ( 0, fields[L"class1Field"] & 0x10 );
+}
@@ -182,6 +182,52 @@ TEST_P( StackTest, LocalVars )
     EXPECT_FALSE(frame->findStaticVar(L"localChars"));
 }
 
+TEST_P( StackTest, LocalVarsAllFrames )
+{
+    StackPtr  stack;
+    ASSERT_NO_THROW(stack = getStack());
+
+    for (unsigned long i = 0; i < stack->getFrameCount(); ++i)
+    {
+        StackFramePtr  frame = stack->getFrame(i);
+
+        for (unsigned long j = 0; j < frame->getLocalVarCount(); ++j)
+        {
+            std::wstring  name = frame->getLocalVarName(j);
+            EXPECT_TRUE(frame->findLocalVar(name));
+            EXPECT_NO_THROW(frame->getLocalVar(name));
+        }
+
+        for (unsigned long j = 0; j < frame->getTypedParamCount(); ++j)
+            EXPECT_TRUE(frame->findParam(frame->getTypedParamName(j)));
+    }
+
+    // frames of the other stack object at the same addresses share the scope
+    StackFramePtr  frame = getStack()->getFrame(2);
+    EXPECT_EQ(3, frame->getLocalVarCount());
+    EXPECT_FLOAT_EQ(0.8f, frame->getLocalVar(L"localFloat")->getValue().asFloat());
+}
+
+TEST_P( StackTest, FailedScopeCached )
+{
+    StackPtr  stack;
+    ASSERT_NO_THROW(stack = getStack());
+    ASSERT_LT(0UL, stack->getFrameCount());
+
+    // the thread start frame is in a system module without private symbols
+    const unsigned long  last = stack->getFrameCount() - 1;
+    EXPECT_EQ(0, stack->getFrame(last)->getTypedParamCount());
+
+    const FrameScopeStatistics  stat = getFrameScopeStatistics();
+    EXPECT_LT(0, stat.failedScopes);
+
+    // the symbols are not queried again for the same address
+    EXPECT_EQ(0, getStack()->getFrame(last)->getTypedParamCount());
+    EXPECT_EQ(0, getStack()->getFrame(last)->getLocalVarCount());
+    EXPECT_EQ(stat.misses, getFrameScopeStatistics().misses);
+    EXPECT_LT(stat.hits, getFrameScopeStatistics().hits);
+}
+
 TEST_P( StackTest, StaticVars )
 {
     StackFramePtr  frame;
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <boost/noncopyable.hpp>
+
+#include "kdlib/memaccess.h"
+#include "kdlib/module.h"
+#include "kdlib/memprovider.h"
+#include "kdlib/typeinfo.h"
+#include "kdlib/typedvar.h"
+#include "kdlib/exceptions.h"
+
+// The guards restore a global setting changed by a test when the test ends,
+// also when an ASSERT_* leaves the test early
+
+class MemoryCacheGuard : private boost::noncopyable
+{
+public:
+
+    ~MemoryCacheGuard() {
+        try {
+            kdlib::enableMemoryCache(false);
+        } catch(kdlib::DbgException&)
+        {}
+    }
+};
+
+class MemoryProviderGuard : private boost::noncopyable
+{
+public:
+
+    ~MemoryProviderGuard() {
+        kdlib::setMemoryProvider(kdlib::MemoryProviderPtr());
+    }
+};
+
+class SymbolIndexGuard : private boost::noncopyable
+{
+public:
+
+    ~SymbolIndexGuard() {
+        kdlib::enableSymbolIndex(false);
+    }
+};
+
+class TypeCacheLimitGuard : private boost::noncopyable
+{
+public:
+
+    ~TypeCacheLimitGuard() {
+        try {
+            kdlib::setTypeCacheLimit();
+        } catch(kdlib::DbgException&)
+        {}
+    }
+};
+
+class ExprLexerGuard : private boost::noncopyable
+{
+public:
+
+    ~ExprLexerGuard() {
+        kdlib::enableClangExprLexer(false);
+    }
+};
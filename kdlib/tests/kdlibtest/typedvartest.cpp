@@ -1,6 +1,10 @@
 #include <stdafx.h>
 
+#include <boost/make_shared.hpp>
+
 #include "procfixture.h"
+#include "benchmark.h"
+#include "stateguard.h"
 
 #include "kdlib/kdlib.h"
 
@@ -250,11 +254,137 @@ TEST_F( TypedVarTest, LoadTypedVarList )
     EXPECT_EQ( 2, *lst[2]->getElement(L"num") );
 }
 
+TEST_F( TypedVarTest, WalkTypedVarList )
+{
+    const MEMOFFSET_64  listHead = m_targetModule->getSymbolVa(L"g_listHead");
+
+    TypedVarListWalkerPtr  walker;
+    ASSERT_NO_THROW( walker = walkTypedVarList( listHead, L"listStruct", L"next.flink" ) );
+
+    std::vector<TypedVarPtr>  entries;
+    for ( TypedVarPtr entry = walker->next(); entry; entry = walker->next() )
+    {
+        EXPECT_EQ( static_cast<int>(entries.size()), *entry->getElement(L"num") );
+        entries.push_back( entry );
+    }
+
+    EXPECT_EQ( 5, entries.size() );
+    EXPECT_EQ( 5, walker->getCount() );
+    EXPECT_FALSE( walker->next() );
+
+    ASSERT_NO_THROW( walker = walkTypedVarList( listHead, L"listStruct", L"next.flink", 3 ) );
+    EXPECT_NO_THROW( walker->next() );
+    EXPECT_NO_THROW( walker->next() );
+    EXPECT_NO_THROW( walker->next() );
+    EXPECT_THROW( walker->next(), DbgException );
+
+    // loop the last entry to the second one
+    const MEMOFFSET_64  lastLink = entries[4]->getElement(L"next")->getElement(L"flink")->getAddress();
+    const MEMOFFSET_64  secondLink = entries[1]->getElement(L"next")->getAddress();
+
+    setPtr( lastLink, secondLink );
+
+    EXPECT_THROW( loadTypedVarList( listHead, L"listStruct", L"next.flink" ), DbgException );
+
+    setPtr( lastLink, listHead );
+
+    EXPECT_EQ( 5, loadTypedVarList( listHead, L"listStruct", L"next.flink" ).size() );
+}
+
 TEST_F( TypedVarTest, LoadTypedVarArray )
 {
     TypedVarList   lst;
     ASSERT_NO_THROW( lst = loadTypedVarArray( m_targetModule->getSymbolVa(L"g_testArray"), L"listStruct", 2 ));
     EXPECT_EQ( 2, lst.size() );
+    EXPECT_EQ( m_targetModule->getSymbolVa(L"g_testArray") + lst[0]->getSize(), lst[1]->getAddress() );
+    EXPECT_EQ( lst[1]->getAddress(), lst[1]->getElement(L"num")->getAddress() );
+
+    // the elements share a snapshot of the array which must follow the target memory
+    const MEMOFFSET_64  numOffset = lst[1]->getElement(L"num")->getAddress();
+    const unsigned long  num = ptrDWord(numOffset);
+    ASSERT_NO_THROW( writeDWords(numOffset, std::vector<unsigned long>(1, num + 1)) );
+    EXPECT_EQ( num + 1, lst[1]->getElement(L"num")->getValue().asULong() );
+    ASSERT_NO_THROW( writeDWords(numOffset, std::vector<unsigned long>(1, num)) );
+    EXPECT_EQ( num, lst[1]->getElement(L"num")->getValue().asULong() );
+}
+
+TEST_F( TypedVarTest, FieldProjection )
+{
+    TypedVarList  lst = loadTypedVarList( m_targetModule->getSymbolVa(L"g_listHead"), L"listStruct", L"next.flink" );
+
+    std::vector<MEMOFFSET_64>  addresses;
+    for ( auto& var : lst )
+        addresses.push_back( var->getAddress() );
+
+    std::vector<std::wstring>  fields = { L"next.flink", L"num" };
+
+    FieldProjectionPtr  projection;
+    ASSERT_NO_THROW( projection = projectFields( loadType(L"listStruct"), fields ) );
+    EXPECT_EQ( 2, projection->getFieldCount() );
+    EXPECT_TRUE( projection->getFieldType(0)->isPointer() );
+
+    std::vector<NumVariantColumn>  columns;
+    ASSERT_NO_THROW( columns = projection->apply(addresses) );
+    ASSERT_EQ( 2, columns.size() );
+    ASSERT_EQ( lst.size(), columns[1].size() );
+
+    for ( size_t i = 0; i < lst.size(); ++i )
+    {
+        EXPECT_EQ( lst[i]->getElement(L"next")->getElement(L"flink")->getValue(), columns[0][i] );
+        EXPECT_EQ( lst[i]->getElement(L"num")->getValue(), columns[1][i] );
+    }
+
+    fields = { L"m_bit6_8", L"m_bit0_4", L"m_bit5", L"m_bit0_60" };
+    ASSERT_NO_THROW( projection = projectFields( loadType(L"structWithBits"), fields ) );
+    ASSERT_NO_THROW( columns = projection->apply( std::vector<MEMOFFSET_64>(1, m_targetModule->getSymbolVa(L"g_structWithBits")) ) );
+    EXPECT_EQ( g_structWithBits.m_bit6_8, columns[0][0] );
+    EXPECT_EQ( g_structWithBits.m_bit0_4, columns[1][0] );
+    EXPECT_EQ( g_structWithBits.m_bit5, columns[2][0] );
+    EXPECT_EQ( g_structWithBits.m_bit0_60, columns[3][0] );
+
+    // a negative enum value comes out as TypedVar::getValue gives it
+    const MEMOFFSET_64  signEnumOffset = m_targetModule->getSymbolVa(L"g_structWithSignEnum");
+    ASSERT_NO_THROW( projection = projectFields( loadType(L"structWithSignEnum"), std::vector<std::wstring>(1, L"sign") ) );
+    ASSERT_NO_THROW( columns = projection->apply( std::vector<MEMOFFSET_64>(1, signEnumOffset) ) );
+    EXPECT_EQ( loadTypedVar(L"g_structWithSignEnum")->getElement(L"sign")->getValue(), columns[0][0] );
+    EXPECT_EQ( static_cast<unsigned long>(MINUS_ONE), columns[0][0].asULong() );
+
+    EXPECT_THROW( projectFields( loadType(L"listStruct"), std::vector<std::wstring>(1, L"next") ), TypeException );
+}
+
+TEST_F( TypedVarTest, LoadTypedVarArrayBenchmark )
+{
+    const size_t  elementCount = 0x10000;
+    const MEMOFFSET_64  arrayOffset = 0x1000000;
+
+    TypeInfoPtr  structType = defineStruct(L"BenchStruct");
+    structType->appendField(L"field1", loadType(L"UInt8B"));
+    structType->appendField(L"field2", loadType(L"UInt8B"));
+    structType->appendField(L"field3", loadType(L"UInt8B"));
+    structType->appendField(L"field4", loadType(L"UInt8B"));
+    ASSERT_EQ( 32, structType->getSize() );
+
+    MemoryProviderGuard  providerGuard;
+
+    std::vector<unsigned long long>  image(elementCount * 4);
+    for ( size_t i = 0; i < elementCount; ++i )
+        image[i * 4] = i;
+
+    ASSERT_NO_THROW( setMemoryProvider( getBufferMemoryProvider(arrayOffset, &image[0], image.size() * sizeof(image[0])) ) );
+
+    Stopwatch  timer;
+
+    TypedVarList  lst = loadTypedVarArray( arrayOffset, structType, elementCount );
+
+    unsigned long long  sum = 0;
+    for ( auto& var : lst )
+        sum += var->getElement(L"field1")->getValue().asULongLong();
+
+    reportBenchmark( "loadTypedVarArray 64k x 32 bytes", timer.elapsed(), elementCount );
+
+    EXPECT_EQ( elementCount, lst.size() );
+    EXPECT_EQ( elementCount * (elementCount - 1) / 2, sum );
+    EXPECT_EQ( arrayOffset + 32 * 5, lst[5]->getAddress() );
 }
 
 TEST_F( TypedVarTest, FuncPtr )
@@ -682,6 +812,76 @@ TEST_F(TypedVarTest, CacheDataAccess)
     EXPECT_THROW( *ptr4->getElement(L"m_bit0_60"), DbgException );
 }
 
+TEST_F(TypedVarTest, PrefetchDataAccess)
+{
+    TypeInfoPtr  structType;
+    ASSERT_NO_THROW( structType = loadType(L"structTest") );
+
+    const MEMOFFSET_64  offset = m_targetModule->getSymbolVa(L"g_testArray");
+    const size_t  length = 2 * structType->getSize();
+
+    TypedVarPtr  arrayVar;
+    ASSERT_NO_THROW( arrayVar = loadTypedVar(loadType(L"g_testArray"), getMemoryAccessor(offset, length, true)) );
+
+    EXPECT_EQ( 500, *arrayVar->getElement(0)->getElement(L"m_field1") );
+    EXPECT_EQ( 1500, *arrayVar->getElement(1)->getElement(L"m_field1") );
+    EXPECT_EQ( false, *arrayVar->getElement(1)->getElement(L"m_field2") );
+
+    // reads are served from the prefetched buffer, writes go through
+    TypedVarPtr  field;
+    ASSERT_NO_THROW( field = arrayVar->getElement(1)->getElement(L"m_field1") );
+    EXPECT_NO_THROW( field->setValue(1501) );
+    EXPECT_EQ( 1501, *field );
+    EXPECT_EQ( 1501, ptrDWord(field->getAddress()) );
+    EXPECT_NO_THROW( field->setValue(1500) );
+
+    // a write past the accessor drops the prefetched snapshot
+    const MEMOFFSET_64  fieldOffset = field->getAddress();
+    EXPECT_NO_THROW( writeDWords(fieldOffset, std::vector<unsigned long>(1, 1502)) );
+    EXPECT_EQ( 1502, *field );
+    EXPECT_EQ( 1502, *arrayVar->getElement(1)->getElement(L"m_field1") );
+    EXPECT_NO_THROW( writeDWords(fieldOffset, std::vector<unsigned long>(1, 1500)) );
+    EXPECT_EQ( 1500, *field );
+
+    std::vector<char>  raw(length);
+    DataAccessorPtr  dataRange = getMemoryAccessor(offset, length, true);
+    EXPECT_NO_THROW( dataRange->readRaw(&raw[0], length) );
+    EXPECT_EQ( loadSignBytes(offset, static_cast<unsigned long>(length)), raw );
+    EXPECT_THROW( dataRange->readRaw(&raw[0], 1, length), DbgException );
+}
+
+TEST_F(TypedVarTest, SharedCacheDataAccess)
+{
+    boost::shared_ptr< std::vector<char> >  buffer = boost::make_shared< std::vector<char> >(16);
+    for ( size_t i = 0; i < buffer->size(); ++i )
+        (*buffer)[i] = static_cast<char>(i);
+
+    DataAccessorPtr  dataRange;
+    ASSERT_NO_THROW( dataRange = getSharedCacheAccessor(buffer) );
+    EXPECT_EQ( 16, dataRange->getLength() );
+
+    // slices share the buffer
+    DataAccessorPtr  slice;
+    ASSERT_NO_THROW( slice = dataRange->copy(4, 8) );
+    EXPECT_EQ( 8, slice->getLength() );
+    EXPECT_EQ( 0x0b0a0908, slice->readDWord(1) );
+    EXPECT_NO_THROW( slice->writeByte(0x55, 0) );
+    EXPECT_EQ( 0x55, (*buffer)[4] );
+    EXPECT_EQ( 0x55, dataRange->readByte(4) );
+
+    unsigned long  dwords[2] = {};
+    EXPECT_NO_THROW( slice->readDWords(dwords, 2) );
+    EXPECT_EQ( 0x0b0a0908, dwords[1] );
+    EXPECT_THROW( slice->readDWords(dwords, 3), DbgException );
+
+    const unsigned short  word = 0x1234;
+    EXPECT_NO_THROW( slice->writeRaw(&word, sizeof(word), 2) );
+    EXPECT_EQ( 0x1234, dataRange->readWord(3) );
+
+    EXPECT_THROW( slice->copy(9), DbgException );
+    EXPECT_THROW( getSharedCacheAccessor(buffer, 8, 9), DbgException );
+}
+
 TEST_F(TypedVarTest, SetStructFieldByName)
 {
     std::vector<char> byteArray( 100 );
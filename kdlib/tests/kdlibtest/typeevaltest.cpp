@@ -5,6 +5,8 @@
 
 #include "test/testvars.h"
 
+#include "stateguard.h"
+
 using namespace kdlib;
 
 TEST(TypeEvalTest, BaseType)
@@ -614,3 +616,35 @@ TEST(TypeEvalTest, TemplateWcharT)
 
     EXPECT_EQ(L"TestStruct<wchar_t>", evalType("TestStruct<wchar_t>", typeProvider)->getName());
 }
+
+TEST(TypeEvalTest, BuiltinLexer)
+{
+    const char*  corpus[] = {
+        "char", "unsigned long long", "__int64", "wchar_t", "size_t", "int*", "const int* const",
+        "int[4]", "int(*)[2]", "long&&", "TestStruct0<'a'>", "TestStruct0<0x4>", "TestStruct<20>>1>",
+        "TestStruct1<const TestStruct1<char>>", "TestEnum::TEN", "TestStruct::", "long short"
+    };
+
+    ExprLexerGuard  lexerGuard;
+
+    for (auto expr : corpus)
+    {
+        std::wstring  builtinRes, clangRes;
+
+        enableClangExprLexer(false);
+        try {
+            builtinRes = evalType(expr)->getName();
+        }
+        catch (DbgException&)
+        {}
+
+        enableClangExprLexer(true);
+        try {
+            clangRes = evalType(expr)->getName();
+        }
+        catch (DbgException&)
+        {}
+
+        EXPECT_EQ(clangRes, builtinRes) << expr;
+    }
+}
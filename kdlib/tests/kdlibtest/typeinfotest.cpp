@@ -1,6 +1,8 @@
 #include <stdafx.h>
 
 #include "procfixture.h"
+#include "benchmark.h"
+#include "stateguard.h"
 
 #include "kdlib/typeinfo.h"
 #include "kdlib/exceptions.h"
@@ -715,3 +717,199 @@ TEST_F(TypeInfoTest, isInheritedMember)
     EXPECT_THROW(loadType(L"Int8B[]")->isInheritedMember(0), TypeException);
 }
 
+TEST_F(TypeInfoTest, FieldLookupByName)
+{
+    TypeInfoPtr  typeInfo;
+    ASSERT_NO_THROW(typeInfo = loadType(L"classChild"));
+
+    // classBase1 and classBase2 both have m_baseField: the first one is found
+    size_t  baseFieldIndex = -1;
+    for (size_t i = 0; i < typeInfo->getElementCount(); ++i)
+    {
+        std::wstring  name = typeInfo->getElementName(i);
+
+        if (name == L"m_baseField")
+        {
+            if (baseFieldIndex == -1)
+                baseFieldIndex = i;
+            continue;
+        }
+
+        EXPECT_EQ(i, typeInfo->getElementIndex(name));
+        EXPECT_EQ(typeInfo->getElement(i), typeInfo->getElement(name));
+    }
+
+    ASSERT_NE(-1, baseFieldIndex);
+    EXPECT_EQ(baseFieldIndex, typeInfo->getElementIndex(L"m_baseField"));
+    EXPECT_EQ(typeInfo->getElement(baseFieldIndex), typeInfo->getElement(L"m_baseField"));
+
+    EXPECT_THROW(typeInfo->getElement(L"m_notExist"), TypeException);
+    EXPECT_THROW(typeInfo->getElementIndex(L"m_notExist"), TypeException);
+
+    // fields appended after the first lookup are found by name too
+    TypeInfoPtr  testStruct;
+    ASSERT_NO_THROW(testStruct = defineStruct(L"TestStruct"));
+    ASSERT_NO_THROW(testStruct->appendField(L"field1", loadType(L"Int1B")));
+    EXPECT_EQ(0, testStruct->getElementIndex(L"field1"));
+    EXPECT_THROW(testStruct->getElementIndex(L"field2"), TypeException);
+
+    ASSERT_NO_THROW(testStruct->appendField(L"field2", loadType(L"Double")));
+    EXPECT_EQ(1, testStruct->getElementIndex(L"field2"));
+    EXPECT_EQ(L"Double", testStruct->getElement(L"field2")->getName());
+
+    EXPECT_THROW(testStruct->appendField(L"field1", loadType(L"Long")), TypeException);
+    EXPECT_EQ(2, testStruct->getElementCount());
+    EXPECT_EQ(L"Int1B", testStruct->getElement(L"field1")->getName());
+}
+
+
+TEST_F(TypeInfoTest, FieldTypeCache)
+{
+    TypeInfoPtr  typeInfo;
+    ASSERT_NO_THROW(typeInfo = loadType(L"structTest"));
+
+    TypeInfoPtr  fieldType;
+    ASSERT_NO_THROW(fieldType = typeInfo->getElement(L"m_field4"));
+    EXPECT_EQ(fieldType, typeInfo->getElement(L"m_field4"));
+    EXPECT_EQ(fieldType, typeInfo->getElement(4));
+
+    TypeInfoPtr  derefType;
+    ASSERT_NO_THROW(derefType = fieldType->deref());
+
+    TypeInfoPtr  baseFieldType;
+    ASSERT_NO_THROW(baseFieldType = typeInfo->getElement(L"m_field1"));
+
+    m_targetModule->resetSymbols();
+
+    // the pointer field gets a new type after the reset
+    TypeInfoPtr  reloadedType;
+    ASSERT_NO_THROW(reloadedType = typeInfo->getElement(L"m_field4"));
+    EXPECT_NE(fieldType, reloadedType);
+    EXPECT_EQ(fieldType->getName(), reloadedType->getName());
+    EXPECT_NE(derefType, reloadedType->deref());
+
+    // the base types are shared and stay the same across the reset
+    EXPECT_EQ(baseFieldType, typeInfo->getElement(L"m_field1"));
+}
+
+TEST_F(TypeInfoTest, SelfReferencedType)
+{
+    TypeInfoPtr  entryType;
+    ASSERT_NO_THROW(entryType = loadType(L"listEntry"));
+
+    TypeInfoPtr  nextType;
+    ASSERT_NO_THROW(nextType = entryType->getElement(L"flink")->deref());
+    EXPECT_EQ(L"listEntry", nextType->getName());
+    EXPECT_EQ(nextType, entryType->getElement(L"blink")->deref());
+
+    // following the list does not load a new type on every hop
+    TypeInfoPtr  typeInfo = nextType;
+    for (int i = 0; i < 100; ++i)
+        ASSERT_NO_THROW(typeInfo = typeInfo->getElement(L"flink")->deref());
+
+    EXPECT_EQ(nextType, typeInfo);
+    EXPECT_EQ(nextType, typeInfo->getElement(L"blink")->deref());
+}
+
+TEST_F(TypeInfoTest, FieldTypeCacheBenchmark)
+{
+    const size_t  coldCount = 1000;
+    const size_t  warmCount = 100000;
+
+    // types loaded from the symbol scope bypass the process type cache, so
+    // every one of them resolves its fields for the first time
+    SymbolPtr  symbolScope = m_targetModule->getSymbolScope();
+
+    std::vector<TypeInfoPtr>  coldTypes;
+    for ( size_t i = 0; i < coldCount; ++i )
+    {
+        coldTypes.push_back(loadType(symbolScope, L"structTest"));
+        coldTypes.back()->getElementCount();
+    }
+
+    Stopwatch  timer;
+    for ( size_t i = 0; i < coldCount; ++i )
+        coldTypes[i]->getElement(L"m_field1");
+    reportBenchmark("first field access", timer.elapsed(), coldCount);
+
+    TypeInfoPtr  typeInfo = coldTypes.front();
+
+    timer.restart();
+    for ( size_t i = 0; i < warmCount; ++i )
+        typeInfo->getElement(L"m_field1");
+    reportBenchmark("repeated field access", timer.elapsed(), warmCount);
+}
+
+TEST_F(TypeInfoTest, TypeCache)
+{
+    TypeCacheLimitGuard  cacheGuard;
+
+    resetTypeCache();
+
+    const TypeCacheStatistics  stat1 = getTypeCacheStatistics();
+
+    TypeInfoPtr  typeInfo;
+    ASSERT_NO_THROW(typeInfo = loadType(L"structTest"));
+    EXPECT_EQ(typeInfo, loadType(L"structTest"));
+    EXPECT_EQ(loadType(L"targetapp!structTest"), loadType(L"targetapp!structTest"));
+
+    const TypeCacheStatistics  stat2 = getTypeCacheStatistics();
+    EXPECT_LE(stat1.hits + 2, stat2.hits);
+    EXPECT_LT(stat1.misses, stat2.misses);
+    EXPECT_LT(0, stat2.cachedTypes);
+    EXPECT_LE(stat2.cachedTypes, stat2.maxTypes);
+
+    m_targetModule->resetSymbols();
+    EXPECT_NE(typeInfo, loadType(L"structTest"));
+
+    setTypeCacheLimit(0);
+    EXPECT_EQ(0, getTypeCacheStatistics().cachedTypes);
+    EXPECT_NE(loadType(L"structTest"), loadType(L"structTest"));
+
+    setTypeCacheLimit();
+    EXPECT_EQ(loadType(L"structTest"), loadType(L"structTest"));
+}
+
+TEST_F(TypeInfoTest, TypeCacheNotFound)
+{
+    resetTypeCache();
+
+    EXPECT_THROW(m_targetModule->getTypeByName(L"notExistType"), SymbolException);
+
+    const TypeCacheStatistics  stat = getTypeCacheStatistics();
+    EXPECT_THROW(m_targetModule->getTypeByName(L"notExistType"), SymbolException);
+    EXPECT_EQ(stat.hits + 1, getTypeCacheStatistics().hits);
+
+    EXPECT_THROW(m_targetModule->getTypeByName(L"notExistType*[2]"), SymbolException);
+    EXPECT_THROW(m_targetModule->getTypeByName(L"notExistType*[2]"), SymbolException);
+
+    m_targetModule->resetSymbols();
+    EXPECT_THROW(m_targetModule->getTypeByName(L"notExistType"), SymbolException);
+}
+
+TEST_F(TypeInfoTest, DerivedTypeInterning)
+{
+    TypeInfoPtr  typeInfo;
+    ASSERT_NO_THROW(typeInfo = loadType(L"structTest"));
+
+    EXPECT_EQ(typeInfo->ptrTo(), typeInfo->ptrTo());
+    EXPECT_EQ(typeInfo->ptrTo(4), typeInfo->ptrTo(4));
+    EXPECT_NE(typeInfo->ptrTo(4), typeInfo->ptrTo(8));
+    EXPECT_EQ(typeInfo->arrayOf(4), typeInfo->arrayOf(4));
+    EXPECT_NE(typeInfo->arrayOf(4), typeInfo->arrayOf(5));
+    EXPECT_EQ(typeInfo->ptrTo()->arrayOf(2), typeInfo->ptrTo()->arrayOf(2));
+
+    EXPECT_EQ(L"structTest*[4]", loadType(L"targetapp!structTest*[4]")->getName());
+}
+
+TEST_F(TypeInfoTest, BaseTypeShared)
+{
+    EXPECT_EQ(loadType(L"UInt4B"), loadType(L"UInt4B"));
+    EXPECT_EQ(TypeInfo::getBaseTypeInfo(L"Int8B", 4), TypeInfo::getBaseTypeInfo(L"Int8B", 4));
+    EXPECT_NE(TypeInfo::getBaseTypeInfo(L"Int8B", 4), TypeInfo::getBaseTypeInfo(L"Int8B", 8));
+    EXPECT_EQ(loadType(L"Double")->ptrTo(), loadType(L"Double")->ptrTo());
+
+    EXPECT_TRUE(loadType(L"g_constNumValue")->isConstant());
+    EXPECT_FALSE(loadType(L"UInt4B")->isConstant());
+    EXPECT_FALSE(loadType(L"structTest")->getElement(L"m_field0")->isConstant());
+}